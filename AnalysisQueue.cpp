@@ -0,0 +1,339 @@
+/*
+  ==============================================================================
+
+    AnalysisQueue.cpp
+    Created: 19 Oct 2026 7:12:40pm
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#include "AnalysisQueue.h"
+#include "Trace.h"
+using namespace juce;
+
+AnalysisQueue::Worker::Worker(AnalysisQueue& _owner, int _index)
+    : Thread("Analysis worker " + String(_index)), owner(_owner), index(_index)
+{
+}
+
+void AnalysisQueue::Worker::run()
+{
+    while (! threadShouldExit())
+    {
+        Job job;
+        if (owner.takeJob(*this, job))
+            owner.runJob(*this, job);
+        else
+            wait(-1); // Woken by push, or when a deck load releases the held lanes
+    }
+}
+
+// One core is left free for the audio and message threads, and the workers run at low priority,
+// so a library import never competes with playback
+AnalysisQueue::AnalysisQueue(AudioFormatManager& _formatManager, TrackLibrary& _library)
+    : formatManager(_formatManager), library(_library)
+{
+    int numWorkers = jmax(1, SystemStats::getNumCpus() - 1);
+    for (int i = 0; i < numWorkers; ++i)
+        workers.push_back(std::make_unique<Worker>(*this, i));
+    for (auto& worker : workers)
+        worker->startThread(Thread::Priority::low);
+
+    library.addChangeListener(this);
+    startTimer(1000);
+}
+
+AnalysisQueue::~AnalysisQueue()
+{
+    library.removeChangeListener(this);
+    stopTimer();
+    cancelPendingUpdate();
+
+    {
+        const ScopedLock sl(pendingLock);
+        shuttingDown = true;
+    }
+    for (auto& worker : workers)
+    {
+        worker->signalThreadShouldExit();
+        worker->abort = true;
+        worker->notify();
+    }
+    for (auto& worker : workers)
+        worker->stopThread(4000);
+}
+
+// A request for a file that is already queued only ever raises its lane. Tracks the library already
+// has current results for are still queued, since the caller wants the waveform, but skip the rest. The copy in the old lane
+// stays where it is and is skipped when taken, which keeps every deque a plain FIFO.
+void AnalysisQueue::request(const File& file, Priority priority, Callback onComplete)
+{
+    const int lane = (int) priority;
+    const ScopedLock sl(pendingLock);
+
+    auto [it, isNew] = pending.try_emplace((uint64) file.getFullPathName().hashCode64());
+    auto& entry = it->second;
+    if (isNew)
+        ++numQueued;
+    if (onComplete != nullptr)
+        entry.callbacks.push_back(std::move(onComplete));
+
+    if (! isNew && (entry.state == Pending::done || entry.lane <= lane))
+        return;
+
+    entry.lane = lane;
+    if (priority == Priority::deckLoad)
+    {
+        ++deckLoadsPending;
+        preemptLibraryWork();
+    }
+
+    if (entry.state == Pending::running)
+    {
+        // Only a deck load is worth restarting for: it gets the whole deck pool
+        if (priority == Priority::deckLoad && entry.runner != nullptr)
+            entry.runner->abort = true; // Requeued in its new lane by runJob
+        return;
+    }
+
+    Job job { file, it->first, lane };
+    int index = library.indexOf(file);
+    if (index >= 0)
+        job.known = library.getAnalysis(index);
+    push(job, false, nullptr);
+}
+
+void AnalysisQueue::requestTrack(int libraryIndex, Priority priority)
+{
+    if (needsAnalysis(libraryIndex) && (library.getRecord(libraryIndex).flags & TrackRecord::missing) == 0)
+        request(library.getFile(libraryIndex), priority);
+}
+
+bool AnalysisQueue::needsAnalysis(int libraryIndex) const
+{
+    return library.getRecord(libraryIndex).getAnalysisVersion() != TrackAnalyser::version;
+}
+
+AnalysisQueue::Stats AnalysisQueue::getStats() const
+{
+    Stats stats;
+    for (auto& worker : workers)
+        if (worker->runningLane >= 0)
+            ++stats.running;
+
+    {
+        const ScopedLock sl(pendingLock);
+        stats.queued = numQueued; // Not pending.size(): that also holds finished jobs awaiting delivery
+    }
+
+    stats.completed = numCompleted;
+    stats.failed = numFailed;
+    if (completionTimes.size() > 1)
+        stats.tracksPerSecond = (double) (completionTimes.size() - 1) * 1000.0 / jmax(1.0, completionTimes.back() - completionTimes.front());
+    return stats;
+}
+
+void AnalysisQueue::push(const Job& job, bool atFront, Worker* target)
+{
+    if (target == nullptr)
+        target = workers[(size_t) (nextWorker++ % (unsigned) workers.size())].get();
+
+    {
+        const ScopedLock sl(target->lock);
+        auto& deque = target->lanes[(size_t) job.lane];
+        if (atFront)
+            deque.push_front(job);
+        else
+            deque.push_back(job);
+    }
+    wakeWorkers();
+}
+
+void AnalysisQueue::wakeWorkers()
+{
+    for (auto& worker : workers)
+        worker->notify();
+}
+
+// Partial work is thrown away, but library jobs are short and a deck load is what the user is waiting for
+void AnalysisQueue::preemptLibraryWork()
+{
+    for (auto& worker : workers)
+        if (worker->runningLane > (int) Priority::selected)
+            worker->abort = true;
+}
+
+// Lanes are tried in priority order across all workers before moving down a lane, so a worker only
+// picks up background work when no higher lane has anything anywhere. Its own deque is taken from
+// the front; stealing takes from the back, the end its owner would reach last.
+bool AnalysisQueue::takeJob(Worker& worker, Job& job)
+{
+    const int numWorkers = (int) workers.size();
+
+    for (int lane = 0; lane < numLanes; ++lane)
+    {
+        if (lane > (int) Priority::selected && deckLoadsPending > 0)
+            return false; // Held until the deck load finishes
+
+        for (int i = 0; i < numWorkers; ++i)
+        {
+            auto& victim = *workers[(size_t) ((worker.index + i) % numWorkers)];
+            const bool own = &victim == &worker;
+
+            for (;;)
+            {
+                {
+                    const ScopedLock sl(victim.lock);
+                    auto& deque = victim.lanes[(size_t) lane];
+                    if (deque.empty())
+                        break;
+
+                    if (own)
+                    {
+                        job = std::move(deque.front());
+                        deque.pop_front();
+                    }
+                    else
+                    {
+                        job = std::move(deque.back());
+                        deque.pop_back();
+                    }
+                }
+
+                if (claim(worker, job))
+                    return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Running state is set under pendingLock, so a deck load arriving at any point sees this job and can preempt it
+bool AnalysisQueue::claim(Worker& worker, const Job& job)
+{
+    const ScopedLock sl(pendingLock);
+    if (shuttingDown)
+        return false;
+
+    auto it = pending.find(job.hash);
+    if (it == pending.end() || it->second.state != Pending::queued || it->second.lane != job.lane)
+        return false; // A stale copy left behind by a lane change
+
+    it->second.state = Pending::running;
+    --numQueued;
+    it->second.runner = &worker;
+    worker.abort = false;
+    worker.runningLane = job.lane;
+    return true;
+}
+
+void AnalysisQueue::runJob(Worker& worker, const Job& job)
+{
+    OTO_TRACE_SCOPE("Analysis job");
+
+    // Only deck loads fan out over the deck pool; library jobs run one track per worker, which
+    // keeps every core busy without the per-chunk filter pre-roll
+    auto* pool = job.lane == (int) Priority::deckLoad ? deckPool.get() : nullptr;
+    auto analysis = TrackAnalyser::analyse(formatManager, job.file, pool, worker.abort, &job.known);
+    worker.runningLane = -1;
+
+    const ScopedLock sl(pendingLock);
+    auto& entry = pending[job.hash];
+    entry.runner = nullptr;
+
+    if (! analysis.completed)
+    {
+        if (shuttingDown)
+            return;
+
+        // Preempted: back to the front of its lane, which a deck-load request may have raised
+        entry.state = Pending::queued;
+        ++numQueued;
+        auto requeued = job;
+        requeued.lane = entry.lane;
+        push(requeued, true, &worker);
+        return;
+    }
+
+    entry.state = Pending::done;
+    if (entry.lane == (int) Priority::deckLoad && --deckLoadsPending == 0)
+        wakeWorkers(); // Release the held lanes
+
+    {
+        const ScopedLock fl(finishedLock);
+        finished.push_back(std::move(analysis));
+    }
+    triggerAsyncUpdate();
+}
+
+void AnalysisQueue::handleAsyncUpdate()
+{
+    std::vector<TrackAnalysis> batch;
+    {
+        const ScopedLock sl(finishedLock);
+        batch.swap(finished);
+    }
+
+    auto now = Time::getMillisecondCounterHiRes();
+
+    for (auto& analysis : batch)
+    {
+        std::vector<Callback> callbacks;
+        {
+            const ScopedLock sl(pendingLock);
+            auto it = pending.find((uint64) analysis.file.getFullPathName().hashCode64());
+            if (it != pending.end())
+            {
+                callbacks.swap(it->second.callbacks);
+                pending.erase(it);
+            }
+        }
+
+        int index = library.indexOf(analysis.file);
+        if (index >= 0 && needsAnalysis(index))
+            library.storeAnalysis(index, analysis.results);
+
+        ++numCompleted;
+        if (analysis.waveform == nullptr)
+            ++numFailed;
+        completionTimes.push_back(now);
+
+        for (auto& callback : callbacks)
+            callback(analysis);
+    }
+
+    while (! completionTimes.empty() && now - completionTimes.front() > rateWindowMs)
+        completionTimes.pop_front();
+
+    OTO_TRACE_COUNTER("Tracks queued for analysis", getStats().queued);
+    sendChangeMessage();
+}
+
+void AnalysisQueue::changeListenerCallback(ChangeBroadcaster*)
+{
+    libraryChanged = true;
+}
+
+// Checked at most once a second: a running import or analysis changes the library constantly,
+// and tracks already pending are skipped by path hash without building their path
+void AnalysisQueue::timerCallback()
+{
+    if (! libraryChanged)
+        return;
+    libraryChanged = false;
+
+    std::vector<int> toQueue;
+    {
+        const ScopedLock sl(pendingLock);
+        for (int i = 0; i < library.getNumTracks(); ++i)
+        {
+            const auto& record = library.getRecord(i);
+            if (needsAnalysis(i) && (record.flags & TrackRecord::missing) == 0 && pending.count(record.pathHash) == 0)
+                toQueue.push_back(i);
+        }
+    }
+
+    for (int index : toQueue)
+        request(library.getFile(index), Priority::background);
+}
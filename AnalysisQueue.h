@@ -0,0 +1,123 @@
+/*
+  ==============================================================================
+
+    AnalysisQueue.h
+    Created: 19 Oct 2026 7:12:40pm
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "TrackAnalyser.h"
+#include "TrackLibrary.h"
+
+// AnalysisQueue class: Background scheduler for TrackAnalyser passes. Requests go into one of four
+// priority lanes; each worker keeps its own deque per lane and steals from the others when its own
+// run dry, always taking the highest lane available anywhere. A deck load aborts running library
+// work (which is requeued) and holds the two lowest lanes until it has finished. Results are stored
+// in the library and handed to callbacks on the message thread. Library tracks without current
+// results are queued in the background lane automatically.
+class AnalysisQueue : public juce::ChangeBroadcaster,
+                      private juce::ChangeListener,
+                      private juce::AsyncUpdater,
+                      private juce::Timer {
+public:
+    enum class Priority { deckLoad, selected, visible, background }; // Highest first
+    static constexpr int numLanes = 4;
+
+    using Callback = std::function<void(const TrackAnalysis&)>;
+
+    struct Stats {
+        int queued = 0; // Tracks waiting in any lane
+        int running = 0; // Tracks being analysed now
+        int completed = 0; // Tracks finished since startup
+        int failed = 0; // Finished tracks whose file couldn't be read
+        double tracksPerSecond = 0.0; // Completions over the last rateWindowMs
+    };
+
+    AnalysisQueue(juce::AudioFormatManager& formatManager, TrackLibrary& library);
+    ~AnalysisQueue() override; // Aborts running work and drops the queue
+
+    // Message thread. Queues the file, or moves it to a higher lane if it is already queued. The
+    // callback runs on the message thread once the file is done, even if it was already analysed.
+    void request(const juce::File& file, Priority priority, Callback onComplete = nullptr);
+    void requestTrack(int libraryIndex, Priority priority); // Queue a library track if it needs analysis
+
+    bool needsAnalysis(int libraryIndex) const; // Never analysed, or analysed by an older TrackAnalyser
+    Stats getStats() const; // Message thread; listeners get a change message whenever these move
+
+private:
+    struct Job {
+        juce::File file;
+        juce::uint64 hash = 0; // Path hash, the key into pending
+        int lane = 0;
+        AnalysisResults known; // Library results when the request was made; version 0 if none
+    };
+
+    class Worker;
+
+    struct Pending {
+        enum State { queued, running, done };
+        State state = queued;
+        int lane = 0; // Lane of the live copy of the job; copies left in lower lanes are skipped
+        Worker* runner = nullptr; // Worker analysing it while running
+        std::vector<Callback> callbacks; // Called on the message thread when done
+    };
+
+    class Worker : public juce::Thread {
+    public:
+        Worker(AnalysisQueue& owner, int index);
+        void run() override;
+
+        AnalysisQueue& owner;
+        const int index;
+        juce::CriticalSection lock; // Guards lanes
+        std::array<std::deque<Job>, numLanes> lanes; // Front is taken by this worker, back by thieves
+        std::atomic<int> runningLane { -1 }; // Lane of the job being analysed, -1 when idle
+        std::atomic<bool> abort { false }; // Raised to preempt the running job
+    };
+
+    void changeListenerCallback(juce::ChangeBroadcaster*) override; // The library changed
+    void timerCallback() override; // Queue library tracks that need analysis
+    void handleAsyncUpdate() override; // Deliver finished jobs
+
+    bool takeJob(Worker& worker, Job& job); // Worker: next job by lane, own deque first, then stealing
+    bool claim(Worker& worker, const Job& job); // Worker: marks the job running unless it was superseded
+    void runJob(Worker& worker, const Job& job); // Worker: analyse and queue the result
+    void push(const Job& job, bool atFront, Worker* target); // Add to a worker's deque and wake the workers; pendingLock held
+    void preemptLibraryWork(); // Abort running jobs below the selected lane; pendingLock held
+    void wakeWorkers();
+
+    static constexpr int rateWindowMs = 30000;
+
+    juce::AudioFormatManager& formatManager;
+    TrackLibrary& library;
+    juce::SharedResourcePointer<WaveformThreadPool> deckPool; // Deck loads spread their waveform chunks here
+
+    juce::CriticalSection pendingLock; // Guards pending; taken before any worker lock
+    std::unordered_map<juce::uint64, Pending> pending; // Every queued, running or undelivered job by path hash
+    int numQueued = 0; // Entries of pending in the queued state; guarded by pendingLock
+    bool shuttingDown = false; // Set under pendingLock by the destructor; no more jobs are claimed
+    std::atomic<int> deckLoadsPending { 0 }; // Deck loads queued or running; the two lowest lanes wait while non-zero
+    std::atomic<unsigned> nextWorker { 0 }; // Round-robin target for new jobs
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    juce::CriticalSection finishedLock; // Guards finished
+    std::vector<TrackAnalysis> finished; // Done but not yet delivered
+
+    bool libraryChanged = true; // Library tracks need checking for missing analysis
+    int numCompleted = 0, numFailed = 0;
+    std::deque<double> completionTimes; // Message-thread times of recent completions, for the rate
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AnalysisQueue)
+};
@@ -0,0 +1,69 @@
+/*
+  ==============================================================================
+
+    AnimationClock.cpp
+    Created: 19 Oct 2026 11:48:05am
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#include "AnimationClock.h"
+using namespace juce;
+
+AnimationClock::AnimationClock(Component& _host) : host(_host)
+{
+}
+
+AnimationClock::~AnimationClock()
+{
+    cancelPendingUpdate();
+    attachment.reset();
+}
+
+void AnimationClock::addClient(Client* client)
+{
+    clients.addIfNotAlreadyThere(client);
+}
+
+void AnimationClock::removeClient(Client* client)
+{
+    clients.removeFirstMatchingValue(client);
+}
+
+// Attaches to the host's vblank; frames then arrive at the display refresh rate
+void AnimationClock::wake()
+{
+    if (attachment == nullptr)
+        attachment = std::make_unique<VBlankAttachment>(&host, [this] { onVBlank(); });
+}
+
+// Gives every animating client the same timestamp, then schedules a detach if nobody animates any more
+void AnimationClock::onVBlank()
+{
+    auto now = Time::getMillisecondCounterHiRes();
+    bool anyAnimating = false;
+
+    for (int i = clients.size(); --i >= 0;)
+    {
+        auto* client = clients[i];
+        if (client->isAnimating())
+        {
+            client->animationFrame(now);
+            anyAnimating = anyAnimating || client->isAnimating();
+        }
+    }
+
+    // The attachment can't be destroyed from inside its own callback, so detach asynchronously
+    if (! anyAnimating)
+        triggerAsyncUpdate();
+}
+
+void AnimationClock::handleAsyncUpdate()
+{
+    for (auto* client : clients)
+        if (client->isAnimating())
+            return; // Woken up again in the meantime
+
+    attachment.reset();
+}
@@ -0,0 +1,45 @@
+/*
+  ==============================================================================
+
+    AnimationClock.h
+    Created: 19 Oct 2026 11:48:05am
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+// AnimationClock class: One frame clock for every visualiser in the window, paced by the display's
+// vertical blank. It only stays attached to the display while a client is animating, so a static
+// window costs no CPU at all.
+class AnimationClock : private juce::AsyncUpdater {
+public:
+    // Anything that animates registers as a client
+    class Client {
+    public:
+        virtual ~Client() = default;
+        virtual bool isAnimating() const = 0; // True while the client still needs frames
+        virtual void animationFrame(double nowMs) = 0; // Called once per display refresh while animating
+    };
+
+    explicit AnimationClock(juce::Component& host); // Host component whose display paces the frames
+    ~AnimationClock() override;
+
+    void addClient(Client* client); // Register a client; call wake() once it has something to animate
+    void removeClient(Client* client); // Unregister a client
+    void wake(); // Start delivering frames (no-op if already running)
+    bool isRunning() const { return attachment != nullptr; } // True while attached to the display
+
+private:
+    void onVBlank(); // Deliver one frame to all animating clients
+    void handleAsyncUpdate() override; // Detach from the display once every client is idle
+
+    juce::Component& host;
+    juce::Array<Client*> clients; // Registered clients
+    std::unique_ptr<juce::VBlankAttachment> attachment; // Present only while something animates
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AnimationClock)
+};
@@ -0,0 +1,143 @@
+/*
+  ==============================================================================
+
+    AudioSettingsComponent.cpp
+    Created: 20 Oct 2026 12:31:08am
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#include "AudioSettingsComponent.h"
+using namespace juce;
+
+AudioSettingsComponent::AudioSettingsComponent(AudioDeviceManager& _deviceManager,
+                                               LatencyTester::Measurement& _measurement,
+                                               DeckResampler::Quality& _quality,
+                                               std::function<void()> _onChanged)
+    : deviceManager(_deviceManager), measurement(_measurement), quality(_quality), onChanged(std::move(_onChanged))
+{
+    addAndMakeVisible(selector);
+
+    // Item IDs are the enum values plus one, since a ComboBox reserves 0 for no selection
+    addAndMakeVisible(qualityLabel);
+    addAndMakeVisible(qualityBox);
+    qualityBox.addItem("Draft (8 taps)", (int) DeckResampler::Quality::draft + 1);
+    qualityBox.addItem("Standard (32 taps)", (int) DeckResampler::Quality::standard + 1);
+    qualityBox.addItem("High (64 taps)", (int) DeckResampler::Quality::high + 1);
+    qualityBox.setSelectedId((int) quality + 1, dontSendNotification);
+    qualityBox.onChange = [this]
+    {
+        quality = (DeckResampler::Quality) (qualityBox.getSelectedId() - 1);
+        if (onChanged)
+            onChanged();
+    };
+
+    addAndMakeVisible(measureButton);
+    measureButton.addListener(this);
+    measureButton.setLookAndFeel(&customLookAndFeel);
+
+    addAndMakeVisible(latencyLabel);
+    latencyLabel.setJustificationType(Justification::topLeft);
+    latencyLabel.setMinimumHorizontalScale(1.0f);
+
+    deviceManager.addChangeListener(this);
+    updateLatencyText();
+
+    setSize(520, 592);
+}
+
+AudioSettingsComponent::~AudioSettingsComponent()
+{
+    deviceManager.removeChangeListener(this);
+    measureButton.setLookAndFeel(nullptr);
+}
+
+void AudioSettingsComponent::paint(Graphics& g)
+{
+    g.fillAll(Colours::black);
+}
+
+void AudioSettingsComponent::resized()
+{
+    auto area = getLocalBounds().reduced(8);
+    latencyLabel.setBounds(area.removeFromBottom(96));
+    area.removeFromBottom(8);
+    measureButton.setBounds(area.removeFromBottom(30));
+    area.removeFromBottom(8);
+    auto qualityRow = area.removeFromBottom(24);
+    qualityLabel.setBounds(qualityRow.removeFromLeft(160));
+    qualityBox.setBounds(qualityRow);
+    area.removeFromBottom(8);
+    selector.setBounds(area);
+}
+
+void AudioSettingsComponent::buttonClicked(Button* button)
+{
+    if (button != &measureButton || tester.isRunning())
+        return;
+
+    lastError.clear();
+    measureButton.setEnabled(false);
+    measureButton.setButtonText("MEASURING...");
+
+    tester.start([this](const LatencyTester::Result& result)
+    {
+        measureButton.setEnabled(true);
+        measureButton.setButtonText("MEASURE LATENCY");
+
+        auto* device = deviceManager.getCurrentAudioDevice();
+        if (result.valid && device != nullptr)
+        {
+            measurement.deviceName = device->getName();
+            measurement.sampleRate = device->getCurrentSampleRate();
+            measurement.bufferSize = device->getCurrentBufferSizeSamples();
+            measurement.roundTripSamples = result.roundTripSamples;
+            if (result.spreadSamples > 16)
+                lastError = "Clicks varied by " + String(result.spreadSamples) + " samples; the loop may be noisy";
+            if (onChanged)
+                onChanged();
+        }
+        else
+        {
+            lastError = result.error;
+        }
+        updateLatencyText();
+    });
+}
+
+void AudioSettingsComponent::changeListenerCallback(ChangeBroadcaster*)
+{
+    updateLatencyText();
+}
+
+void AudioSettingsComponent::updateLatencyText()
+{
+    auto* device = deviceManager.getCurrentAudioDevice();
+    if (device == nullptr)
+    {
+        latencyLabel.setText("No audio device is open", dontSendNotification);
+        return;
+    }
+
+    auto rate = device->getCurrentSampleRate();
+    auto toMs = [rate](int samples) { return String(rate > 0.0 ? 1000.0 * samples / rate : 0.0, 1) + " ms"; };
+
+    int buffer = device->getCurrentBufferSizeSamples();
+    int reported = device->getOutputLatencyInSamples() + buffer;
+
+    String text;
+    text << "Buffer " << buffer << " samples (" << toMs(buffer) << ") at " << String(rate, 0) << " Hz\n"
+         << "Reported output latency: " << toMs(reported) << "\n";
+
+    if (measurement.appliesTo(*device))
+        text << "Measured round trip: " << toMs(measurement.roundTripSamples) << "\n";
+    else
+        text << "Measured round trip: not measured for this device and buffer size\n";
+
+    text << "Playhead compensation: " << toMs(LatencyTester::getOutputLatencySamples(*device, measurement));
+    if (lastError.isNotEmpty())
+        text << "\n" << lastError;
+
+    latencyLabel.setText(text, dontSendNotification);
+}
@@ -0,0 +1,58 @@
+/*
+  ==============================================================================
+
+    AudioSettingsComponent.h
+    Created: 20 Oct 2026 12:31:08am
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "DeckResampler.h"
+#include "LatencyTester.h"
+#include "LookAndFeel.h"
+
+// AudioSettingsComponent class: Device, sample rate and buffer size selection, plus the loopback
+// latency measurement, the output latency currently compensated for and the decks' resampling
+// quality. Shown in a dialog window.
+class AudioSettingsComponent : public juce::Component,
+                               public juce::Button::Listener,
+                               private juce::ChangeListener {
+public:
+    // measurement and quality are shared with the owner, which is told through onChanged when a new
+    // measurement is taken or the quality is changed
+    AudioSettingsComponent(juce::AudioDeviceManager& deviceManager,
+                           LatencyTester::Measurement& measurement,
+                           DeckResampler::Quality& quality,
+                           std::function<void()> onChanged);
+    ~AudioSettingsComponent() override;
+
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+    void buttonClicked(juce::Button* button) override; // Starts a measurement
+
+private:
+    void changeListenerCallback(juce::ChangeBroadcaster*) override; // Device settings changed
+    void updateLatencyText(); // Shows reported, measured and compensated latency for the current device
+
+    juce::AudioDeviceManager& deviceManager;
+    LatencyTester::Measurement& measurement;
+    DeckResampler::Quality& quality;
+    std::function<void()> onChanged;
+
+    // One or two inputs are offered only for the loopback measurement; playback needs none. Outputs
+    // 3-4, where the device has them, carry the headphone cue.
+    juce::AudioDeviceSelectorComponent selector { deviceManager, 0, 2, 2, 4, false, false, true, false };
+    juce::Label qualityLabel { {}, "Resampling quality" };
+    juce::ComboBox qualityBox;
+    juce::TextButton measureButton { "MEASURE LATENCY" };
+    juce::Label latencyLabel;
+    juce::String lastError; // Why the last measurement failed, shown until the next one
+    LatencyTester tester { deviceManager };
+    CustomLookAndFeel customLookAndFeel;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioSettingsComponent)
+};
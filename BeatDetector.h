@@ -1,33 +1,33 @@
-/*
-  ==============================================================================
-
-    BeatDetector.h
-    Created: 10 Mar 2024 9:07:35pm
-    Author:  roscoe liew
-
-  ==============================================================================
-*/
-
-// WRITTEN THE CODES BELOW PERSONALLY
-
-#pragma once
-
-#include <JuceHeader.h>
-#include <vector>
-
-// BeatDetector class: Detects beats in an audio buffer and estimates BPM
-class BeatDetector {
-public:
-    BeatDetector(); // Constructor
-    void processAudioBuffer(const juce::AudioBuffer<float>& buffer); // Process the audio buffer to detect beats
-    const std::vector<int>& getBeats() const; // Get the list of detected beat positions
-    float estimateBPM(float sampleRate); // Estimate the beats per minute
-    void clearBeats(); // Clear the list of detected beats
-
-private:
-    float previousSample = 0.0f; // Previous audio sample value
-    float threshold = 0.1f; // Threshold for detecting a beat (adjust based on your audio's characteristics)
-    bool recentBeat = false; // Flag to indicate if a beat was recently detected
-    std::vector<int> beats; // List of detected beat positions
-    int debounceCounter = 0; // Counter for debouncing beat detection
-};
+/*
+  ==============================================================================
+
+    BeatDetector.h
+    Created: 10 Mar 2024 9:07:35pm
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+// WRITTEN THE CODES BELOW PERSONALLY
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+
+// BeatDetector class: Detects beats in an audio buffer on the audio thread.
+// Detections are only counted, so the audio thread never allocates; BPM comes from the offline BeatGrid.
+class BeatDetector {
+public:
+    BeatDetector(); // Constructor
+    void processAudioBuffer(const juce::AudioBuffer<float>& buffer); // Process the audio buffer to detect beats
+    int takeBeats(); // Return the number of beats detected since the last call and reset it (any thread)
+    void clearBeats(); // Discard beats that have not been taken yet
+
+private:
+    float previousSample = 0.0f; // Previous audio sample value
+    float threshold = 0.1f; // Threshold for detecting a beat (adjust based on your audio's characteristics)
+    bool recentBeat = false; // Flag to indicate if a beat was recently detected
+    std::atomic<int> pendingBeats { 0 }; // Beats detected but not yet taken by the UI
+    int debounceCounter = 0; // Counter for debouncing beat detection
+};
@@ -0,0 +1,132 @@
+/*
+  ==============================================================================
+
+    BeatGrid.cpp
+    Created: 19 Oct 2026 11:03:27am
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#include "BeatGrid.h"
+#include "SpectralWaveform.h"
+using namespace juce;
+
+// Constructor: Lays out beats every period from the first beat up to the end of the track
+BeatGrid::BeatGrid(double _bpm, double firstBeatSeconds, int _firstDownbeatIndex, double lengthSeconds)
+: bpm(_bpm), firstDownbeatIndex(_firstDownbeatIndex)
+{
+    if (bpm <= 0.0)
+        return;
+
+    const double period = 60.0 / bpm;
+    beats.reserve((size_t) jmax(0.0, (lengthSeconds - firstBeatSeconds) / period) + 1);
+    for (int i = 0;; ++i)
+    {
+        double t = firstBeatSeconds + i * period;
+        if (t >= lengthSeconds)
+            break;
+        beats.push_back(t);
+    }
+}
+
+// Estimates the grid in two passes: autocorrelation for a coarse tempo, then a comb search for the
+// fractional period and phase that line up best with the onsets. Runs on the analysis pool.
+BeatGrid BeatGrid::estimate(const std::vector<WaveformBin>& bins, double binsPerSecond, double lengthSeconds)
+{
+    const int n = (int) bins.size();
+    if (binsPerSecond <= 0.0)
+        return {};
+
+    const double minPeriod = binsPerSecond * 60.0 / maxBpm;
+    const double maxPeriod = binsPerSecond * 60.0 / minBpm;
+    if (n < (int) (maxPeriod * beatsPerBar * 2))
+        return {}; // Too short to find a stable tempo
+
+    // Onset envelope: rectified rise in low and mid energy (kicks and snares)
+    std::vector<float> onset((size_t) n);
+    float previous = 0.0f;
+    for (int i = 0; i < n; ++i)
+    {
+        float energy = bins[(size_t) i].low + 0.5f * bins[(size_t) i].mid;
+        onset[(size_t) i] = jmax(0.0f, energy - previous);
+        previous = energy;
+    }
+
+    int bestLag = 0;
+    double bestScore = 0.0;
+    for (int lag = (int) std::floor(minPeriod); lag <= (int) std::ceil(maxPeriod); ++lag)
+    {
+        double score = 0.0;
+        for (int i = 0; i + lag < n; ++i)
+            score += onset[(size_t) i] * onset[(size_t) (i + lag)];
+        score /= (double) (n - lag);
+
+        if (score > bestScore)
+        {
+            bestScore = score;
+            bestLag = lag;
+        }
+    }
+    if (bestLag == 0)
+        return {}; // Silence
+
+    auto combScore = [&onset, n](double period, double phase)
+    {
+        double score = 0.0;
+        int count = 0;
+        for (double t = phase; t < n; t += period, ++count)
+            score += onset[(size_t) t];
+        return count > 0 ? score / count : 0.0;
+    };
+
+    double bestPeriod = bestLag, bestPhase = 0.0;
+    bestScore = -1.0;
+    for (double period = bestLag - 1.0; period <= bestLag + 1.0; period += 0.01)
+    {
+        for (int phase = 0; phase < (int) period; ++phase)
+        {
+            double score = combScore(period, phase);
+            if (score > bestScore)
+            {
+                bestScore = score;
+                bestPeriod = period;
+                bestPhase = phase;
+            }
+        }
+    }
+
+    // Downbeat: the bar phase whose beats carry the most low-end energy
+    int bestBarPhase = 0;
+    double bestBarEnergy = -1.0;
+    for (int barPhase = 0; barPhase < beatsPerBar; ++barPhase)
+    {
+        double energy = 0.0;
+        for (double t = bestPhase + barPhase * bestPeriod; t < n; t += bestPeriod * beatsPerBar)
+            energy += bins[(size_t) t].low;
+
+        if (energy > bestBarEnergy)
+        {
+            bestBarEnergy = energy;
+            bestBarPhase = barPhase;
+        }
+    }
+
+    return BeatGrid(60.0 * binsPerSecond / bestPeriod, bestPhase / binsPerSecond, bestBarPhase, lengthSeconds);
+}
+
+bool BeatGrid::isDownbeat(int beatIndex) const
+{
+    int offset = beatIndex - firstDownbeatIndex;
+    return offset >= 0 && offset % beatsPerBar == 0;
+}
+
+double BeatGrid::getFirstDownbeat() const
+{
+    return firstDownbeatIndex < (int) beats.size() ? beats[(size_t) firstDownbeatIndex] : 0.0;
+}
+
+int BeatGrid::getFirstBeatAtOrAfter(double seconds) const
+{
+    return (int) (std::lower_bound(beats.begin(), beats.end(), seconds) - beats.begin());
+}
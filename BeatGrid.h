@@ -0,0 +1,45 @@
+/*
+  ==============================================================================
+
+    BeatGrid.h
+    Created: 19 Oct 2026 11:03:27am
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+struct WaveformBin;
+
+// BeatGrid class: Constant-tempo grid of beat times estimated offline from a track's band waveform.
+// Beats are stored sorted so views can binary-search the visible range.
+class BeatGrid {
+public:
+    static constexpr int beatsPerBar = 4; // Beats between downbeats
+    static constexpr double minBpm = 78.0; // Slowest tempo considered by the estimator
+    static constexpr double maxBpm = 175.0; // Fastest tempo considered by the estimator
+
+    BeatGrid() = default; // Empty grid (no beats)
+    BeatGrid(double bpm, double firstBeatSeconds, int firstDownbeatIndex, double lengthSeconds);
+
+    // Estimates tempo and phase from the low/mid onset envelope of the bins
+    static BeatGrid estimate(const std::vector<WaveformBin>& bins, double binsPerSecond, double lengthSeconds);
+
+    bool isEmpty() const { return beats.empty(); } // True if no tempo was found
+    double getBpm() const { return bpm; } // Estimated tempo
+    double getBeatPeriod() const { return bpm > 0.0 ? 60.0 / bpm : 0.0; } // Seconds per beat
+    const std::vector<double>& getBeats() const { return beats; } // Sorted beat times in seconds
+    bool isDownbeat(int beatIndex) const; // True if the beat starts a bar
+    int getFirstDownbeatIndex() const { return firstDownbeatIndex; } // Index of the first beat that starts a bar
+    double getFirstDownbeat() const; // Time of the first downbeat, or 0 if empty
+    int getFirstBeatAtOrAfter(double seconds) const; // Index of the first beat >= seconds (binary search)
+
+private:
+    double bpm = 0.0; // Tempo in beats per minute
+    int firstDownbeatIndex = 0; // Index of the first beat that starts a bar
+    std::vector<double> beats; // Beat times in seconds, ascending
+};
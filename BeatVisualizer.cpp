@@ -1,46 +1,88 @@
-/*
-  ==============================================================================
-
-    BeatVisualizer.cpp
-    Created: 10 Mar 2024 9:12:47pm
-    Author:  roscoe
-
-  ==============================================================================
-*/
-
-// WRITTEN THE CODES BELOW PERSONALLY
-
-#include "BeatVisualizer.h"
-
-BeatVisualizer::BeatVisualizer() {}
-
-// Adds a new beat with the given strength to the visualizer.
-void BeatVisualizer::addBeat(float beatStrength) {
-    beats.push_back({beatStrength, 1.0f, 5.0f}); // Start with a small radius
-    repaint();
-}
-
-// Draws the beat visualizer.
-void BeatVisualizer::paint(juce::Graphics& g) {
-    g.fillAll(juce::Colours::black); // Fill the background with black
-    g.setColour(juce::Colours::red); // Set the border color to red
-    g.drawRect(getLocalBounds(), 1); // Draw the border around the component
-    
-    auto center = getLocalBounds().getCentre().toFloat(); // Center of the component
-
-    // Iterate through each beat and draw it as an expanding and fading circle
-    for (auto& beat : beats) {
-        float diameter = beat.radius * 2.0f;
-        g.setColour(juce::Colours::purple.withAlpha(beat.fade)); // Set the color with fading
-        g.drawEllipse(center.x - beat.radius, center.y - beat.radius, diameter, diameter, 2.0f);
-        beat.radius += radiusIncrement; // Increase the radius for the expanding effect
-        beat.fade *= fadeRate; // Reduce the fade value for fading out
-    }
-
-    // Remove beats that have faded out completely
-    beats.erase(std::remove_if(beats.begin(), beats.end(), [](const Beat& beat) {
-        return beat.fade < 0.01f;
-    }), beats.end());
-
-    repaint(); // Continuously repaint to animate the ripples
-}
+/*
+  ==============================================================================
+
+    BeatVisualizer.cpp
+    Created: 10 Mar 2024 9:12:47pm
+    Author:  roscoe
+
+  ==============================================================================
+*/
+
+// WRITTEN THE CODES BELOW PERSONALLY
+
+#include "BeatVisualizer.h"
+#include "Trace.h"
+
+BeatVisualizer::BeatVisualizer(AnimationClock& _animationClock) : animationClock(_animationClock) {
+    for (auto& path : bucketPaths)
+        path.preallocateSpace(maxBeats * 32); // Room for every ripple landing in one bucket
+    animationClock.addClient(this);
+}
+
+BeatVisualizer::~BeatVisualizer() {
+    animationClock.removeClient(this);
+}
+
+// Adds a new beat with the given strength, replacing the oldest ripple if the ring is full.
+void BeatVisualizer::addBeat(float beatStrength) {
+    auto now = juce::Time::getMillisecondCounterHiRes();
+    if (numBeats == maxBeats) {
+        firstBeat = (firstBeat + 1) % maxBeats;
+        --numBeats;
+    }
+    beats[(size_t) ((firstBeat + numBeats) % maxBeats)] = { beatStrength, now };
+    ++numBeats;
+
+    frameTimeMs = juce::jmax(frameTimeMs, now);
+    animationClock.wake(); // Make sure frames are flowing to animate it
+    repaint();
+}
+
+// Animates only while there are ripples left to draw
+bool BeatVisualizer::isAnimating() const {
+    return numBeats > 0;
+}
+
+// Drops ripples that have outlived their fade; ripples are in start order so only the front expires
+void BeatVisualizer::animationFrame(double nowMs) {
+    frameTimeMs = nowMs;
+    while (numBeats > 0 && (nowMs - getBeat(0).startMs) * 0.001 > lifetimeSeconds) {
+        firstBeat = (firstBeat + 1) % maxBeats;
+        --numBeats;
+    }
+    repaint(); // Draw the new frame (and clear the last ripple once it is gone)
+}
+
+// Draws the beat visualizer.
+void BeatVisualizer::paint(juce::Graphics& g) {
+    OTO_TRACE_SCOPE("BeatVisualizer::paint");
+    g.fillAll(juce::Colours::black); // Fill the background with black
+    g.setColour(juce::Colours::red); // Set the border color to red
+    g.drawRect(getLocalBounds(), 1); // Draw the border around the component
+    
+    auto center = getLocalBounds().getCentre().toFloat(); // Center of the component
+
+    for (auto& path : bucketPaths)
+        path.clear();
+
+    // Size and fade each ripple from its age, then file it under its opacity bucket
+    for (int i = 0; i < numBeats; ++i) {
+        const auto& beat = getBeat(i);
+        float age = (float) juce::jmax(0.0, (frameTimeMs - beat.startMs) * 0.001);
+        float fade = beat.strength * std::exp(-age / fadeTimeSeconds);
+        float radius = startRadius + expansionPerSecond * age;
+
+        int bucket = juce::jlimit(0, alphaBuckets - 1, (int) (fade * alphaBuckets));
+        bucketPaths[(size_t) bucket].addEllipse(center.x - radius, center.y - radius, radius * 2.0f, radius * 2.0f);
+    }
+
+    // One stroke per bucket instead of one per ripple
+    for (int bucket = 0; bucket < alphaBuckets; ++bucket) {
+        auto& path = bucketPaths[(size_t) bucket];
+        if (path.isEmpty())
+            continue;
+
+        g.setColour(juce::Colours::purple.withAlpha((bucket + 0.5f) / alphaBuckets));
+        g.strokePath(path, juce::PathStrokeType(2.0f));
+    }
+}
@@ -1,37 +1,55 @@
-/*
-  ==============================================================================
-
-    BeatVisualizer.h
-    Created: 10 Mar 2024 9:12:47pm
-    Author:  roscoe
-
-  ==============================================================================
-*/
-
-// WRITTEN THE CODES BELOW PERSONALLY
-
-#pragma once
-
-#include <JuceHeader.h>
-#include <vector>
-
-// Represents a single beat with its strength, fade level, and radius.
-struct Beat {
-    float strength;
-    float fade;
-    float radius;
-};
-
-// A component that visualizes beats as expanding and fading circles.
-class BeatVisualizer : public juce::Component {
-public:
-    BeatVisualizer();
-    void paint(juce::Graphics& g) override;
-    void addBeat(float beatStrength);
-
-private:
-    std::vector<Beat> beats; // List of beats to visualize
-    const int maxBeats = 20; // Maximum number of beats to display at once
-    const float radiusIncrement = 2.0f; // How much the radius of a beat increases per frame
-    const float fadeRate = 0.98f; // Rate at which the beat's opacity fades
-};
+/*
+  ==============================================================================
+
+    BeatVisualizer.h
+    Created: 10 Mar 2024 9:12:47pm
+    Author:  roscoe
+
+  ==============================================================================
+*/
+
+// WRITTEN THE CODES BELOW PERSONALLY
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include "AnimationClock.h"
+
+// Represents a single beat ripple: how strong it was and when it started.
+struct Beat {
+    float strength = 0.0f;
+    double startMs = 0.0;
+};
+
+// A component that visualizes beats as expanding and fading circles.
+// Ripples live in a fixed ring, so adding and drawing them never allocates once warmed up.
+class BeatVisualizer : public juce::Component, public AnimationClock::Client {
+public:
+    static constexpr int maxBeats = 16; // Maximum number of ripples alive at once; the oldest is dropped
+    static constexpr int alphaBuckets = 8; // Ripples are batched into one path per opacity step
+
+    explicit BeatVisualizer(AnimationClock& animationClock);
+    ~BeatVisualizer() override;
+    void paint(juce::Graphics& g) override;
+    void addBeat(float beatStrength);
+
+    bool isAnimating() const override; // True while any ripple is still visible
+    void animationFrame(double nowMs) override; // Expire faded ripples and schedule a redraw
+
+private:
+    const Beat& getBeat(int i) const { return beats[(size_t) ((firstBeat + i) % maxBeats)]; } // i-th oldest ripple
+
+    std::array<Beat, maxBeats> beats; // Ring of ripples, oldest at firstBeat
+    int firstBeat = 0; // Ring index of the oldest ripple
+    int numBeats = 0; // Number of live ripples
+    double frameTimeMs = 0.0; // Time of the frame being drawn
+
+    std::array<juce::Path, alphaBuckets> bucketPaths; // Reused every frame; clear() keeps their storage
+
+    const float startRadius = 5.0f; // Radius of a new ripple
+    const float expansionPerSecond = 120.0f; // How fast ripples grow, in pixels per second
+    const float fadeTimeSeconds = 0.4f; // Time constant of the exponential fade
+    const float lifetimeSeconds = 1.85f; // Time until a full-strength ripple drops below 1% opacity
+    AnimationClock& animationClock; // Shared frame clock; only ticks us while ripples are alive
+};
@@ -1,142 +1,461 @@
-/*
-==============================================================================
-
-    DJAudioPlayer.cpp
-    Created: 24 Feb 2024 00:36:33
-    Author:  roscoe Liew
-
-==============================================================================
-*/
-
-#include "DJAudioPlayer.h"
-using namespace juce;
-
-// Constructor: Initializes the DJ audio player with an audio format manager
-DJAudioPlayer::DJAudioPlayer(AudioFormatManager& _formatManager)
-: formatManager(_formatManager), resampleSource(&transportSource, false, 2)
-{
-     // Set transportSource as the source for resampleSource
-}
-DJAudioPlayer::~DJAudioPlayer(){
-}
-
-// Prepares the audio sources for playback
-void DJAudioPlayer::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
-{
-    transportSource.prepareToPlay(samplesPerBlockExpected, sampleRate);
-    resampleSource.prepareToPlay(samplesPerBlockExpected, sampleRate);
-
-}
-
-// Fills the buffer with audio data and processes beats
-void DJAudioPlayer::getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill)
-{
-    resampleSource.getNextAudioBlock(bufferToFill);
-    beatDetector.processAudioBuffer(*bufferToFill.buffer);
-}
-
-// Releases resources used by the audio sources
-void DJAudioPlayer::releaseResources()
-{
-    transportSource.releaseResources();
-    resampleSource.releaseResources();
-}
-
-// Loads an audio file from a URL
-void DJAudioPlayer::loadURL(URL audioURL)
-{
-    auto* reader = formatManager.createReaderFor(audioURL.createInputStream(false));
-    if (reader != nullptr) // good file!
-    {
-        sampleRate = reader->sampleRate;
-        std::unique_ptr<AudioFormatReaderSource> newSource (new AudioFormatReaderSource (reader, true));
-        transportSource.setSource (newSource.get(), 0, nullptr, reader->sampleRate);
-        readerSource.reset (newSource.release());          
-    }
-}
-
-// Sets the gain (volume) of the audio playback
-void DJAudioPlayer::setGain(double gain)
-{
-    if (gain < 0 || gain > 2.0)
-    {
-        std::cout << "DJAudioPlayer::setGain gain should be between 0 and 2.0" << std::endl;
-    }
-    else {
-        transportSource.setGain(gain);
-    }
-   
-}
-
-// Sets the playback speed (ratio)
-void DJAudioPlayer::setSpeed(double ratio)
-{
-  std::cout << "setSpeed called with value: " << ratio << std::endl;
-  if (ratio < 0.25 || ratio > 2.0)
-    {
-        std::cout << "DJAudioPlayer::setSpeed ratio should be between 0.25 and 2.0" << std::endl;
-    }
-    else {
-        std::cout << "Setting speed to: " << ratio << std::endl;
-        resampleSource.setResamplingRatio(ratio);
-    }
-}
-
-// Sets the playback position as a relative value (0 to 1)
-void DJAudioPlayer::setPosition(double posInSecs)
-{
-    transportSource.setPosition(posInSecs);
-}
-
-void DJAudioPlayer::setPositionRelative(double pos)
-{
-     if (pos < 0 || pos > 1.0)
-    {
-        std::cout << "DJAudioPlayer::setPositionRelative pos should be between 0 and 1" << std::endl;
-    }
-    else {
-        double posInSecs = transportSource.getLengthInSeconds() * pos;
-        setPosition(posInSecs);
-    }
-}
-
-// Returns the length of the loaded audio track in seconds
-double DJAudioPlayer::getLengthInSeconds() const
-{
-    return readerSource ? readerSource->getTotalLength() / sampleRate : 0.0;
-}
-
-// Starts playback
-void DJAudioPlayer::start()
-{
-    transportSource.start();
-}
-
-// Stops playback
-void DJAudioPlayer::stop()
-{
-  transportSource.stop();
-}
-
-// Returns the relative position of the playhead (0 to 1)
-double DJAudioPlayer::getPositionRelative()
-{
-    return transportSource.getCurrentPosition() / transportSource.getLengthInSeconds();
-}
-
-// Returns true if the audio player is currently playing
-bool DJAudioPlayer::isPlaying() const {
-    return transportSource.isPlaying();
-}
-
-// Returns true if an audio track is loaded
-bool DJAudioPlayer::isLoaded() const {
-    return readerSource != nullptr;
-}
-
-// Stops playback and unloads the current audio track
-void DJAudioPlayer::unloadTrack() {
-    stop(); // Stop playback
-    transportSource.setSource(nullptr); // Disconnect the current audio source
-    readerSource.reset(); // Reset the reader source
-}
+/*
+==============================================================================
+
+    DJAudioPlayer.cpp
+    Created: 24 Feb 2024 00:36:33
+    Author:  roscoe Liew
+
+==============================================================================
+*/
+
+#include "DJAudioPlayer.h"
+#include "Trace.h"
+using namespace juce;
+
+// Constructor: Initializes the DJ audio player with an audio format manager
+DJAudioPlayer::DJAudioPlayer(AudioFormatManager& _formatManager)
+: formatManager(_formatManager)
+{
+}
+DJAudioPlayer::~DJAudioPlayer(){
+}
+
+// Prepares the audio sources for playback. The transport runs at the track's own rate, so the
+// resampler does the only rate conversion; with nothing loaded it falls back to the device rate.
+void DJAudioPlayer::prepareToPlay (int samplesPerBlockExpected, double _deviceSampleRate)
+{
+    deviceSampleRate = _deviceSampleRate;
+    blockSize = samplesPerBlockExpected;
+    const double trackRate = sampleRate.load();
+    transportSource.prepareToPlay(samplesPerBlockExpected, trackRate > 0.0 ? trackRate : _deviceSampleRate);
+    resampler.prepareToPlay(samplesPerBlockExpected, _deviceSampleRate);
+    updateResampleRatio();
+    spectrumAnalyser.prepare(_deviceSampleRate);
+}
+
+// Fills the buffer with audio data, publishes the playhead and processes beats. The block is split at
+// every scheduled action, so each one lands on its exact sample: render up to it, perform it, go on.
+void DJAudioPlayer::getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill)
+{
+    OTO_TRACE_SCOPE("Deck render");
+
+    const double nowMs = Time::getMillisecondCounterHiRes();
+    const double deviceRate = deviceSampleRate.load();
+    const double rate = deviceRate > 0.0 ? deviceRate : 44100.0;
+
+    if (running && ! transportSource.isPlaying()) // Ran off the end of the track
+        running = false;
+
+    // A nudge while playing bends the speed over as many blocks as it needs, never by more than
+    // maxNudgeBend, so a spinning jog wheel pushes the track along without a jump
+    nudgeBend = 0.0;
+    if (! running)
+        nudgeRemaining = 0.0;
+    else if (nudgeRemaining != 0.0)
+    {
+        double blockTrackSeconds = speedRatio.load() * bufferToFill.numSamples / rate;
+        nudgeBend = jlimit(-maxNudgeBend, maxNudgeBend, nudgeRemaining / blockTrackSeconds);
+        nudgeRemaining -= nudgeBend * blockTrackSeconds;
+    }
+    updateResampleRatio(); // Also picks up a speed or track set by another thread since the last block
+
+    // Capture the transport before rendering so the timestamp matches the first sample of the block,
+    // stamped with when that sample will come out of the speakers
+    PlayheadSnapshot snapshot;
+    snapshot.hostTimeMs = nowMs + outputLatencyMs.load();
+    snapshot.positionSeconds = getOutputPosition();
+    snapshot.lengthSeconds = transportSource.getLengthInSeconds();
+    snapshot.speed = speedRatio.load() * (1.0 + nudgeBend);
+    snapshot.playing = running;
+    playheadClock.publish(snapshot);
+
+    scheduler.beginBlock(1000.0 * bufferToFill.numSamples / rate, snapshot.positionSeconds, running);
+
+    for (int done = 0; done < bufferToFill.numSamples;)
+    {
+        double chunkMs = nowMs + 1000.0 * done / rate;
+        DeckScheduler::Command command;
+        while (scheduler.takeDue(chunkMs, getOutputPosition(), speedRatio.load() * (1.0 + nudgeBend) / rate, running, command))
+            perform(command, *bufferToFill.buffer, bufferToFill.startSample, done, chunkMs);
+
+        // Track time covered by one output sample; read after the actions, since a sync changes it
+        double secondsPerSample = speedRatio.load() * (1.0 + nudgeBend) / rate;
+        int count = scheduler.samplesUntilNext(chunkMs, getOutputPosition(), secondsPerSample, rate, running,
+                                               bufferToFill.numSamples - done);
+        render(*bufferToFill.buffer, bufferToFill.startSample + done, count);
+        done += count;
+    }
+
+    playing = running;
+    looping = scheduler.isLooping();
+
+    beatDetector.processAudioBuffer(*bufferToFill.buffer);
+    spectrumAnalyser.pushSamples(*bufferToFill.buffer, bufferToFill.startSample, bufferToFill.numSamples);
+}
+
+void DJAudioPlayer::render(AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    if (! running)
+    {
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+            buffer.clear(channel, startSample, numSamples);
+        return;
+    }
+
+    resampler.getNextAudioBlock(AudioSourceChannelInfo(&buffer, startSample, numSamples));
+
+    if (fadeInRemaining > 0)
+    {
+        int num = jmin(numSamples, fadeInRemaining);
+        auto from = 1.0f - (float) fadeInRemaining / declickSamples;
+        auto to = 1.0f - (float) (fadeInRemaining - num) / declickSamples;
+        buffer.applyGainRamp(startSample, num, from, to);
+        fadeInRemaining -= num;
+    }
+}
+
+// Runs on the audio thread at the sample the action is due. samplesDone of the block are already
+// rendered, so a stop fades out what came just before it rather than running past its sample.
+void DJAudioPlayer::perform(const DeckScheduler::Command& command, AudioBuffer<float>& buffer, int blockStart, int samplesDone, double nowMs)
+{
+    using Action = DeckScheduler::Action;
+    const double position = getOutputPosition();
+
+    switch (command.action)
+    {
+        case Action::start:
+            if (running || ! trackLoaded.load())
+                break;
+            if (! transportSource.isPlaying())
+                transportSource.start();
+            running = true;
+            fadeInRemaining = declickSamples;
+            break;
+
+        case Action::stop:
+            if (running)
+            {
+                int num = jmin(samplesDone, declickSamples);
+                buffer.applyGainRamp(blockStart + samplesDone - num, num, 1.0f, 0.0f);
+            }
+            running = false;
+            fadeInRemaining = 0;
+            break;
+
+        case Action::jump:
+            seek(command.seconds);
+            break;
+
+        case Action::nudge:
+            if (running)
+                nudgeRemaining += command.seconds; // Bent in from the next block
+            else
+                seek(position + command.seconds); // Nothing is heard, so a stopped deck can just move
+            break;
+
+        case Action::loopIn:
+            scheduler.setLoopStart(position);
+            break;
+
+        case Action::loopOut:
+            if (scheduler.isLooping())
+                scheduler.exitLoop();
+            else if (scheduler.closeLoop(position))
+                seek(scheduler.getLoopStart());
+            break;
+
+        case Action::sync:
+        {
+            speedRatio = jlimit(0.25, 2.0, command.speed);
+            updateResampleRatio();
+
+            // Both beat counts are taken at the moment this sample is heard, so the other deck's count
+            // is carried forward from when SYNC was pressed at its own tempo
+            const auto& grid = scheduler.getGrid();
+            if (grid.isEmpty() || command.masterBeatsPerMs <= 0.0)
+                break;
+
+            double heardMs = nowMs + outputLatencyMs.load();
+            double masterBeat = command.masterBeat + (heardMs - command.issuedMs) * command.masterBeatsPerMs;
+            double ownBeat = grid.beatAt(position);
+            double offset = (masterBeat - std::floor(masterBeat)) - (ownBeat - std::floor(ownBeat));
+            offset -= std::round(offset); // Nearest way round: never more than half a beat
+            if (std::abs(offset * grid.beatPeriod) > 0.0005)
+                seek(position + offset * grid.beatPeriod);
+            break;
+        }
+
+        case Action::setGrid:
+        case Action::reset:
+            break; // Handled by the scheduler as they arrive
+    }
+}
+
+void DJAudioPlayer::seek(double seconds)
+{
+    transportSource.setPosition(jmax(0.0, seconds));
+    resampler.reset();
+    scheduler.requantise(jmax(0.0, seconds));
+}
+
+double DJAudioPlayer::getOutputPosition() const
+{
+    const double trackRate = sampleRate.load();
+    if (trackRate <= 0.0)
+        return 0.0;
+    return ((double) transportSource.getNextReadPosition() - resampler.getLookahead()) / trackRate;
+}
+
+// Releases resources used by the audio sources
+void DJAudioPlayer::releaseResources()
+{
+    transportSource.releaseResources();
+    resampler.releaseResources();
+}
+
+// Loads an audio file from a URL. The transport swaps sources under its own callback lock, so the
+// audio thread never sees readerSource itself: only the track's rate and trackLoaded, both atomic.
+void DJAudioPlayer::loadURL(URL audioURL)
+{
+    OTO_TRACE_SCOPE("DJAudioPlayer::loadURL");
+    auto* reader = formatManager.createReaderFor(audioURL.createInputStream(false));
+    if (reader != nullptr) // good file!
+    {
+        const double trackRate = reader->sampleRate;
+        std::unique_ptr<AudioFormatReaderSource> newSource (new AudioFormatReaderSource (reader, true));
+        transportSource.setSource (newSource.get(), 0, nullptr, 0.0); // No rate correction; the resampler does it
+        transportSource.prepareToPlay(blockSize, trackRate); // Also lets positions be set before the device opens
+        sampleRate = trackRate; // The audio thread folds it into the resampler's ratio on its next block
+        trackLoaded = true;
+        readerSource.reset (newSource.release());          
+        loadedURL = audioURL;
+        resampler.reset();
+        clearLoudness(); // Until the new track's loudness is known
+
+        DeckScheduler::Command reset;
+        reset.action = DeckScheduler::Action::reset;
+        scheduler.push(reset); // Actions and loops meant for the previous track
+        setBeatGrid({});
+    }
+}
+
+// Sets the gain (volume) of the audio playback
+void DJAudioPlayer::setGain(double gain)
+{
+    if (gain < 0 || gain > 2.0)
+    {
+        std::cout << "DJAudioPlayer::setGain gain should be between 0 and 2.0" << std::endl;
+    }
+    else {
+        faderGain = gain; // Picked up by the mixer on its next block
+    }
+   
+}
+
+// The trim only moves the transport's own gain, which already ramps between blocks, so
+// normalisation adds no per-sample work and a late trim fades in rather than jumping
+void DJAudioPlayer::setLoudness(float integratedLufs, float truePeakDb)
+{
+    float trimDb = jmin(targetLufs - integratedLufs, peakCeilingDb - truePeakDb);
+    trimGain = Decibels::decibelsToGain(jlimit(-maxTrimDb, maxTrimDb, trimDb));
+    updateTransportGain();
+}
+
+void DJAudioPlayer::clearLoudness()
+{
+    trimGain = 1.0;
+    updateTransportGain();
+}
+
+void DJAudioPlayer::updateTransportGain()
+{
+    transportSource.setGain((float) trimGain.load());
+}
+
+// Sets the playback speed (ratio)
+void DJAudioPlayer::setSpeed(double ratio)
+{
+  if (ratio < 0.25 || ratio > 2.0)
+    {
+        std::cout << "DJAudioPlayer::setSpeed ratio should be between 0.25 and 2.0" << std::endl;
+    }
+    else {
+        speedRatio = ratio; // Picked up by the audio thread on its next block
+    }
+}
+
+void DJAudioPlayer::updateResampleRatio()
+{
+    const double trackRate = sampleRate.load(), deviceRate = deviceSampleRate.load();
+    double rateRatio = trackRate > 0.0 && deviceRate > 0.0 ? trackRate / deviceRate : 1.0;
+    resampler.setRatio(speedRatio.load() * (1.0 + nudgeBend) * rateRatio);
+}
+
+void DJAudioPlayer::setOutputLatency(double ms)
+{
+    outputLatencyMs = jmax(0.0, ms);
+}
+
+void DJAudioPlayer::setResamplingQuality(DeckResampler::Quality quality)
+{
+    resampler.setQuality(quality);
+}
+
+// Sets the playback position as a relative value (0 to 1)
+void DJAudioPlayer::setPosition(double posInSecs)
+{
+    transportSource.setPosition(posInSecs);
+    resampler.reset(); // Otherwise the filter would blend the old position into the new one
+}
+
+void DJAudioPlayer::setPositionRelative(double pos)
+{
+     if (pos < 0 || pos > 1.0)
+    {
+        std::cout << "DJAudioPlayer::setPositionRelative pos should be between 0 and 1" << std::endl;
+    }
+    else {
+        double posInSecs = getLengthInSeconds() * pos;
+        setPosition(posInSecs);
+    }
+}
+
+// Returns the length of the loaded audio track in seconds
+double DJAudioPlayer::getLengthInSeconds() const
+{
+    return readerSource ? readerSource->getTotalLength() / sampleRate.load() : 0.0;
+}
+
+// Starts playback. Like every transport change this goes through the scheduler, so the audio thread
+// is the only one starting and stopping the deck.
+void DJAudioPlayer::start()
+{
+    DeckScheduler::Command command;
+    command.action = DeckScheduler::Action::start;
+    schedule(command);
+}
+
+// Stops playback
+void DJAudioPlayer::stop()
+{
+    DeckScheduler::Command command;
+    command.action = DeckScheduler::Action::stop;
+    schedule(command);
+}
+
+bool DJAudioPlayer::schedule(const DeckScheduler::Command& command)
+{
+    return scheduler.push(command);
+}
+
+void DJAudioPlayer::setBeatGrid(const BeatGrid& grid)
+{
+    DeckScheduler::Command command;
+    command.action = DeckScheduler::Action::setGrid;
+    command.grid = DeckScheduler::Grid::from(grid);
+    gridPeriod = command.grid.beatPeriod;
+    gridFirstDownbeat = command.grid.firstDownbeat;
+    schedule(command);
+}
+
+bool DJAudioPlayer::getBeatClock(double heardMs, double& beat, double& beatsPerMs) const
+{
+    auto snapshot = playheadClock.read();
+    double period = gridPeriod.load();
+    if (period <= 0.0 || ! snapshot.playing)
+        return false;
+
+    beat = (snapshot.positionAt(heardMs) - gridFirstDownbeat.load()) / period;
+    beatsPerMs = snapshot.speed / (period * 1000.0);
+    return true;
+}
+
+// A stopped deck has no beat of its own to wait for, so a quantised start waits for the partner's
+// instead. Its clock is taken as rendered at issuedMs, which is heard one output latency later on
+// both decks alike.
+bool DJAudioPlayer::scheduleStart(const DJAudioPlayer* partner, DeckScheduler::Quantise quantise, double issuedMs)
+{
+    DeckScheduler::Command command;
+    command.action = DeckScheduler::Action::start;
+    command.quantise = quantise;
+    command.issuedMs = issuedMs;
+    if (partner != nullptr && quantise != DeckScheduler::Quantise::none)
+        partner->getBeatClock(issuedMs + outputLatencyMs.load(), command.masterBeat, command.masterBeatsPerMs);
+    return schedule(command);
+}
+
+// The tempo is matched from master's beat rate as heard at issuedMs; the phase is matched on the
+// audio thread, at the sample the sync lands on
+bool DJAudioPlayer::scheduleSync(const DJAudioPlayer& master, DeckScheduler::Quantise quantise, double issuedMs)
+{
+    DeckScheduler::Command command;
+    if (gridPeriod.load() <= 0.0 || ! master.getBeatClock(issuedMs, command.masterBeat, command.masterBeatsPerMs))
+        return false;
+
+    command.action = DeckScheduler::Action::sync;
+    command.quantise = quantise;
+    command.issuedMs = issuedMs;
+    command.speed = jlimit(0.25, 2.0, command.masterBeatsPerMs * 1000.0 * gridPeriod.load());
+    return schedule(command);
+}
+
+// Returns the relative position of the playhead (0 to 1), extrapolated from the audio thread's snapshot
+double DJAudioPlayer::getPositionRelative() const
+{
+    return playheadClock.read().relativePositionAt(Time::getMillisecondCounterHiRes());
+}
+
+// Reads through a reader of its own on a background thread, so neither the message thread nor the
+// audio thread's reader is held up; all that's wanted is the file's pages in the OS cache
+void DJAudioPlayer::prewarm(double seconds)
+{
+    if (readerSource == nullptr)
+        return;
+
+    prewarmer.addJob([&formatManager = formatManager, url = loadedURL, from = transportSource.getCurrentPosition(), seconds]
+    {
+        std::unique_ptr<AudioFormatReader> reader(formatManager.createReaderFor(url.createInputStream(false)));
+        if (reader == nullptr)
+            return;
+
+        AudioBuffer<float> scratch((int) reader->numChannels, 8192);
+        auto start = (int64) (from * reader->sampleRate);
+        auto end = jmin(reader->lengthInSamples, start + (int64) (seconds * reader->sampleRate));
+
+        for (auto pos = start; pos < end; pos += scratch.getNumSamples())
+        {
+            if (auto* job = ThreadPoolJob::getCurrentThreadPoolJob(); job != nullptr && job->shouldExit())
+                return;
+            reader->read(&scratch, 0, (int) jmin((int64) scratch.getNumSamples(), end - pos), pos, true, true);
+        }
+    });
+}
+
+// Read from the transport rather than the snapshot, which only moves once audio is flowing
+double DJAudioPlayer::getPosition() const
+{
+    return transportSource.getCurrentPosition();
+}
+
+// Returns true if the audio player is currently playing
+bool DJAudioPlayer::isPlaying() const {
+    return playing.load();
+}
+
+// Returns true if an audio track is loaded
+bool DJAudioPlayer::isLoaded() const {
+    return readerSource != nullptr;
+}
+
+// Stops playback and unloads the current audio track
+void DJAudioPlayer::unloadTrack() {
+    stop(); // Stop playback
+    trackLoaded = false;
+    transportSource.setSource(nullptr); // Disconnect the current audio source
+    readerSource.reset(); // Reset the reader source
+
+    DeckScheduler::Command reset;
+    reset.action = DeckScheduler::Action::reset;
+    schedule(reset);
+    setBeatGrid({});
+}
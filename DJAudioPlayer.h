@@ -1,57 +1,125 @@
-/*
-  ==============================================================================
-
-    DJAudioPlayer.h
-     Created: 24 Feb 2024 00:36:33
-     Author:  roscoe Liew
-
-  ==============================================================================
-*/
-
-#pragma once
-
-#include "../JuceLibraryCode/JuceHeader.h"
-#include "BeatDetector.h"
-
-using namespace juce;
-
-// DJAudioPlayer class: Handles audio playback and processing for a DJ application
-class DJAudioPlayer : public juce::AudioSource {
-  public:
-
-    DJAudioPlayer(juce::AudioFormatManager& _formatManager);
-    ~DJAudioPlayer();
-
-    void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override; // Prepare to play
-    void getNextAudioBlock (const juce::AudioSourceChannelInfo& bufferToFill) override; // Get next audio block
-    void releaseResources() override; // Release resources
-    
-    void loadURL(juce::URL audioURL); // Load an audio file from a URL
-    void setGain(double gain); // Set the gain (volume)
-    void setSpeed(double ratio); // Set the playback speed
-    void setPosition(double posInSecs); // Set the playback position in seconds
-    void setPositionRelative(double pos); // Set the playback position as a relative value
-    
-
-    void start(); // Start playback
-    void stop(); // Stop playback
-    void unloadTrack(); // Unload the currently loaded track
-
-    double getPositionRelative(); // Get the relative position of the playhead
-    double getLengthInSeconds() const; // Get the length of the loaded audio track in seconds
-    
-    bool isPlaying() const; // Check if the audio player is currently playing
-    bool isLoaded() const; // Check if an audio track is loaded
-    
-    BeatDetector& getBeatDetector() { return beatDetector; } // Get the beat detector instance
-
-private:
-    juce::AudioFormatManager& formatManager; // Audio format manager for reading audio files
-    std::unique_ptr<juce::AudioFormatReaderSource> readerSource; // Source for reading audio files
-    juce::AudioTransportSource transportSource;  // Transport source for controlling playback
-    juce::ResamplingAudioSource resampleSource{&transportSource, false, 2}; // Resampling source for changing playback speed
-    
-    double sampleRate = 0.0; // Sample rate of the loaded audio track
-    
-    BeatDetector beatDetector; // Beat detector for analyzing the audio waveform
-};
+/*
+  ==============================================================================
+
+    DJAudioPlayer.h
+     Created: 24 Feb 2024 00:36:33
+     Author:  roscoe Liew
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "BeatDetector.h"
+#include "DeckResampler.h"
+#include "DeckScheduler.h"
+#include "PlayheadClock.h"
+#include "SpectrumAnalyser.h"
+
+using namespace juce;
+
+// DJAudioPlayer class: Handles audio playback and processing for a DJ application
+class DJAudioPlayer : public juce::AudioSource {
+  public:
+
+    DJAudioPlayer(juce::AudioFormatManager& _formatManager);
+    ~DJAudioPlayer();
+
+    void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override; // Prepare to play
+    void getNextAudioBlock (const juce::AudioSourceChannelInfo& bufferToFill) override; // Get next audio block
+    void releaseResources() override; // Release resources
+    
+    void loadURL(juce::URL audioURL); // Load an audio file from a URL
+    void setGain(double gain); // Set the channel fader, applied by the mixer to the master send only; any thread
+    void setLoudness(float integratedLufs, float truePeakDb); // Trim the track towards targetLufs
+    void clearLoudness(); // Remove the trim, e.g. while the loaded track is still being analysed
+    void setSpeed(double ratio); // Set the playback speed; any thread, applied from the next block
+    void setOutputLatency(double ms); // Delay between rendering a block and hearing it, added to the playhead timestamps
+    void setResamplingQuality(DeckResampler::Quality quality); // Filter length used for speed and rate conversion
+    void setPosition(double posInSecs); // Move the transport directly, for loads and restores; the UI seeks with a scheduled jump
+    void setPositionRelative(double pos); // Set the playback position as a relative value
+    void prewarm(double seconds); // Read ahead of the playhead into the OS cache, on a background thread
+    
+
+    void start(); // Start playback on the next audio block
+    void stop(); // Stop playback on the next audio block
+    bool schedule(const DeckScheduler::Command& command); // Queue an action for the audio thread; false if the queue is full
+    void setBeatGrid(const BeatGrid& grid); // Grid used to quantise scheduled actions
+    void setCuePoint(double seconds) { cuePoint = seconds; } // Where a cue jump goes, set by the deck's UI
+    double getCuePoint() const { return cuePoint.load(); }
+
+    // Any thread. This deck's beat count as heard at heardMs, from its first downbeat so bars start on
+    // multiples of BeatGrid::beatsPerBar, and how fast it advances; false unless playing on a grid
+    bool getBeatClock(double heardMs, double& beat, double& beatsPerMs) const;
+    // Any thread. Queue a start; quantised, it lands on partner's next beat or bar line while partner
+    // plays on a grid, since this deck is stopped and has no line of its own. partner may be null.
+    bool scheduleStart(const DJAudioPlayer* partner, DeckScheduler::Quantise quantise, double issuedMs);
+    // Any thread. Queue a sync to master's tempo and phase; false if either deck lacks a grid or
+    // master isn't playing
+    bool scheduleSync(const DJAudioPlayer& master, DeckScheduler::Quantise quantise, double issuedMs);
+    void unloadTrack(); // Unload the currently loaded track
+
+    double getPositionRelative() const; // Get the relative position of the playhead
+    double getPosition() const; // Transport position in seconds, valid before the audio device runs
+    PlayheadSnapshot getPlayheadSnapshot() const { return playheadClock.read(); } // Latest transport state published by the audio thread
+    double getLengthInSeconds() const; // Get the length of the loaded audio track in seconds
+    double getGain() const { return faderGain.load(); } // Channel fader, whoever set it last
+    double getSpeed() const { return speedRatio.load(); } // Playback speed, whoever set it last
+    
+    bool isPlaying() const; // Check if the audio player is currently playing
+    bool isLooping() const { return looping.load(); } // True while a loop set with loopIn/loopOut is playing
+    bool isLoaded() const; // Check if an audio track is loaded
+    
+    BeatDetector& getBeatDetector() { return beatDetector; } // Get the beat detector instance
+    SpectrumAnalyser& getSpectrumAnalyser() { return spectrumAnalyser; } // Get the analyser fed with this deck's output
+
+    static constexpr float targetLufs = -14.0f; // Loudness every track is trimmed towards
+    static constexpr float peakCeilingDb = -1.0f; // Trim never pushes the true peak above this
+    static constexpr float maxTrimDb = 12.0f; // Largest boost or cut applied
+
+private:
+    void updateTransportGain(); // Push the trim to the transport; the fader is left to the mixer
+    void updateResampleRatio(); // Audio thread, or while it is stopped: fold the speed and the file-to-device rate conversion into one ratio
+
+    // Audio thread
+    void render(juce::AudioBuffer<float>& buffer, int startSample, int numSamples); // Resampler output, or silence while stopped
+    void perform(const DeckScheduler::Command& command, juce::AudioBuffer<float>& buffer, int blockStart, int samplesDone, double nowMs);
+    void seek(double seconds); // Move the transport and refill the resampler from there
+    double getOutputPosition() const; // Track position of the next output sample, allowing for the resampler's lookahead
+
+
+    juce::AudioFormatManager& formatManager; // Audio format manager for reading audio files
+    std::unique_ptr<juce::AudioFormatReaderSource> readerSource; // Source for reading audio files
+    juce::URL loadedURL; // Where readerSource came from, so prewarm can open a reader of its own
+    juce::AudioTransportSource transportSource;  // Transport source for controlling playback, run at the file's rate
+    DeckResampler resampler { &transportSource, 2 }; // Converts the transport's output to the device rate at the current speed
+    
+    std::atomic<double> sampleRate { 0.0 }; // Sample rate of the loaded audio track, set by loadURL
+    std::atomic<double> deviceSampleRate { 0.0 }; // Rate the deck renders at, once prepared
+    std::atomic<int> blockSize { 512 }; // Expected block size, for preparing the transport when a track loads
+    std::atomic<bool> trackLoaded { false }; // readerSource is set, for the audio thread, which mustn't touch it
+    std::atomic<double> faderGain { 1.0 }; // Volume set by the deck or a controller
+    std::atomic<double> trimGain { 1.0 }; // Loudness normalisation for the loaded track
+    std::atomic<double> speedRatio { 1.0 }; // Current playback speed, read by the audio thread
+    std::atomic<double> outputLatencyMs { 0.0 }; // Device output latency, read by the audio thread
+
+    DeckScheduler scheduler; // Actions queued by the UI, carried out at exact samples on the audio thread
+    bool running = false; // Audio thread: whether the deck is rendering its track
+    int fadeInRemaining = 0; // Audio thread: samples left in the ramp after a start
+    double nudgeRemaining = 0.0; // Audio thread: track time jog nudges still have to gain, negative to lose
+    double nudgeBend = 0.0; // Audio thread: fraction the speed is bent by this block to work off nudgeRemaining
+    static constexpr double maxNudgeBend = 0.1; // Largest bend a nudge makes, as a fraction of the speed
+    std::atomic<bool> playing { false }; // running, published for the UI
+    std::atomic<bool> looping { false }; // The scheduler's loop state, published for the UI
+    std::atomic<double> cuePoint { 0.0 };
+    std::atomic<double> gridPeriod { 0.0 }, gridFirstDownbeat { 0.0 }; // The scheduler's grid, for other threads
+    static constexpr int declickSamples = 64; // Ramp length at a scheduled start or stop
+    
+    PlayheadClock playheadClock; // Lock-free playhead snapshot written once per audio block
+    
+    BeatDetector beatDetector; // Beat detector for analyzing the audio waveform
+    SpectrumAnalyser spectrumAnalyser; // Background spectrum analyser for this deck's output
+
+    juce::ThreadPool prewarmer { 1 }; // Runs prewarm reads; last, so it is stopped before anything else goes
+};
@@ -1,83 +1,121 @@
-/*
- ==============================================================================
- 
- DeckGUI.h
- Created: 24 Feb 2024 00:36:33
- Author:  roscoe Liew
- 
- ==============================================================================
- */
-#pragma once
-
-#include "../JuceLibraryCode/JuceHeader.h"
-#include "DJAudioPlayer.h"
-#include "WaveformDisplay.h"
-#include "SpinningDeck.h"
-#include "LookAndFeel.h"
-#include "BeatVisualizer.h"
-
-using namespace juce;
-
-// DeckGUI class: A component that represents a DJ deck with controls and visualizations
-class DeckGUI:  public juce::Component,
-                public juce::Button::Listener,
-                public juce::Slider::Listener,
-                public juce::FileDragAndDropTarget,
-                public juce::Timer
-{
-    
-public:
-    DeckGUI(DJAudioPlayer* player,
-            juce::AudioFormatManager &     formatManagerToUse,
-            juce::AudioThumbnailCache &     cacheToUse ); // Constructor
-    ~DeckGUI(); // Destructor
-    
-    void paint (juce::Graphics&) override; // Override the paint method to draw the component
-    void resized() override; // Override the resized method to layout the component
-    
-    void buttonClicked (juce::Button *) override; // Button click event handler
-    
-    void sliderValueChanged (juce::Slider *slider) override; // Slider value change event handler
-    
-    bool isInterestedInFileDrag (const juce::StringArray &files) override; // File drag event handler
-    void filesDropped (const juce::StringArray &files, int x, int y) override; // File drop event handler
-    
-    void timerCallback() override; // Timer callback for updating the UI
-    
-    void unloadTrack(); // Unload the currently loaded track
-    
-    bool isEmpty() const; // Check if the deck is empty (no track loaded)
-    void loadURL(const juce::URL& url); // Load a track from a URL
-    void start(); // Start playback
-    
-private:
-    
-    juce::DrawableButton playButton{"Play", juce::DrawableButton::ImageFitted}; // Play button
-    juce::DrawableButton stopButton{"Stop", juce::DrawableButton::ImageFitted}; // Stop button
-    juce::DrawableButton pauseButton{"Pause", juce::DrawableButton::ImageFitted}; // Pause button
-    juce::TextButton loadButton{"LOAD"}; // Load track button
-    juce::TextButton removeButton{"REMOVE"}; // Remove track button
-     
-    juce::Slider volSlider; // Volume slider
-    juce::Slider speedSlider; // Speed slider
-    juce::Slider posSlider; // Position slider
-    
-    bool fileLoaded = false; // Flag to indicate if a file is loaded
-    
-    juce::Label volumeLabel;
-    juce::Label speedLabel;
-    
-    juce::FileChooser fChooser{"Select a file..."};
-    
-    WaveformDisplay waveformDisplay; // Waveform display component
-    
-    DJAudioPlayer* player; // DJ audio player for playback control
-    
-    SpinningDeck spinningDeck; // Spinning deck visualization
-    
-    CustomLookAndFeel customLookAndFeel; // Custom LookAndFeel for styling
-    
-    BeatVisualizer beatVisualizer; // Beat visualizer component
-
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DeckGUI) // Macro to prevent copying and leaking
-};
+/*
+ ==============================================================================
+ 
+ DeckGUI.h
+ Created: 24 Feb 2024 00:36:33
+ Author:  roscoe Liew
+ 
+ ==============================================================================
+ */
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "DJAudioPlayer.h"
+#include "WaveformDisplay.h"
+#include "SpinningDeck.h"
+#include "LookAndFeel.h"
+#include "BeatVisualizer.h"
+#include "AnimationClock.h"
+#include "SpectrumDisplay.h"
+#include "AnalysisQueue.h"
+#include "SessionState.h"
+
+using namespace juce;
+
+// DeckGUI class: A component that represents a DJ deck with controls and visualizations
+class DeckGUI:  public juce::Component,
+                public juce::Button::Listener,
+                public juce::Slider::Listener,
+                public juce::FileDragAndDropTarget,
+                public AnimationClock::Client
+{
+    
+public:
+    DeckGUI(DJAudioPlayer* player,
+            juce::AudioFormatManager &     formatManagerToUse,
+            juce::AudioThumbnailCache &     cacheToUse,
+            AnimationClock& animationClock,
+            AnalysisQueue& analysisQueue ); // Constructor
+    ~DeckGUI(); // Destructor
+    
+    void paint (juce::Graphics&) override; // Override the paint method to draw the component
+    void resized() override; // Override the resized method to layout the component
+    
+    void buttonClicked (juce::Button *) override; // Button click event handler
+    
+    void sliderValueChanged (juce::Slider *slider) override; // Slider value change event handler
+    
+    bool isInterestedInFileDrag (const juce::StringArray &files) override; // File drag event handler
+    void filesDropped (const juce::StringArray &files, int x, int y) override; // File drop event handler
+    
+    bool isAnimating() const override; // True while playing or settling after a change
+    void animationFrame(double nowMs) override; // Per-frame update of playhead, platter and beats
+    
+    void unloadTrack(); // Unload the currently loaded track
+    
+    bool isEmpty() const; // Check if the deck is empty (no track loaded)
+    void loadURL(const juce::URL& url); // Load a track from a URL
+    void start(); // Start playback
+    void setSyncPartner(DeckGUI* partner); // The deck SYNC matches; not owned
+    void syncControls(); // Move the sliders to the player's values after a controller changed them
+
+    DeckState getState() const; // Track, playhead, sliders and cues, for the session snapshot
+    void restoreState(const DeckState& state); // Reload the track paused where it was, with its sliders and cues; before the device opens
+    
+private:
+    
+    void updatePlayhead(double nowMs); // Moves the playhead and platter to the given frame time
+    void requestFrames(); // Keep animating briefly so a change made while stopped gets drawn
+    bool scheduleAction(DeckScheduler::Action action, DeckScheduler::Quantise quantise, double seconds = 0.0); // Stamped now
+    void cueButtonClicked(); // Jump to the cue point while playing, set it while stopped
+    void setCuePoints(std::vector<double> cueSeconds); // Show them and give the first to the player
+    void syncButtonClicked(); // Match the partner's tempo and phase
+    void updateQuantiseButton();
+    
+    static constexpr double prewarmSeconds = 2.0; // Audio read ahead of the playhead when a session is restored
+    static constexpr double settleTimeMs = 150.0; // How long to keep drawing after a change while stopped
+    static constexpr double platterRadiansPerSecond = juce::MathConstants<double>::twoPi * (100.0 / 3.0) / 60.0; // 33 1/3 rpm
+    
+    juce::DrawableButton playButton{"Play", juce::DrawableButton::ImageFitted}; // Play button
+    juce::DrawableButton stopButton{"Stop", juce::DrawableButton::ImageFitted}; // Stop button
+    juce::DrawableButton pauseButton{"Pause", juce::DrawableButton::ImageFitted}; // Pause button
+    juce::TextButton loadButton{"LOAD"}; // Load track button
+    juce::TextButton removeButton{"REMOVE"}; // Remove track button
+    juce::TextButton cueButton{"CUE"}; // Cue point: jump while playing, set while stopped
+    juce::TextButton loopInButton{"IN"}; // Loop start
+    juce::TextButton loopOutButton{"OUT"}; // Loop end, or leave the loop; lit while looping
+    juce::TextButton syncButton{"SYNC"}; // Match the other deck's tempo and beat phase
+    juce::TextButton quantiseButton; // Cycles the quantisation of every action: off, beat, bar
+     
+    juce::Slider volSlider; // Volume slider
+    juce::Slider speedSlider; // Speed slider
+    juce::Slider posSlider; // Position slider
+    
+    bool fileLoaded = false; // Flag to indicate if a file is loaded
+    
+    juce::Label volumeLabel;
+    juce::Label speedLabel;
+    
+    juce::FileChooser fChooser{"Select a file..."};
+    
+    WaveformDisplay waveformDisplay; // Waveform display component
+    
+    DJAudioPlayer* player; // DJ audio player for playback control
+    
+    SpinningDeck spinningDeck; // Spinning deck visualization
+    
+    CustomLookAndFeel customLookAndFeel; // Custom LookAndFeel for styling
+    
+    BeatVisualizer beatVisualizer; // Beat visualizer component
+    
+    SpectrumDisplay spectrumDisplay; // Spectrum and spectrogram of this deck's output
+    
+    AnimationClock& animationClock; // Shared frame clock driving all deck animation
+    AnalysisQueue& analysisQueue; // Analyses loaded tracks ahead of all library work
+    juce::File loadedFile; // Track on the deck, so late analysis results for a previous track are ignored
+    DeckScheduler::Quantise quantise = DeckScheduler::Quantise::beat; // Applied to the actions scheduled from this deck
+    DeckGUI* syncPartner = nullptr;
+    double settleUntilMs = 0.0; // Keep animating until this time even when stopped
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DeckGUI) // Macro to prevent copying and leaking
+};
@@ -0,0 +1,372 @@
+/*
+  ==============================================================================
+
+    DeckResampler.cpp
+    Created: 20 Oct 2026 1:18:44am
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#include "DeckResampler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+ #include <xmmintrin.h>
+ #define OTODECKS_RESAMPLER_SSE 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+ #include <arm_neon.h>
+ #define OTODECKS_RESAMPLER_NEON 1
+#endif
+
+using namespace juce;
+
+namespace
+{
+    // Zeroth-order modified Bessel function, for the Kaiser window
+    double besselI0(double x)
+    {
+        double sum = 1.0, term = 1.0;
+        for (int k = 1; k < 64 && term > sum * 1.0e-12; ++k)
+        {
+            term *= (x * 0.5 / k) * (x * 0.5 / k);
+            sum += term;
+        }
+        return sum;
+    }
+
+    // Two dot products of x with c0 and c1 in one pass over x. n is a multiple of four; no pointer
+    // needs to be aligned, since x starts wherever the playhead falls.
+    void dot2(const float* x, const float* c0, const float* c1, int n, float& s0, float& s1)
+    {
+       #if OTODECKS_RESAMPLER_SSE
+        auto a0 = _mm_setzero_ps(), a1 = _mm_setzero_ps();
+        for (int i = 0; i < n; i += 4)
+        {
+            auto v = _mm_loadu_ps(x + i);
+            a0 = _mm_add_ps(a0, _mm_mul_ps(v, _mm_loadu_ps(c0 + i)));
+            a1 = _mm_add_ps(a1, _mm_mul_ps(v, _mm_loadu_ps(c1 + i)));
+        }
+        alignas(16) float r0[4], r1[4];
+        _mm_store_ps(r0, a0);
+        _mm_store_ps(r1, a1);
+        s0 = (r0[0] + r0[1]) + (r0[2] + r0[3]);
+        s1 = (r1[0] + r1[1]) + (r1[2] + r1[3]);
+       #elif OTODECKS_RESAMPLER_NEON
+        auto a0 = vdupq_n_f32(0.0f), a1 = vdupq_n_f32(0.0f);
+        for (int i = 0; i < n; i += 4)
+        {
+            auto v = vld1q_f32(x + i);
+            a0 = vmlaq_f32(a0, v, vld1q_f32(c0 + i));
+            a1 = vmlaq_f32(a1, v, vld1q_f32(c1 + i));
+        }
+        s0 = (vgetq_lane_f32(a0, 0) + vgetq_lane_f32(a0, 1)) + (vgetq_lane_f32(a0, 2) + vgetq_lane_f32(a0, 3));
+        s1 = (vgetq_lane_f32(a1, 0) + vgetq_lane_f32(a1, 1)) + (vgetq_lane_f32(a1, 2) + vgetq_lane_f32(a1, 3));
+       #else
+        float a0[4] = {}, a1[4] = {};
+        for (int i = 0; i < n; i += 4)
+            for (int j = 0; j < 4; ++j)
+            {
+                a0[j] += x[i + j] * c0[i + j];
+                a1[j] += x[i + j] * c1[i + j];
+            }
+        s0 = (a0[0] + a0[1]) + (a0[2] + a0[3]);
+        s1 = (a1[0] + a1[1]) + (a1[2] + a1[3]);
+       #endif
+    }
+
+    float dot(const float* x, const float* c, int n)
+    {
+        float s0, s1;
+        dot2(x, c, c, n, s0, s1); // The second product is wasted, but this path only runs when stretching
+        return s0;
+    }
+
+    int roundUpToLanes(int n, int lanes)
+    {
+        return (n + lanes - 1) / lanes * lanes;
+    }
+}
+
+DeckResampler::DeckResampler(PositionableAudioSource* _input, int _numChannels)
+    : Thread("Resampler tables"), input(_input), numChannels(_numChannels)
+{
+    startThread();
+}
+
+DeckResampler::~DeckResampler()
+{
+    stopThread(1000);
+}
+
+// Cutoffs are relative to the input Nyquist frequency; wider kernels can afford a steeper, higher one
+const DeckResampler::Kernel& DeckResampler::getKernel(Quality quality)
+{
+    static const Kernel draft = buildKernel(4, 0.80, 5.0);
+    static const Kernel standard = buildKernel(16, 0.91, 8.0);
+    static const Kernel high = buildKernel(32, 0.95, 10.0);
+
+    switch (quality)
+    {
+        case Quality::draft: return draft;
+        case Quality::high: return high;
+        case Quality::standard: break;
+    }
+    return standard;
+}
+
+// Row p holds tap k at t = k - (halfTaps - 1) - p / numPhases, so tap halfTaps - 1 sits on the
+// playhead's integer sample. Each row is normalised to unity gain at DC.
+DeckResampler::Kernel DeckResampler::buildKernel(int halfTaps, double cutoff, double beta)
+{
+    Kernel kernel;
+    kernel.halfTaps = halfTaps;
+    kernel.cutoff = cutoff;
+    kernel.beta = beta;
+    kernel.paddedTaps = roundUpToLanes(2 * halfTaps, lanes);
+    kernel.rows.assign((size_t) (numPhases + 1) * (size_t) kernel.paddedTaps, 0.0f);
+
+    auto i0Beta = besselI0(beta);
+    for (int phase = 0; phase <= numPhases; ++phase)
+    {
+        auto* row = kernel.rows.data() + (size_t) phase * (size_t) kernel.paddedTaps;
+        double sum = 0.0;
+        for (int k = 0; k < 2 * halfTaps; ++k)
+        {
+            double t = k - (halfTaps - 1) - (double) phase / numPhases;
+            double x = cutoff * t;
+            double sinc = std::abs(x) < 1.0e-9 ? 1.0 : std::sin(MathConstants<double>::pi * x) / (MathConstants<double>::pi * x);
+            double w = t / halfTaps;
+            double window = std::abs(w) >= 1.0 ? 0.0 : besselI0(beta * std::sqrt(1.0 - w * w)) / i0Beta;
+            row[k] = (float) (sinc * window);
+            sum += row[k];
+        }
+        for (int k = 0; k < 2 * halfTaps; ++k)
+            row[k] = (float) (row[k] / sum);
+    }
+    return kernel;
+}
+
+// Inverse of the row layout: finds the tap and fractional phase for t, then interpolates between phases
+float DeckResampler::Kernel::at(double t) const
+{
+    double u = t + (halfTaps - 1);
+    auto k = (int) std::ceil(u);
+    if (k < 0 || k >= 2 * halfTaps)
+        return 0.0f;
+
+    double phase = (k - u) * numPhases;
+    auto p0 = jmin(numPhases - 1, (int) phase);
+    auto a = (float) (phase - p0);
+    return row(p0)[k] + a * (row(p0 + 1)[k] - row(p0)[k]);
+}
+
+int DeckResampler::getStretchSteps(double ratio)
+{
+    return (int) std::ceil((jlimit(1.0, maxStretch, ratio) - 1.0) * stretchSteps - 1.0e-9);
+}
+
+// A table stretched by s is the preset with s times the taps and its cutoff divided by s. Rounding the
+// stretch up keeps the cutoff at or below what the ratio needs, and lets a slow speed change reuse one
+// table for a while.
+void DeckResampler::run()
+{
+    while (! threadShouldExit())
+    {
+        auto key = wantedTable.load();
+        auto* latest = latestTable.load();
+        if (key != 0 && (latest == nullptr || latest->key != key))
+        {
+            const auto& preset = getKernel((Quality) (key / 256 - 1));
+            auto stretch = 1.0 + (double) (key % 256) / stretchSteps;
+            auto table = std::make_unique<Kernel>(buildKernel((int) std::ceil(preset.halfTaps * stretch),
+                                                              preset.cutoff / stretch, preset.beta));
+            table->key = key;
+            tables.push_back(std::move(table));
+            latestTable.store(tables.back().get(), std::memory_order_release);
+            continue; // The ratio may have moved on during the build
+        }
+
+        auto* inUse = tableInUse.load(std::memory_order_acquire);
+        auto current = std::find_if(tables.begin(), tables.end(), [inUse](const std::unique_ptr<Kernel>& table) { return table.get() == inUse; });
+        if (current != tables.end())
+            tables.erase(tables.begin(), current);
+
+        wait(pollIntervalMs); // Or until stopThread
+    }
+}
+
+void DeckResampler::setRatio(double inputSamplesPerOutputSample)
+{
+    ratio = jlimit(minRatio, maxRatio, inputSamplesPerOutputSample);
+}
+
+void DeckResampler::setQuality(Quality newQuality)
+{
+    quality = (int) newQuality;
+}
+
+void DeckResampler::reset()
+{
+    resetPending = true;
+}
+
+// Input is read in chunks of at most maxChunk outputs, so the history never has to grow on the audio thread.
+// The input isn't prepared here: it runs at its own rate, which only the owner knows.
+void DeckResampler::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
+{
+    maxChunk = jmax(64, samplesPerBlockExpected);
+    auto maxPaddedTaps = roundUpToLanes(2 * preroll, lanes);
+    auto capacity = preroll + (int) std::ceil(maxChunk * maxRatio) + maxPaddedTaps + lanes;
+
+    history.setSize(numChannels, capacity, false, true, false);
+    coefficients.assign((size_t) maxPaddedTaps, 0.0f);
+    resetPending = true;
+
+    getKernel(Quality::standard); // Build the tables here rather than on the first audio block
+    getKernel(Quality::draft);
+    getKernel(Quality::high);
+    ignoreUnused(sampleRate);
+}
+
+void DeckResampler::releaseResources()
+{
+}
+
+void DeckResampler::getNextAudioBlock(const AudioSourceChannelInfo& bufferToFill)
+{
+    if (history.getNumSamples() == 0)
+    {
+        bufferToFill.clearActiveBufferRegion();
+        return;
+    }
+
+    // Rewinds the input so the filter starts full of the audio before the new position. Seeks and
+    // loops then play straight on, with no ramp in from silence; before the start of a file the
+    // reader supplies zeros.
+    if (resetPending.exchange(false))
+    {
+        input->setNextReadPosition(input->getNextReadPosition() - preroll);
+        numBuffered = 0;
+        fill(preroll);
+        position = preroll;
+    }
+
+    const auto presetQuality = (Quality) quality.load();
+    const double step = ratio.load();
+    const Kernel* kernel = &getKernel(presetQuality);
+    double stretch = 1.0;
+
+    auto steps = getStretchSteps(step);
+    if (steps > 0)
+    {
+        auto key = tableKey(presetQuality, steps);
+        wantedTable.store(key, std::memory_order_relaxed); // Polled by the table thread; waking it would take a lock here
+
+        auto* latest = latestTable.load(std::memory_order_acquire);
+        tableInUse.store(latest, std::memory_order_release);
+        if (latest != nullptr && latest->key == key)
+            kernel = latest;
+        else
+            stretch = jlimit(1.0, maxStretch, step); // For the few blocks until the table is built
+    }
+
+    const int numOutputChannels = jmin(numChannels, bufferToFill.buffer->getNumChannels());
+    for (int channel = numOutputChannels; channel < bufferToFill.buffer->getNumChannels(); ++channel)
+        bufferToFill.buffer->clear(channel, bufferToFill.startSample, bufferToFill.numSamples);
+
+    float* outputs[2] = {};
+    for (int done = 0; done < bufferToFill.numSamples;)
+    {
+        int count = jmin(maxChunk, bufferToFill.numSamples - done);
+        for (int channel = 0; channel < jmin(2, numOutputChannels); ++channel)
+            outputs[channel] = bufferToFill.buffer->getWritePointer(channel, bufferToFill.startSample + done);
+
+        process(outputs, jmin(2, numOutputChannels), count, *kernel, step, stretch);
+        done += count;
+    }
+}
+
+double DeckResampler::getLookahead() const
+{
+    return resetPending.load() ? 0.0 : numBuffered - position;
+}
+
+void DeckResampler::compact(int keep)
+{
+    int start = (int) std::floor(position) - keep;
+    if (start <= 0)
+        return;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* data = history.getWritePointer(channel);
+        std::memmove(data, data + start, (size_t) (numBuffered - start) * sizeof(float));
+    }
+    numBuffered -= start;
+    position -= start;
+}
+
+void DeckResampler::fill(int endIndex)
+{
+    endIndex = jmin(endIndex, history.getNumSamples());
+    if (endIndex <= numBuffered)
+        return;
+
+    AudioSourceChannelInfo info(&history, numBuffered, endIndex - numBuffered);
+    input->getNextAudioBlock(info);
+    numBuffered = endIndex;
+}
+
+// Each output interpolates between two table rows, both applied in the same pass over the input. With
+// a stretch left to apply the taps no longer line up with a row, so they are evaluated into a
+// coefficient vector first; the dot product is the same SIMD loop either way.
+void DeckResampler::process(float* const* outputs, int numOutputChannels, int numSamples, const Kernel& kernel, double step, double stretch)
+{
+    const bool stretched = stretch > 1.0;
+    const int halfTaps = stretched ? (int) std::ceil(kernel.halfTaps * stretch) : kernel.halfTaps;
+    const int paddedTaps = stretched ? roundUpToLanes(2 * halfTaps, lanes) : kernel.paddedTaps;
+
+    compact(preroll);
+    fill((int) std::floor(position + (numSamples - 1) * step) - (halfTaps - 1) + paddedTaps);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        auto n0 = (int) std::floor(position);
+        auto frac = position - n0;
+        auto first = n0 - (halfTaps - 1);
+
+        if (stretched)
+        {
+            float sum = 0.0f;
+            for (int k = 0; k < 2 * halfTaps; ++k)
+            {
+                coefficients[(size_t) k] = kernel.at((k - (halfTaps - 1) - frac) / stretch);
+                sum += coefficients[(size_t) k];
+            }
+            auto gain = sum != 0.0f ? 1.0f / sum : 0.0f;
+            for (int k = 0; k < paddedTaps; ++k)
+                coefficients[(size_t) k] = k < 2 * halfTaps ? coefficients[(size_t) k] * gain : 0.0f;
+
+            for (int channel = 0; channel < numOutputChannels; ++channel)
+                outputs[channel][i] = dot(history.getReadPointer(channel, first), coefficients.data(), paddedTaps);
+        }
+        else
+        {
+            auto phase = frac * numPhases;
+            auto p0 = jmin(numPhases - 1, (int) phase);
+            auto a = (float) (phase - p0);
+
+            for (int channel = 0; channel < numOutputChannels; ++channel)
+            {
+                float s0, s1;
+                dot2(history.getReadPointer(channel, first), kernel.row(p0), kernel.row(p0 + 1), paddedTaps, s0, s1);
+                outputs[channel][i] = s0 + a * (s1 - s0);
+            }
+        }
+
+        position += step;
+    }
+}
@@ -0,0 +1,103 @@
+/*
+  ==============================================================================
+
+    DeckResampler.h
+    Created: 20 Oct 2026 1:18:44am
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// DeckResampler class: Single-stage windowed-sinc resampler for a deck. The file-to-device rate
+// conversion and the speed ratio are folded into one ratio, so each output sample costs one filter
+// evaluation. The filter is a polyphase table interpolated between phases; when the ratio is above 1
+// the kernel is stretched to lower the cutoff, so speeding a track up doesn't alias. Stretched tables
+// are built on a thread of the resampler's own as the ratio moves, and handed to the audio thread
+// without locks; until one is ready the stretched kernel is evaluated per tap.
+class DeckResampler : public juce::AudioSource,
+                      private juce::Thread {
+public:
+    // Taps per output sample: 8, 32 and 64. Standard is transparent for playback; draft is for
+    // slow machines, high for offline renders.
+    enum class Quality { draft, standard, high };
+
+    DeckResampler(juce::PositionableAudioSource* input, int numChannels); // input is neither owned nor prepared; starts the table thread
+    ~DeckResampler() override; // Stops the table thread
+
+    void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+    void getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill) override;
+    void releaseResources() override;
+
+    void setRatio(double inputSamplesPerOutputSample); // Any thread; takes effect on the next block
+    void setQuality(Quality quality); // Any thread; takes effect on the next block
+    void reset(); // Any thread; refills from just before the input's read position on the next block, e.g. after a seek
+
+    // Audio thread only: input samples pulled beyond the position of the next output sample. The
+    // input's read position minus this is where the output is.
+    double getLookahead() const;
+
+    static constexpr int preroll = 128; // Input a reset reads from before the read position: the widest stretched half-length (32 * 4)
+
+private:
+    // One polyphase table, a preset's or a stretched copy of one: (numPhases + 1) rows of paddedTaps coefficients, each row the
+    // kernel at one fractional offset, padded with zeros to a whole number of SIMD lanes
+    struct Kernel {
+        int halfTaps = 0;
+        int paddedTaps = 0;
+        double cutoff = 0.0, beta = 0.0; // Design, so a stretched copy can be built from a preset
+        int key = 0; // tableKey of a stretched table, 0 for a preset
+        std::vector<float> rows;
+
+        const float* row(int phase) const { return rows.data() + (size_t) phase * (size_t) paddedTaps; }
+        float at(double t) const; // Kernel value at t input samples from the centre, interpolated
+    };
+
+    static const Kernel& getKernel(Quality quality); // Built once per preset, shared by every deck
+    static Kernel buildKernel(int halfTaps, double cutoff, double beta);
+
+    static int getStretchSteps(double ratio); // Stretch rounded up to a step of 1 / stretchSteps above 1; 0 when unstretched
+    static int tableKey(Quality quality, int steps) { return ((int) quality + 1) * 256 + steps; }
+
+    void run() override; // Table thread: builds the table the audio thread asks for and frees the ones it has left behind
+
+    void compact(int keepBefore); // Drop input no longer reachable by the filter
+    void fill(int endIndex); // Pull input until endIndex samples are buffered
+    // stretch is what remains to apply per tap, above 1 only while kernel is a preset waiting for its stretched table
+    void process(float* const* outputs, int numOutputChannels, int numSamples, const Kernel& kernel, double ratio, double stretch);
+
+    static constexpr int numPhases = 256; // Fractional positions in the table
+    static constexpr int lanes = 4; // Taps are padded to a multiple of this for the SIMD dot products
+    static constexpr double maxStretch = 4.0; // Largest cutoff reduction; above this, ratios alias slightly
+    static constexpr int pollIntervalMs = 10; // Table thread's sleep between checks for a new ratio
+    static constexpr int stretchSteps = 16; // Tables per unit of stretch; a table's cutoff is at most this fraction lower than needed
+    static constexpr double minRatio = 1.0 / 16.0, maxRatio = 16.0;
+
+    juce::PositionableAudioSource* input;
+    const int numChannels;
+
+    juce::AudioBuffer<float> history; // Buffered input, index 0 being the oldest sample still needed
+    int numBuffered = 0; // Valid samples in history
+    double position = 0.0; // Input position of the next output sample, in history indices
+    int maxChunk = 0; // Output samples processed per pass, bounding the history size
+    std::vector<float> coefficients; // Kernel evaluated for one output sample while a stretched table is built
+
+    // Stretched tables, oldest first. Only the table thread adds or frees them; the audio thread picks up
+    // latestTable and marks it in tableInUse, after which no older table can be picked up again.
+    std::vector<std::unique_ptr<Kernel>> tables;
+    std::atomic<const Kernel*> latestTable { nullptr };
+    std::atomic<const Kernel*> tableInUse { nullptr };
+    std::atomic<int> wantedTable { 0 }; // tableKey the audio thread needs, 0 before it needs one
+
+    std::atomic<double> ratio { 1.0 };
+    std::atomic<int> quality { (int) Quality::standard };
+    std::atomic<bool> resetPending { true };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DeckResampler)
+};
@@ -0,0 +1,193 @@
+/*
+  ==============================================================================
+
+    DeckScheduler.cpp
+    Created: 20 Oct 2026 2:07:51am
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#include "DeckScheduler.h"
+#include <cmath>
+using namespace juce;
+
+DeckScheduler::Grid DeckScheduler::Grid::from(const BeatGrid& beatGrid)
+{
+    Grid result;
+    if (beatGrid.isEmpty())
+        return result;
+
+    result.beatPeriod = beatGrid.getBeatPeriod();
+    result.firstBeat = beatGrid.getBeats().front();
+    result.firstDownbeat = beatGrid.getFirstDownbeat();
+    return result;
+}
+
+// Lines extend before the first beat too, so a loop or cue in a track's intro still lands in time
+double DeckScheduler::Grid::nextLine(double seconds, Quantise quantise) const
+{
+    if (isEmpty() || quantise == Quantise::none)
+        return seconds;
+
+    double period = quantise == Quantise::bar ? beatPeriod * BeatGrid::beatsPerBar : beatPeriod;
+    double origin = quantise == Quantise::bar ? firstDownbeat : firstBeat;
+    return origin + std::ceil((seconds - origin) / period - tolerance) * period;
+}
+
+DeckScheduler::DeckScheduler()
+{
+}
+
+bool DeckScheduler::push(const Command& command)
+{
+    const SpinLock::ScopedLockType lock(pushLock);
+    const auto scope = fifo.write(1);
+    if (scope.blockSize1 + scope.blockSize2 == 0)
+        return false;
+
+    queue[(size_t) (scope.blockSize1 > 0 ? scope.startIndex1 : scope.startIndex2)] = command;
+    return true;
+}
+
+void DeckScheduler::beginBlock(double blockMs, double positionSeconds, bool running)
+{
+    const auto scope = fifo.read(fifo.getNumReady());
+    for (int i = 0; i < scope.blockSize1; ++i)
+        add(queue[(size_t) (scope.startIndex1 + i)], blockMs, positionSeconds, running);
+    for (int i = 0; i < scope.blockSize2; ++i)
+        add(queue[(size_t) (scope.startIndex2 + i)], blockMs, positionSeconds, running);
+}
+
+// Unquantised actions run one block after they were issued. Commands reach the audio thread within a
+// block of being pushed, so that delay is constant and the timing between presses survives intact.
+void DeckScheduler::add(const Command& command, double blockMs, double positionSeconds, bool running)
+{
+    if (command.action == Action::setGrid)
+    {
+        grid = command.grid;
+        requantise(positionSeconds);
+        return;
+    }
+
+    if (command.action == Action::reset)
+    {
+        numPending = 0;
+        looping = hasLoopStart = false;
+        return;
+    }
+
+    if (numPending == maxPending) // Only a stuck UI could get here; the oldest action goes first
+    {
+        for (int i = 1; i < numPending; ++i)
+            pending[(size_t) (i - 1)] = pending[(size_t) i];
+        --numPending;
+    }
+
+    auto& entry = pending[(size_t) numPending++];
+    entry.command = command;
+    entry.dueMs = command.issuedMs > 0.0 ? command.issuedMs + blockMs : 0.0;
+    resolve(entry, positionSeconds, running);
+}
+
+// A stopped deck's position doesn't move, so there is no line of its own to wait for. A start that
+// carries the other deck's beat clock waits for that deck's next line instead, counted on from when it
+// was issued; other quantised actions fall back to the time they were issued.
+void DeckScheduler::resolve(Pending& entry, double positionSeconds, bool running) const
+{
+    const auto& command = entry.command;
+    entry.onGrid = running && command.quantise != Quantise::none && ! grid.isEmpty();
+    if (entry.onGrid)
+    {
+        entry.dueSeconds = grid.nextLine(positionSeconds, command.quantise);
+    }
+    else if (! running && command.action == Action::start && command.quantise != Quantise::none
+             && command.masterBeatsPerMs > 0.0 && entry.dueMs > 0.0)
+    {
+        double beatsPerLine = command.quantise == Quantise::bar ? BeatGrid::beatsPerBar : 1.0;
+        double beatWhenDue = command.masterBeat + (entry.dueMs - command.issuedMs) * command.masterBeatsPerMs;
+        double line = std::ceil(beatWhenDue / beatsPerLine - tolerance) * beatsPerLine;
+        entry.dueMs = command.issuedMs + (line - command.masterBeat) / command.masterBeatsPerMs;
+    }
+}
+
+void DeckScheduler::requantise(double positionSeconds)
+{
+    for (int i = 0; i < numPending; ++i)
+        if (pending[(size_t) i].onGrid)
+            resolve(pending[(size_t) i], positionSeconds, true);
+}
+
+bool DeckScheduler::isDue(const Pending& entry, double nowMs, double positionSeconds, double secondsPerSample, bool running) const
+{
+    if (entry.onGrid)
+        return ! running || positionSeconds >= entry.dueSeconds - tolerance * secondsPerSample;
+    return nowMs >= entry.dueMs;
+}
+
+int DeckScheduler::samplesUntilNext(double nowMs, double positionSeconds, double secondsPerSample,
+                                    double sampleRate, bool running, int maxSamples) const
+{
+    double next = maxSamples;
+
+    for (int i = 0; i < numPending; ++i)
+    {
+        const auto& entry = pending[(size_t) i];
+        if (entry.onGrid)
+        {
+            if (running && secondsPerSample > 0.0)
+                next = jmin(next, std::ceil((entry.dueSeconds - positionSeconds) / secondsPerSample - tolerance));
+        }
+        else
+        {
+            next = jmin(next, std::ceil((entry.dueMs - nowMs) * sampleRate / 1000.0 - tolerance));
+        }
+    }
+
+    if (looping && running && secondsPerSample > 0.0)
+        next = jmin(next, std::ceil((loopEnd - positionSeconds) / secondsPerSample - tolerance));
+
+    return jlimit(1, jmax(1, maxSamples), (int) next);
+}
+
+// The loop end counts as an action of its own: a jump back to the loop start
+bool DeckScheduler::takeDue(double nowMs, double positionSeconds, double secondsPerSample, bool running, Command& command)
+{
+    if (looping && running && positionSeconds >= loopEnd - tolerance * secondsPerSample)
+    {
+        command = Command();
+        command.action = Action::jump;
+        command.seconds = loopStart;
+        return true;
+    }
+
+    for (int i = 0; i < numPending; ++i)
+    {
+        if (! isDue(pending[(size_t) i], nowMs, positionSeconds, secondsPerSample, running))
+            continue;
+
+        command = pending[(size_t) i].command;
+        for (int j = i + 1; j < numPending; ++j)
+            pending[(size_t) (j - 1)] = pending[(size_t) j];
+        --numPending;
+        return true;
+    }
+    return false;
+}
+
+void DeckScheduler::setLoopStart(double seconds)
+{
+    loopStart = seconds;
+    hasLoopStart = true;
+    looping = false;
+}
+
+bool DeckScheduler::closeLoop(double seconds)
+{
+    if (! hasLoopStart || seconds <= loopStart)
+        return false;
+
+    loopEnd = seconds;
+    looping = true;
+    return true;
+}
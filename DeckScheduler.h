@@ -0,0 +1,109 @@
+/*
+  ==============================================================================
+
+    DeckScheduler.h
+    Created: 20 Oct 2026 2:07:51am
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include "BeatGrid.h"
+
+// DeckScheduler class: Transport actions for one deck, queued by the message or MIDI thread and carried
+// out by the audio thread at an exact output sample. Quantised actions wait for the next beat or bar line
+// of the deck's grid; the rest run a fixed block after they were issued, so UI jitter doesn't reach the
+// audio. The deck asks how far it may render before the next action, renders that far, then performs it.
+class DeckScheduler {
+public:
+    enum class Quantise { none, beat, bar };
+
+    enum class Action {
+        start,
+        stop,
+        jump, // To Command::seconds
+        nudge, // By Command::seconds, e.g. from a jog wheel: a pitch bend while playing, a jump while stopped
+        loopIn, // Mark the loop start here
+        loopOut, // Close the loop here and jump back to its start, or leave an active loop
+        sync, // Match the other deck's tempo and beat phase
+        setGrid, // Replace the grid with Command::grid
+        reset // Drop pending actions and the loop; sent when the deck's track changes
+    };
+
+    // Constant-tempo grid copied from the track's BeatGrid, so the audio thread needs no vector
+    struct Grid {
+        double beatPeriod = 0.0; // Seconds per beat, 0 if the track has no grid
+        double firstBeat = 0.0;
+        double firstDownbeat = 0.0;
+
+        static Grid from(const BeatGrid& beatGrid);
+        bool isEmpty() const { return beatPeriod <= 0.0; }
+        double beatAt(double seconds) const { return (seconds - firstBeat) / beatPeriod; } // Beats since the first, fractional
+        double nextLine(double seconds, Quantise quantise) const; // First beat or bar line at or after seconds
+    };
+
+    struct Command {
+        Action action = Action::start;
+        Quantise quantise = Quantise::none;
+        double issuedMs = 0.0; // Time::getMillisecondCounterHiRes() when the user acted; 0 runs on the next block
+        double seconds = 0.0; // jump: track position to move to
+        double speed = 1.0; // sync: speed that matches the other deck's tempo
+        double masterBeat = 0.0; // sync: the other deck's beat count as heard at issuedMs; start: as rendered then
+        double masterBeatsPerMs = 0.0; // sync, start: how fast that count advances; 0 without one
+        Grid grid; // setGrid
+    };
+
+    DeckScheduler();
+
+    bool push(const Command& command); // Any thread but the audio thread; false if the queue is full
+
+    //==============================================================================
+    // Audio thread only. positionSeconds is the track position of the next output sample, nowMs the
+    // time that sample is rendered and secondsPerSample the track time each output sample covers.
+
+    void beginBlock(double blockMs, double positionSeconds, bool running); // Takes queued commands
+    int samplesUntilNext(double nowMs, double positionSeconds, double secondsPerSample, double sampleRate, bool running, int maxSamples) const;
+    bool takeDue(double nowMs, double positionSeconds, double secondsPerSample, bool running, Command& command); // Next action due here, if any
+    void requantise(double positionSeconds); // After a jump, quantised actions move to the lines after the new position
+
+    const Grid& getGrid() const { return grid; }
+    void setLoopStart(double seconds);
+    bool closeLoop(double seconds); // False if there is no loop start before seconds
+    void exitLoop() { looping = false; }
+    bool isLooping() const { return looping; }
+    double getLoopStart() const { return loopStart; }
+
+private:
+    struct Pending {
+        Command command;
+        bool onGrid = false; // Due at dueSeconds of track time, rather than at dueMs
+        double dueSeconds = 0.0;
+        double dueMs = 0.0;
+    };
+
+    void add(const Command& command, double blockMs, double positionSeconds, bool running);
+    void resolve(Pending& pending, double positionSeconds, bool running) const; // Place a quantised action on the grid
+    bool isDue(const Pending& pending, double nowMs, double positionSeconds, double secondsPerSample, bool running) const;
+
+    static constexpr int queueSize = 64;
+    static constexpr int maxPending = 32;
+    static constexpr double tolerance = 1.0e-6; // Fraction of a sample counted as having arrived
+
+    juce::AbstractFifo fifo { queueSize }; // Single producer at a time, single consumer (the audio thread)
+    juce::SpinLock pushLock; // Serialises the producers: the message thread and MIDI input. The audio thread never takes it.
+    std::array<Command, queueSize> queue;
+
+    std::array<Pending, maxPending> pending; // In the order they were issued
+    int numPending = 0;
+
+    Grid grid;
+    bool looping = false;
+    bool hasLoopStart = false;
+    double loopStart = 0.0, loopEnd = 0.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DeckScheduler)
+};
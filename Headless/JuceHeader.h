@@ -0,0 +1,26 @@
+/*
+  ==============================================================================
+
+    JuceHeader.h
+    Created: 19 Oct 2026 10:02:37pm
+    Author:  roscoe liew
+
+    Stand-in for the Projucer-generated header when the engine is built on its
+    own. Only the modules the engine uses are included, so nothing here needs a
+    window system.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <juce_audio_devices/juce_audio_devices.h>
+#include <juce_dsp/juce_dsp.h>
+
+#if ! DONT_SET_USING_JUCE_NAMESPACE
+ using namespace juce;
+#endif
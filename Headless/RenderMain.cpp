@@ -0,0 +1,145 @@
+/*
+  ==============================================================================
+
+    RenderMain.cpp
+    Created: 19 Oct 2026 10:02:37pm
+    Author:  roscoe liew
+
+    otodecks-render: drives the engine without a window or audio device.
+
+      otodecks-render <input> <output.wav> [--speed=<ratio>] [--seconds=<n>]
+          Plays the input on deck 1 through the mixer and writes the master
+          output to a 24-bit WAV, as fast as the machine allows.
+
+      otodecks-render --analyse <files...>
+          Runs the offline analysis on each file and prints tempo, key and
+          loudness, then the overall throughput.
+
+    Builds with OTODECKS_TRACING also accept --trace=<file.json> to write a
+    Chrome trace of the run.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+#include "MixerEngine.h"
+#include "TrackAnalyser.h"
+#include "Trace.h"
+
+namespace
+{
+    constexpr double renderSampleRate = 44100.0;
+    constexpr int renderBlockSize = 512;
+
+    int render(juce::AudioFormatManager& formatManager, const juce::ArgumentList& args)
+    {
+        juce::File input = args.arguments[0].resolveAsFile();
+        juce::File output = args.arguments[1].resolveAsFile();
+        double speed = args.containsOption("--speed") ? args.getValueForOption("--speed").getDoubleValue() : 1.0;
+        speed = juce::jlimit(0.25, 2.0, speed); // The range DJAudioPlayer::setSpeed accepts
+        double seconds = args.containsOption("--seconds") ? args.getValueForOption("--seconds").getDoubleValue() : 0.0;
+
+        MixerEngine engine(formatManager);
+        engine.setResamplingQuality(DeckResampler::Quality::high); // Speed is no object offline
+        auto& deck = engine.getDeck(0);
+        deck.loadURL(juce::URL(input));
+        if (! deck.isLoaded())
+        {
+            std::cerr << "Could not open " << input.getFullPathName() << std::endl;
+            return 1;
+        }
+
+        output.deleteFile();
+        auto stream = std::make_unique<juce::FileOutputStream>(output);
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatWriter> writer(wav.createWriterFor(stream.get(), renderSampleRate, 2, 24, {}, 0));
+        if (writer == nullptr)
+        {
+            std::cerr << "Could not write " << output.getFullPathName() << std::endl;
+            return 1;
+        }
+        stream.release(); // Owned by the writer now
+
+        deck.setSpeed(speed);
+        engine.prepareToPlay(renderBlockSize, renderSampleRate);
+        deck.start();
+
+        if (seconds <= 0.0)
+            seconds = deck.getLengthInSeconds() / speed;
+        auto remaining = (juce::int64) (seconds * renderSampleRate);
+
+        juce::AudioBuffer<float> buffer(2, renderBlockSize);
+        auto startMs = juce::Time::getMillisecondCounterHiRes();
+        while (remaining > 0)
+        {
+            int num = (int) juce::jmin((juce::int64) renderBlockSize, remaining);
+            buffer.clear();
+            engine.getNextAudioBlock(juce::AudioSourceChannelInfo(&buffer, 0, num));
+            writer->writeFromAudioSampleBuffer(buffer, 0, num);
+            remaining -= num;
+        }
+        auto elapsedMs = juce::Time::getMillisecondCounterHiRes() - startMs;
+
+        deck.stop();
+        engine.releaseResources();
+        std::cout << "Rendered " << seconds << " s in " << elapsedMs / 1000.0 << " s ("
+                  << seconds * 1000.0 / juce::jmax(1.0, elapsedMs) << "x real time)" << std::endl;
+        return 0;
+    }
+
+    int analyse(juce::AudioFormatManager& formatManager, const juce::ArgumentList& args)
+    {
+        std::atomic<bool> abort { false };
+        int numTracks = 0;
+        auto startMs = juce::Time::getMillisecondCounterHiRes();
+
+        for (int i = 0; i < args.size(); ++i) // Options are skipped below; every other argument is a track
+        {
+            if (args.arguments[i].isOption())
+                continue;
+
+            auto file = args.arguments[i].resolveAsFile();
+            auto analysis = TrackAnalyser::analyse(formatManager, file, nullptr, abort);
+            const auto& results = analysis.results;
+            ++numTracks;
+
+            std::cout << file.getFileName()
+                      << "\tbpm " << (results.bpm > 0.0f ? juce::String(results.bpm, 1) : juce::String("-"))
+                      << "\tkey " << (results.key >= 0 ? TrackLibrary::keyToCamelot(results.key) : juce::String("-"))
+                      << "\tloudness " << (results.hasLoudness ? juce::String(results.loudnessLufs, 1) + " LUFS, "
+                                                                 + juce::String(results.truePeakDb, 1) + " dBTP"
+                                                               : juce::String("-"))
+                      << std::endl;
+        }
+
+        auto elapsedSeconds = (juce::Time::getMillisecondCounterHiRes() - startMs) / 1000.0;
+        std::cout << numTracks << " tracks in " << elapsedSeconds << " s ("
+                  << numTracks / juce::jmax(0.001, elapsedSeconds) << " tracks/s)" << std::endl;
+        return 0;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser; // Message manager only; no window system is touched
+    juce::ArgumentList args(argc, argv);
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    int result = 1;
+    if (args.containsOption("--analyse"))
+        result = analyse(formatManager, args);
+    else if (args.size() >= 2)
+        result = render(formatManager, args);
+    else
+        std::cerr << "Usage: " << args.executableName << " <input> <output.wav> [--speed=<ratio>] [--seconds=<n>]" << std::endl
+                  << "       " << args.executableName << " --analyse <files...>" << std::endl;
+
+   #if OTODECKS_TRACING
+    if (args.containsOption("--trace"))
+        Trace::exportJson(args.getFileForOption("--trace"));
+   #endif
+    return result;
+}
@@ -0,0 +1,144 @@
+/*
+  ==============================================================================
+
+    KeyDetector.cpp
+    Created: 19 Oct 2026 8:25:51pm
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#include "KeyDetector.h"
+#include <vector>
+using namespace juce;
+
+namespace
+{
+    // Krumhansl-Kessler probe-tone profiles, tonic first
+    constexpr float majorProfile[12] = { 6.35f, 2.23f, 3.48f, 2.33f, 4.38f, 4.09f, 2.52f, 5.19f, 2.39f, 3.66f, 2.29f, 2.88f };
+    constexpr float minorProfile[12] = { 6.33f, 2.68f, 3.52f, 5.38f, 2.60f, 3.53f, 2.54f, 4.75f, 3.98f, 2.69f, 3.34f, 3.17f };
+
+    // Pearson correlation of the chroma against a profile rotated to start on tonic
+    float correlate(const KeyDetector::Chroma& chroma, const float* profile, int tonic)
+    {
+        float chromaMean = 0.0f, profileMean = 0.0f;
+        for (int i = 0; i < 12; ++i)
+        {
+            chromaMean += chroma[(size_t) i];
+            profileMean += profile[i];
+        }
+        chromaMean /= 12.0f;
+        profileMean /= 12.0f;
+
+        float covariance = 0.0f, chromaVariance = 0.0f, profileVariance = 0.0f;
+        for (int i = 0; i < 12; ++i)
+        {
+            float c = chroma[(size_t) ((tonic + i) % 12)] - chromaMean;
+            float p = profile[i] - profileMean;
+            covariance += c * p;
+            chromaVariance += c * c;
+            profileVariance += p * p;
+        }
+
+        float denominator = std::sqrt(chromaVariance * profileVariance);
+        return denominator > 0.0f ? covariance / denominator : 0.0f;
+    }
+}
+
+int KeyDetector::estimateKey(const Chroma& chroma)
+{
+    int bestKey = -1;
+    float bestCorrelation = minCorrelation;
+
+    for (int tonic = 0; tonic < 12; ++tonic)
+    {
+        float major = correlate(chroma, majorProfile, tonic);
+        float minor = correlate(chroma, minorProfile, tonic);
+        if (major > bestCorrelation)
+        {
+            bestCorrelation = major;
+            bestKey = tonic;
+        }
+        if (minor > bestCorrelation)
+        {
+            bestCorrelation = minor;
+            bestKey = 12 + tonic;
+        }
+    }
+    return bestKey;
+}
+
+// Excerpts skip the first and last 10% of the track, where intros and outros are often drums only.
+// Decimation is a plain box average: the small amount of aliasing it lets through lands in bins
+// spread across all pitch classes and barely moves the profile match.
+int KeyDetector::detect(AudioFormatReader& reader, const std::atomic<bool>& abort)
+{
+    if (reader.sampleRate <= 0.0 || reader.lengthInSamples <= 0)
+        return -1;
+
+    const int decimation = jmax(1, roundToInt(reader.sampleRate / analysisRate));
+    const double rate = reader.sampleRate / decimation;
+    const int excerptSamples = fftSize * decimation;
+    const int numChannels = jmin(2, (int) reader.numChannels);
+
+    const int64 start = reader.lengthInSamples / 10;
+    const int64 span = reader.lengthInSamples - 2 * start - excerptSamples;
+    if (span < 0)
+        return -1; // Too short to say anything useful
+
+    // FFT bin -> pitch class, -1 outside the note range
+    std::vector<int> pitchClass((size_t) fftSize / 2, -1);
+    for (int bin = 1; bin < fftSize / 2; ++bin)
+    {
+        auto frequency = (float) (bin * rate / fftSize);
+        if (frequency >= minFrequency && frequency <= maxFrequency)
+        {
+            int midiNote = roundToInt(69.0f + 12.0f * std::log2(frequency / 440.0f));
+            pitchClass[(size_t) bin] = midiNote % 12;
+        }
+    }
+
+    dsp::FFT fft(fftOrder);
+    dsp::WindowingFunction<float> window((size_t) fftSize, dsp::WindowingFunction<float>::hann);
+    AudioBuffer<float> buffer(numChannels, excerptSamples);
+    std::vector<float> fftData((size_t) fftSize * 2);
+    Chroma chroma {};
+
+    for (int excerpt = 0; excerpt < numExcerpts; ++excerpt)
+    {
+        if (abort.load())
+            return -1;
+
+        int64 position = start + span * excerpt / jmax(1, numExcerpts - 1);
+        if (! reader.read(&buffer, 0, excerptSamples, position, true, true))
+            return -1;
+
+        // Mono mix and box decimation in one pass
+        const float* left = buffer.getReadPointer(0);
+        const float* right = buffer.getReadPointer(numChannels - 1);
+        const float scale = 0.5f / (float) decimation;
+        for (int i = 0; i < fftSize; ++i)
+        {
+            float sum = 0.0f;
+            for (int j = i * decimation; j < (i + 1) * decimation; ++j)
+                sum += left[j] + right[j];
+            fftData[(size_t) i] = sum * scale;
+        }
+
+        window.multiplyWithWindowingTable(fftData.data(), (size_t) fftSize);
+        fft.performFrequencyOnlyForwardTransform(fftData.data(), true);
+
+        // Each frame is normalised so loud sections don't outvote quiet ones
+        Chroma frame {};
+        for (int bin = 1; bin < fftSize / 2; ++bin)
+            if (pitchClass[(size_t) bin] >= 0)
+                frame[(size_t) pitchClass[(size_t) bin]] += fftData[(size_t) bin];
+
+        float loudest = *std::max_element(frame.begin(), frame.end());
+        if (loudest > 0.0f)
+            for (int i = 0; i < 12; ++i)
+                chroma[(size_t) i] += frame[(size_t) i] / loudest;
+    }
+
+    return estimateKey(chroma);
+}
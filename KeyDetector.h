@@ -0,0 +1,39 @@
+/*
+  ==============================================================================
+
+    KeyDetector.h
+    Created: 19 Oct 2026 8:25:51pm
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+
+// KeyDetector class: Offline musical key estimate. Short excerpts spread over the track are mixed to
+// mono, decimated to a few kHz and folded into a 12-bin chromagram, which is matched against the
+// Krumhansl-Kessler major and minor key profiles. Only the excerpts are decoded, so a track costs a
+// few tens of milliseconds whatever its length.
+class KeyDetector {
+public:
+    static constexpr int fftOrder = 12; // 4096-point FFT, about 0.75 s at the analysis rate
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int numExcerpts = 24; // One FFT frame per excerpt
+    static constexpr double analysisRate = 5512.5; // Target rate after decimation; enough for notes up to C7
+    static constexpr float minFrequency = 65.4f; // C2
+    static constexpr float maxFrequency = 2093.0f; // C7
+    static constexpr float minCorrelation = 0.5f; // Weaker matches are reported as unknown
+
+    using Chroma = std::array<float, 12>; // Energy per pitch class, C first
+
+    // Key as stored in TrackRecord (0-11 C..B major, 12-23 C..B minor), or -1 if unclear, unreadable
+    // or aborted. Any thread.
+    static int detect(juce::AudioFormatReader& reader, const std::atomic<bool>& abort);
+
+    // Best matching key for a chromagram, or -1 if no profile correlates well enough
+    static int estimateKey(const Chroma& chroma);
+};
@@ -0,0 +1,219 @@
+/*
+  ==============================================================================
+
+    LatencyTester.cpp
+    Created: 20 Oct 2026 12:31:08am
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#include "LatencyTester.h"
+#include <algorithm>
+#include <vector>
+using namespace juce;
+
+bool LatencyTester::Measurement::appliesTo(AudioIODevice& device) const
+{
+    return roundTripSamples > 0
+           && deviceName == device.getName()
+           && sampleRate == device.getCurrentSampleRate()
+           && bufferSize == device.getCurrentBufferSizeSamples();
+}
+
+int LatencyTester::getOutputLatencySamples(AudioIODevice& device, const Measurement& measured)
+{
+    if (measured.appliesTo(device))
+        return jmax(0, measured.roundTripSamples - device.getInputLatencyInSamples());
+    return device.getOutputLatencyInSamples() + device.getCurrentBufferSizeSamples();
+}
+
+LatencyTester::LatencyTester(AudioDeviceManager& _deviceManager) : deviceManager(_deviceManager)
+{
+}
+
+LatencyTester::~LatencyTester()
+{
+    stopTimer();
+    if (running)
+        deviceManager.removeAudioCallback(this);
+}
+
+void LatencyTester::start(std::function<void(const Result&)> _onDone)
+{
+    if (running)
+        return;
+
+    onDone = std::move(_onDone);
+
+    Result result;
+    auto* device = deviceManager.getCurrentAudioDevice();
+    if (device == nullptr)
+    {
+        result.error = "No audio device is open";
+        finish(result);
+        return;
+    }
+    if (device->getActiveInputChannels().isZero() || device->getActiveOutputChannels().isZero())
+    {
+        result.error = "Enable an input and an output channel, and connect the output back to the input";
+        finish(result);
+        return;
+    }
+
+    audioFinished = false;
+    noInputs = false;
+    running = true;
+    startedMs = Time::getMillisecondCounterHiRes();
+    deviceManager.addAudioCallback(this); // Calls audioDeviceAboutToStart before the first callback
+    startTimer(50);
+}
+
+// Called before this callback joins the device, so the audio thread state needs no locking
+void LatencyTester::audioDeviceAboutToStart(AudioIODevice* device)
+{
+    sampleRate = device->getCurrentSampleRate();
+    sampleCount = 0;
+    nextClickAt = (int64) (gapSeconds * sampleRate);
+    clickSentAt = -1;
+    noisePeak = 0.0f;
+    clickPeak = 0.0f;
+    settling = false;
+    threshold = 0.0f;
+    clicksSent = 0;
+    delays.fill(-1);
+    noInputs = device->getActiveInputChannels().isZero();
+}
+
+void LatencyTester::audioDeviceStopped()
+{
+}
+
+// The device manager sums every callback's output, so this one writes silence apart from the clicks
+void LatencyTester::audioDeviceIOCallbackWithContext(const float* const* inputChannelData, int numInputChannels,
+                                                     float* const* outputChannelData, int numOutputChannels,
+                                                     int numSamples, const AudioIODeviceCallbackContext&)
+{
+    for (int channel = 0; channel < numOutputChannels; ++channel)
+        if (outputChannelData[channel] != nullptr)
+            FloatVectorOperations::clear(outputChannelData[channel], numSamples);
+
+    if (audioFinished.load(std::memory_order_relaxed) || noInputs.load(std::memory_order_relaxed))
+        return;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        auto now = sampleCount + i;
+
+        float input = 0.0f;
+        for (int channel = 0; channel < numInputChannels; ++channel)
+            if (inputChannelData[channel] != nullptr)
+                input = jmax(input, std::abs(inputChannelData[channel][i]));
+
+        if (clickSentAt < 0)
+        {
+            if (now < nextClickAt)
+            {
+                // A band-limited loop smears the click and rings after it, so the start of the gap is
+                // still the click; only what follows is noise
+                if (now < nextClickAt - (int64) ((gapSeconds - settleSeconds) * sampleRate))
+                {
+                    if (settling)
+                        clickPeak = jmax(clickPeak, input);
+                }
+                else
+                {
+                    settling = false;
+                    noisePeak = jmax(noisePeak, input);
+                }
+                continue;
+            }
+
+            // Well above whatever the loop picked up while quiet, so hum or hiss can't trigger it, but
+            // never so high that a click as loud as the last one would be missed
+            auto noise = clickPeak > 0.0f ? jmin(noisePeak, clickPeak * maxNoiseFraction) : noisePeak;
+            threshold = jmax(minThreshold, noise * 4.0f);
+            for (int channel = 0; channel < numOutputChannels; ++channel)
+                if (outputChannelData[channel] != nullptr)
+                    outputChannelData[channel][i] = clickLevel;
+            clickSentAt = now;
+            continue;
+        }
+
+        auto elapsed = now - clickSentAt;
+        bool heard = elapsed > 0 && input > threshold;
+        if (! heard && elapsed < (int64) (timeoutSeconds * sampleRate))
+            continue;
+
+        delays[(size_t) clicksSent] = heard ? (int) elapsed : -1;
+        clickSentAt = -1;
+        noisePeak = 0.0f;
+        settling = heard;
+        if (heard)
+            clickPeak = input; // Rises to the click's peak over the settle period
+        nextClickAt = now + (int64) (gapSeconds * sampleRate);
+
+        if (++clicksSent == numClicks)
+        {
+            audioFinished.store(true, std::memory_order_release);
+            break;
+        }
+    }
+
+    sampleCount += numSamples;
+}
+
+// The median ignores the odd click masked by a noise burst; the spread shows whether the loop is stable
+void LatencyTester::timerCallback()
+{
+    Result result;
+    result.sampleRate = sampleRate;
+
+    if (noInputs.load())
+    {
+        result.error = "The device has no active input channel";
+        finish(result);
+        return;
+    }
+
+    if (! audioFinished.load(std::memory_order_acquire))
+    {
+        auto limitMs = 1000.0 * numClicks * (gapSeconds + timeoutSeconds) + 2000.0;
+        if (Time::getMillisecondCounterHiRes() - startedMs > limitMs)
+        {
+            result.error = "The audio device stopped during the measurement";
+            finish(result);
+        }
+        return;
+    }
+
+    std::vector<int> returned;
+    for (int delay : delays)
+        if (delay > 0)
+            returned.push_back(delay);
+
+    if ((int) returned.size() < minReturned)
+    {
+        result.error = "Only " + String((int) returned.size()) + " of " + String(numClicks)
+                       + " clicks came back; check the loopback connection and input level";
+        finish(result);
+        return;
+    }
+
+    std::sort(returned.begin(), returned.end());
+    result.valid = true;
+    result.roundTripSamples = returned[returned.size() / 2];
+    result.spreadSamples = returned.back() - returned.front();
+    finish(result);
+}
+
+void LatencyTester::finish(Result result)
+{
+    stopTimer();
+    if (running)
+        deviceManager.removeAudioCallback(this);
+    running = false;
+
+    if (onDone)
+        onDone(result);
+}
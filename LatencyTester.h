@@ -0,0 +1,93 @@
+/*
+  ==============================================================================
+
+    LatencyTester.h
+    Created: 20 Oct 2026 12:31:08am
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <functional>
+
+// LatencyTester class: Loopback round-trip measurement. With an output cabled (or routed) back to an
+// input, it adds a train of single-sample clicks to the device output and times how long each takes
+// to arrive at the input. It runs alongside the app's own audio callback, which keeps playing.
+class LatencyTester : private juce::AudioIODeviceCallback,
+                      private juce::Timer {
+public:
+    struct Result {
+        bool valid = false;
+        int roundTripSamples = 0; // Median over the clicks that came back
+        int spreadSamples = 0; // Largest minus smallest; more than a few samples means a noisy loop
+        double sampleRate = 0.0;
+        juce::String error; // Why the result isn't valid
+    };
+
+    // A round trip is only valid for the device, rate and buffer size it was measured with
+    struct Measurement {
+        juce::String deviceName;
+        double sampleRate = 0.0;
+        int bufferSize = 0;
+        int roundTripSamples = 0; // 0 if nothing has been measured
+
+        bool appliesTo(juce::AudioIODevice& device) const;
+    };
+
+    // Time from a block leaving the callback to it being heard. With a matching measurement that's the
+    // round trip less the device's reported input latency; otherwise the reported output latency plus
+    // the one buffer still ahead of the block.
+    static int getOutputLatencySamples(juce::AudioIODevice& device, const Measurement& measured);
+
+    explicit LatencyTester(juce::AudioDeviceManager& deviceManager);
+    ~LatencyTester() override; // Abandons a measurement in progress
+
+    // Message thread. Calls onDone on the message thread when every click has come back or timed out.
+    void start(std::function<void(const Result&)> onDone);
+    bool isRunning() const { return running; }
+
+private:
+    void audioDeviceIOCallbackWithContext(const float* const* inputChannelData, int numInputChannels,
+                                          float* const* outputChannelData, int numOutputChannels,
+                                          int numSamples, const juce::AudioIODeviceCallbackContext& context) override;
+    void audioDeviceAboutToStart(juce::AudioIODevice* device) override;
+    void audioDeviceStopped() override;
+    void timerCallback() override; // Polls for the audio thread finishing
+    void finish(Result result); // Detach from the device and report
+
+    static constexpr int numClicks = 8; // Clicks per measurement
+    static constexpr int minReturned = 3; // Clicks that must come back for a valid result
+    static constexpr double gapSeconds = 0.25; // Quiet time before each click
+    static constexpr double settleSeconds = 0.125; // Start of the gap left for the last click to ring out; the rest measures the noise floor
+    static constexpr double timeoutSeconds = 1.0; // A click not heard within this is counted as lost
+    static constexpr float clickLevel = 0.8f; // Output level of a click
+    static constexpr float minThreshold = 0.02f; // Input level that counts as a detection in a silent loop
+    static constexpr float maxNoiseFraction = 0.125f; // Noise floor is capped at this much of the returned click level
+
+    juce::AudioDeviceManager& deviceManager;
+    std::function<void(const Result&)> onDone;
+    bool running = false;
+    double startedMs = 0.0; // Wall-clock start, to give up if the device stops mid-measurement
+
+    // Audio thread state, reset by audioDeviceAboutToStart
+    double sampleRate = 0.0;
+    juce::int64 sampleCount = 0; // Samples since the callback started
+    juce::int64 nextClickAt = 0; // Sample the next click goes out on
+    juce::int64 clickSentAt = -1; // Sample the last click went out on, -1 while waiting to send
+    float noisePeak = 0.0f; // Loudest input after the settle period of the gap before the click
+    float clickPeak = 0.0f; // Loudest input while the last heard click settled: its level as it came back; 0 until one is heard
+    bool settling = false; // Within the settle period after a heard click, so input is still the click
+    float threshold = 0.0f; // Input level that counts as the click arriving
+    int clicksSent = 0;
+
+    std::array<int, numClicks> delays {}; // Round trip of each click, -1 if lost; written by the audio thread
+    std::atomic<bool> audioFinished { false }; // Set once every click has been sent and resolved
+    std::atomic<bool> noInputs { false }; // Set if the device was started without an input channel
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LatencyTester)
+};
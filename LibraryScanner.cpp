@@ -0,0 +1,260 @@
+/*
+  ==============================================================================
+
+    LibraryScanner.cpp
+    Created: 19 Oct 2026 3:41:05pm
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#include "LibraryScanner.h"
+using namespace juce;
+
+LibraryScanner::LibraryScanner(TrackLibrary& _library, AudioFormatManager& _formatManager)
+    : Thread("Library scanner"), library(_library), formatManager(_formatManager)
+{
+}
+
+LibraryScanner::~LibraryScanner()
+{
+    cancel();
+    stopThread(4000);
+}
+
+void LibraryScanner::scanFolder(const File& folder)
+{
+    beginScan();
+    walkedFolders.addIfNotAlreadyThere(folder);
+    {
+        const ScopedLock sl(queueLock);
+        pendingFolders.addIfNotAlreadyThere(folder);
+    }
+    ensureWalking();
+}
+
+void LibraryScanner::scanFiles(const Array<File>& files)
+{
+    beginScan();
+    {
+        const ScopedLock sl(queueLock);
+        pendingFiles.insert(pendingFiles.end(), files.begin(), files.end());
+    }
+    ensureWalking();
+}
+
+// Snapshots what the library already holds so unchanged files can be skipped without opening them
+void LibraryScanner::beginScan()
+{
+    if (scanning)
+        return;
+
+    wildcard = formatManager.getWildcardForAllFormats();
+
+    knownFiles.clear();
+    knownFiles.reserve((size_t) library.getNumTracks());
+    for (int i = 0; i < library.getNumTracks(); ++i)
+    {
+        const auto& record = library.getRecord(i);
+        knownFiles[record.pathHash] = { record.fileSize, record.modificationTime };
+    }
+
+    walkedFolders.clear();
+    foundHashes.clear();
+    cancelled = false;
+    numFound = 0;
+    numProcessed = 0;
+    numAdded = 0;
+    scanning = true;
+
+    startTimer(flushIntervalMs);
+    sendChangeMessage();
+}
+
+// The walk thread exits as soon as the queue runs dry, so requests arriving later restart it
+void LibraryScanner::ensureWalking()
+{
+    {
+        const ScopedLock sl(queueLock);
+        if (! walkFinished)
+            return; // The running walk will pick the new work up
+        walkFinished = false;
+    }
+    waitForThreadToExit(1000); // It has already decided to exit; let it finish
+    startThread();
+}
+
+void LibraryScanner::cancel()
+{
+    if (! scanning)
+        return;
+
+    cancelled = true;
+    stopThread(4000);
+    {
+        const ScopedLock sl(queueLock);
+        pendingFolders.clear();
+        pendingFiles.clear();
+        walkFinished = true;
+    }
+    workers.removeAllJobs(true, 4000);
+    stopTimer();
+
+    flushResults(); // Keep whatever was already read
+    scanning = false;
+    sendChangeMessage();
+}
+
+void LibraryScanner::run()
+{
+    while (! threadShouldExit())
+    {
+        File folder;
+        std::vector<File> files;
+        {
+            const ScopedLock sl(queueLock);
+            if (! pendingFolders.isEmpty())
+                folder = pendingFolders.removeAndReturn(0);
+            else if (! pendingFiles.empty())
+                files.swap(pendingFiles);
+            else
+            {
+                walkFinished = true;
+                return;
+            }
+        }
+
+        if (folder != File())
+        {
+            walkFolder(folder);
+        }
+        else
+        {
+            numFound += (int) files.size();
+            for (size_t start = 0; start < files.size(); start += batchSize)
+            {
+                auto end = files.begin() + (std::ptrdiff_t) jmin(files.size(), start + batchSize);
+                queueBatch(std::vector<File>(files.begin() + (std::ptrdiff_t) start, end));
+            }
+        }
+    }
+}
+
+// Walks the tree, queueing paths in batches. The walk pauses when the pool has plenty of
+// work queued, so a huge tree doesn't pile up millions of pending paths in memory.
+void LibraryScanner::walkFolder(const File& folder)
+{
+    std::vector<File> batch;
+    batch.reserve(batchSize);
+
+    for (const auto& entry : RangedDirectoryIterator(folder, true, wildcard, File::findFiles))
+    {
+        if (threadShouldExit())
+            return;
+
+        batch.push_back(entry.getFile());
+        foundHashes.insert((uint64) entry.getFile().getFullPathName().hashCode64());
+        ++numFound;
+
+        if ((int) batch.size() == batchSize)
+        {
+            queueBatch(std::move(batch));
+            batch.clear();
+            batch.reserve(batchSize);
+        }
+
+        while (workers.getNumJobs() > workers.getNumThreads() * 4 && ! threadShouldExit())
+            wait(5);
+    }
+
+    if (! batch.empty())
+        queueBatch(std::move(batch));
+}
+
+void LibraryScanner::queueBatch(std::vector<File>&& files)
+{
+    workers.addJob([this, files = std::move(files)]
+    {
+        readBatch(files);
+    });
+}
+
+void LibraryScanner::readBatch(const std::vector<File>& files)
+{
+    std::vector<TrackInfo> read;
+    read.reserve(files.size());
+
+    for (auto& file : files)
+    {
+        if (cancelled)
+            return;
+
+        if (! isUnchanged(file))
+        {
+            TrackInfo info;
+            if (TrackLibrary::readTrackInfo(formatManager, file, info))
+                read.push_back(std::move(info));
+        }
+        ++numProcessed;
+    }
+
+    const ScopedLock sl(resultsLock);
+    results.insert(results.end(), std::make_move_iterator(read.begin()), std::make_move_iterator(read.end()));
+}
+
+bool LibraryScanner::isUnchanged(const File& file) const
+{
+    auto it = knownFiles.find((uint64) file.getFullPathName().hashCode64());
+    return it != knownFiles.end()
+           && it->second.fileSize == file.getSize()
+           && it->second.modificationTime == file.getLastModificationTime().toMilliseconds();
+}
+
+void LibraryScanner::flushResults()
+{
+    std::vector<TrackInfo> batch;
+    {
+        const ScopedLock sl(resultsLock);
+        batch.swap(results);
+    }
+
+    if (! batch.empty())
+    {
+        library.addTracks(batch);
+        numAdded += (int) batch.size();
+    }
+}
+
+// Only tracks the walk didn't see need a disk check, so a clean rescan costs one hash lookup per track.
+// The flags are applied in one go, so a rescan is a single library change however many tracks it covers.
+void LibraryScanner::updateMissingFlags()
+{
+    std::vector<std::pair<int, bool>> updates;
+    for (auto& folder : walkedFolders)
+    {
+        for (int index : library.findTracksUnder(folder))
+        {
+            bool found = foundHashes.count(library.getRecord(index).pathHash) > 0;
+            updates.emplace_back(index, ! found && ! library.getFile(index).existsAsFile());
+        }
+    }
+    library.setMissing(updates);
+}
+
+// Inserts everything read since the last tick as one library change
+void LibraryScanner::timerCallback()
+{
+    // Checked before taking the results: a job only leaves the pool after it has queued its results
+    bool finished = walkFinished && workers.getNumJobs() == 0;
+
+    flushResults();
+
+    if (finished)
+    {
+        stopTimer();
+        updateMissingFlags();
+        scanning = false;
+        DBG("LibraryScanner: added " << numAdded.load() << " of " << numFound.load() << " files");
+    }
+    sendChangeMessage();
+}
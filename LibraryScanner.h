@@ -0,0 +1,90 @@
+/*
+  ==============================================================================
+
+    LibraryScanner.h
+    Created: 19 Oct 2026 3:41:05pm
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "TrackLibrary.h"
+
+// LibraryScanner class: Recursive folder import. One thread walks the directory tree and hands
+// batches of paths to a worker pool that reads only the file headers. Finished batches are
+// inserted into the library on the message thread a few times a second. Listeners get a change
+// message whenever progress moves and when the scan ends.
+class LibraryScanner : public juce::ChangeBroadcaster,
+                       private juce::Thread,
+                       private juce::Timer {
+public:
+    LibraryScanner(TrackLibrary& library, juce::AudioFormatManager& formatManager);
+    ~LibraryScanner() override; // Cancels any running scan
+
+    // Message thread. Both join the scan in progress, or start one. Once a folder has been walked
+    // completely, library tracks under it that weren't found are flagged missing.
+    void scanFolder(const juce::File& folder); // Walk a folder tree
+    void scanFiles(const juce::Array<juce::File>& files); // Re-read specific files, e.g. after they changed on disk
+
+    void cancel(); // Message thread; stops the scan, keeping tracks already inserted
+    bool isScanning() const { return scanning; } // True from the first request until the last batch is inserted
+
+    int getNumFound() const { return numFound.load(); } // Audio files found so far
+    int getNumProcessed() const { return numProcessed.load(); } // Files whose headers have been read or skipped
+    int getNumAdded() const { return numAdded.load(); } // Files inserted into the library
+
+private:
+    struct KnownFile {
+        juce::int64 fileSize;
+        juce::int64 modificationTime;
+    };
+
+    void run() override; // Works through the queued folders and files
+    void timerCallback() override; // Insert finished batches and report progress
+    void beginScan(); // Snapshot the library and reset counters if no scan is running
+    void ensureWalking(); // Start the walk thread if it has finished or never ran
+    void walkFolder(const juce::File& folder); // Walk thread: find audio files under a folder
+    void queueBatch(std::vector<juce::File>&& files); // Hand a batch of paths to the worker pool
+    void readBatch(const std::vector<juce::File>& files); // Worker: read headers and queue the results
+    bool isUnchanged(const juce::File& file) const; // True if the library already has this exact file
+    void flushResults(); // Insert everything read so far into the library
+    void updateMissingFlags(); // Flag tracks under the walked folders that the walk didn't find
+
+    static constexpr int batchSize = 32; // Files per worker job
+    static constexpr int flushIntervalMs = 250; // How often results are inserted into the library
+
+    TrackLibrary& library;
+    juce::AudioFormatManager& formatManager;
+
+    // Header reads wait on the disk far more than the CPU, so the pool is deliberately
+    // wider than the core count to keep enough requests in flight
+    juce::ThreadPool workers { juce::jmax(4, juce::SystemStats::getNumCpus() * 2) };
+
+    juce::String wildcard; // Extensions the format manager can open
+    std::unordered_map<juce::uint64, KnownFile> knownFiles; // Library contents when the scan started; read-only during the scan
+
+    juce::CriticalSection queueLock; // Guards pendingFolders, pendingFiles and walkFinished changes
+    juce::Array<juce::File> pendingFolders; // Folders waiting to be walked
+    std::vector<juce::File> pendingFiles; // Files waiting to be read
+    juce::Array<juce::File> walkedFolders; // Folders requested in this scan, checked for missing tracks at the end
+    std::unordered_set<juce::uint64> foundHashes; // Path hashes seen by the walk; walk thread only until it finishes
+
+    juce::CriticalSection resultsLock; // Guards results
+    std::vector<TrackInfo> results; // Read but not yet inserted
+
+    std::atomic<bool> cancelled { false }; // Tells queued jobs to skip their work
+    std::atomic<bool> walkFinished { true }; // Set once every queued folder and file has been handed to the pool
+    std::atomic<int> numFound { 0 };
+    std::atomic<int> numProcessed { 0 };
+    std::atomic<int> numAdded { 0 };
+    bool scanning = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LibraryScanner)
+};
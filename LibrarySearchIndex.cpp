@@ -0,0 +1,281 @@
+/*
+  ==============================================================================
+
+    LibrarySearchIndex.cpp
+    Created: 19 Oct 2026 4:27:52pm
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#include "LibrarySearchIndex.h"
+#include <algorithm>
+#include <cctype>
+#include <string_view>
+using namespace juce;
+
+namespace
+{
+    // Bytes of multi-byte UTF-8 sequences count as word characters so accented words stay whole
+    bool isWordChar(char c)
+    {
+        auto u = (unsigned char) c;
+        return u >= 0x80 || std::isalnum(u);
+    }
+}
+
+LibraryQuery LibraryQuery::parse(const String& text)
+{
+    LibraryQuery query;
+
+    for (auto& token : StringArray::fromTokens(text.toLowerCase(), true))
+    {
+        if (token.startsWith("bpm:"))
+        {
+            // "bpm:124" allows half a beat either side; "bpm:120-128" is an inclusive range
+            auto range = token.substring(4);
+            if (range.isEmpty())
+                continue;
+
+            float low = range.upToFirstOccurrenceOf("-", false, false).getFloatValue();
+            float high = range.contains("-") ? range.fromFirstOccurrenceOf("-", false, false).getFloatValue() : low;
+            if (! range.contains("-"))
+            {
+                low -= 0.5f;
+                high += 0.5f;
+            }
+            if (high > 0.0f && high >= low)
+            {
+                query.minBpm = low;
+                query.maxBpm = high;
+            }
+        }
+        else if (token.startsWith("key:"))
+        {
+            query.key = TrackLibrary::camelotToKey(token.substring(4));
+        }
+        else
+        {
+            query.terms.push_back(token.toStdString());
+        }
+    }
+    return query;
+}
+
+// Narrowing holds when the filters are unchanged and each earlier term only got longer in a way
+// that can't admit new tracks; a term crossing from word-prefix to substring matching doesn't qualify
+bool LibraryQuery::narrows(const LibraryQuery& previous) const
+{
+    if (minBpm != previous.minBpm || maxBpm != previous.maxBpm || key != previous.key)
+        return false;
+    if (terms.size() < previous.terms.size())
+        return false;
+
+    for (size_t i = 0; i < previous.terms.size(); ++i)
+    {
+        const auto& before = previous.terms[i];
+        const auto& now = terms[i];
+        bool wasShort = before.size() < 3, isShort = now.size() < 3;
+
+        if (wasShort && isShort && now.compare(0, before.size(), before) != 0)
+            return false;
+        if (! wasShort && ! isShort && now.find(before) == std::string::npos)
+            return false;
+        if (wasShort != isShort)
+            return false;
+    }
+    return true;
+}
+
+// Builds the text blob, trigram postings and word list in one pass over the tracks
+LibrarySearchIndex::LibrarySearchIndex(std::vector<TrackRecord> _records, const std::vector<char>& strings)
+    : records(std::move(_records))
+{
+    auto readString = [&strings](uint32 offset, uint32 length)
+    {
+        if (length == 0 || (size_t) offset + length > strings.size())
+            return String();
+        return String::fromUTF8(strings.data() + offset, (int) length);
+    };
+
+    textOffsets.reserve(records.size() + 1);
+    text.reserve(records.size() * 48);
+
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        const auto& record = records[i];
+        auto lower = (readString(record.artistOffset, record.artistLength) + " "
+                      + readString(record.titleOffset, record.titleLength)).toLowerCase();
+
+        textOffsets.push_back((uint32) text.size());
+        text += lower.toRawUTF8();
+        text += '\0';
+    }
+    textOffsets.push_back((uint32) text.size());
+
+    for (int track = 0; track < (int) records.size(); ++track)
+    {
+        auto begin = textOffsets[(size_t) track];
+        auto end = textOffsets[(size_t) track + 1] - 1; // Exclude the terminator
+
+        for (auto i = begin; i + trigramLength <= end; ++i)
+        {
+            auto& postings = trigrams[trigramAt(text.data() + i)];
+            if (postings.empty() || postings.back() != track)
+                postings.push_back(track);
+        }
+
+        for (auto i = begin; i < end;)
+        {
+            while (i < end && ! isWordChar(text[i]))
+                ++i;
+            auto start = i;
+            while (i < end && isWordChar(text[i]))
+                ++i;
+            if (i > start)
+                words.push_back({ start, i - start, track });
+        }
+    }
+
+    std::sort(words.begin(), words.end(), [this](const WordEntry& a, const WordEntry& b)
+    {
+        return std::string_view(text.data() + a.offset, a.length) < std::string_view(text.data() + b.offset, b.length);
+    });
+}
+
+std::vector<int> LibrarySearchIndex::search(const LibraryQuery& query, const std::vector<int>* within) const
+{
+    std::vector<int> result;
+
+    if (within != nullptr)
+    {
+        result.reserve(within->size());
+        for (int track : *within)
+            if (track < (int) records.size() && matches(track, query))
+                result.push_back(track);
+        return result;
+    }
+
+    if (query.terms.empty())
+    {
+        for (int track = 0; track < (int) records.size(); ++track)
+            if (matches(track, query))
+                result.push_back(track);
+        return result;
+    }
+
+    // Generate candidates from the most selective term, then verify every term on each one
+    const auto* rarest = &query.terms.front();
+    size_t rarestCount = estimateCandidates(*rarest);
+    for (auto& term : query.terms)
+    {
+        auto count = estimateCandidates(term);
+        if (count < rarestCount)
+        {
+            rarest = &term;
+            rarestCount = count;
+        }
+    }
+
+    for (int track : candidatesFor(*rarest))
+        if (matches(track, query))
+            result.push_back(track);
+    return result;
+}
+
+uint32 LibrarySearchIndex::trigramAt(const char* p)
+{
+    return ((uint32) (unsigned char) p[0] << 16) | ((uint32) (unsigned char) p[1] << 8) | (uint32) (unsigned char) p[2];
+}
+
+bool LibrarySearchIndex::matches(int track, const LibraryQuery& query) const
+{
+    const auto& record = records[(size_t) track];
+
+    if (query.maxBpm > 0.0f
+        && ((record.flags & TrackRecord::hasTempo) == 0 || record.bpm < query.minBpm || record.bpm > query.maxBpm))
+        return false;
+
+    if (query.key >= 0 && ((record.flags & TrackRecord::hasKey) == 0 || record.key != query.key))
+        return false;
+
+    for (auto& term : query.terms)
+        if (! matchesTerm(track, term))
+            return false;
+    return true;
+}
+
+bool LibrarySearchIndex::matchesTerm(int track, const std::string& term) const
+{
+    auto begin = textOffsets[(size_t) track];
+    std::string_view trackText(text.data() + begin, textOffsets[(size_t) track + 1] - 1 - begin);
+
+    if (term.size() >= trigramLength)
+        return trackText.find(term) != std::string_view::npos;
+
+    for (auto pos = trackText.find(term); pos != std::string_view::npos; pos = trackText.find(term, pos + 1))
+        if (pos == 0 || ! isWordChar(trackText[pos - 1]))
+            return true;
+    return false;
+}
+
+// Long terms: the shortest posting list among the term's trigrams. Short terms: every word with the prefix.
+std::vector<int> LibrarySearchIndex::candidatesFor(const std::string& term) const
+{
+    if (term.size() >= trigramLength)
+    {
+        const std::vector<int>* shortest = nullptr;
+        for (size_t i = 0; i + trigramLength <= term.size(); ++i)
+        {
+            auto it = trigrams.find(trigramAt(term.data() + i));
+            if (it == trigrams.end())
+                return {};
+            if (shortest == nullptr || it->second.size() < shortest->size())
+                shortest = &it->second;
+        }
+        return *shortest;
+    }
+
+    auto range = wordRange(term);
+    std::vector<int> tracks;
+    tracks.reserve(range.second - range.first);
+    for (auto i = range.first; i < range.second; ++i)
+        tracks.push_back(words[i].track);
+
+    std::sort(tracks.begin(), tracks.end());
+    tracks.erase(std::unique(tracks.begin(), tracks.end()), tracks.end());
+    return tracks;
+}
+
+size_t LibrarySearchIndex::estimateCandidates(const std::string& term) const
+{
+    if (term.size() < trigramLength)
+    {
+        auto range = wordRange(term);
+        return range.second - range.first;
+    }
+
+    size_t smallest = records.size();
+    for (size_t i = 0; i + trigramLength <= term.size(); ++i)
+    {
+        auto it = trigrams.find(trigramAt(term.data() + i));
+        smallest = jmin(smallest, it == trigrams.end() ? (size_t) 0 : it->second.size());
+    }
+    return smallest;
+}
+
+std::pair<size_t, size_t> LibrarySearchIndex::wordRange(const std::string& prefix) const
+{
+    auto wordAt = [this](const WordEntry& w) { return std::string_view(text.data() + w.offset, w.length); };
+    std::string_view key(prefix);
+
+    auto first = std::lower_bound(words.begin(), words.end(), key, [&](const WordEntry& w, std::string_view k)
+    {
+        return wordAt(w) < k;
+    });
+    auto last = std::upper_bound(first, words.end(), key, [&](std::string_view k, const WordEntry& w)
+    {
+        return wordAt(w).substr(0, k.size()) > k; // Past the run of words starting with the prefix
+    });
+    return { (size_t) (first - words.begin()), (size_t) (last - words.begin()) };
+}
@@ -0,0 +1,71 @@
+/*
+  ==============================================================================
+
+    LibrarySearchIndex.h
+    Created: 19 Oct 2026 4:27:52pm
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "TrackLibrary.h"
+
+// A parsed search box entry: free-text terms plus optional "bpm:120-128" and "key:8A" filters
+struct LibraryQuery {
+    std::vector<std::string> terms; // Lower-case UTF-8 words; every one must match
+    float minBpm = 0.0f, maxBpm = 0.0f; // Tempo range, both 0 if unfiltered
+    int key = -1; // Key to match (see TrackRecord::key), -1 if unfiltered
+
+    static LibraryQuery parse(const juce::String& text);
+    bool isEmpty() const { return terms.empty() && maxBpm <= 0.0f && key < 0; }
+    bool narrows(const LibraryQuery& previous) const; // True if every match of this query also matches previous
+};
+
+// LibrarySearchIndex class: Immutable search index over a copy of the library. Terms of three or more
+// characters are found through trigram posting lists and match anywhere in the artist or title; shorter
+// terms use a sorted word list and match the start of a word. Building is thread-safe and done off the
+// message thread for large libraries; searching is fast enough to run on every keystroke.
+class LibrarySearchIndex {
+public:
+    using Ptr = std::shared_ptr<const LibrarySearchIndex>;
+
+    // Builds from copies of the library's records and string blob (any thread)
+    LibrarySearchIndex(std::vector<TrackRecord> records, const std::vector<char>& strings);
+
+    int getNumTracks() const { return (int) records.size(); } // Tracks covered by this index
+
+    // Ascending library indices matching the query. If within is given (the ascending result of a query
+    // this one narrows), only those tracks are checked.
+    std::vector<int> search(const LibraryQuery& query, const std::vector<int>* within = nullptr) const;
+
+private:
+    static constexpr size_t trigramLength = 3;
+
+    struct WordEntry {
+        juce::uint32 offset, length; // Word within text
+        int track;
+    };
+
+    static juce::uint32 trigramAt(const char* p); // Packs three bytes into a key
+
+    bool matches(int track, const LibraryQuery& query) const; // Full check of one track
+    bool matchesTerm(int track, const std::string& term) const; // Substring or word-prefix check of one term
+    std::vector<int> candidatesFor(const std::string& term) const; // Ascending tracks that may match the term
+    size_t estimateCandidates(const std::string& term) const; // Cheap upper bound on candidatesFor().size()
+    std::pair<size_t, size_t> wordRange(const std::string& prefix) const; // words[first, second) starting with prefix
+
+    std::vector<TrackRecord> records; // Numeric fields used by the filters
+    std::string text; // Lower-case "artist title" of every track, each followed by a '\0'
+    std::vector<juce::uint32> textOffsets; // Start of each track's text, plus the end
+    std::unordered_map<juce::uint32, std::vector<int>> trigrams; // Trigram -> ascending tracks containing it
+    std::vector<WordEntry> words; // Every word of every track, sorted by spelling
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LibrarySearchIndex)
+};
@@ -0,0 +1,379 @@
+/*
+  ==============================================================================
+
+    LibraryWatcher.cpp
+    Created: 19 Oct 2026 5:34:12pm
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#include "LibraryWatcher.h"
+#include "WaveformCache.h"
+#include <algorithm>
+
+#if JUCE_LINUX
+ #include <sys/inotify.h>
+ #include <poll.h>
+ #include <unistd.h>
+ #include <cerrno>
+#endif
+
+using namespace juce;
+
+#if JUCE_LINUX
+namespace
+{
+    // Directory events that can add, change, remove or move a track
+    constexpr uint32_t watchMask = IN_CREATE | IN_CLOSE_WRITE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO
+                                   | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+}
+#endif
+
+LibraryWatcher::LibraryWatcher(TrackLibrary& _library, LibraryScanner& _scanner, AudioFormatManager& _formatManager)
+    : Thread("Library watcher"), library(_library), scanner(_scanner), formatManager(_formatManager)
+{
+    library.addChangeListener(this);
+    startThread(Thread::Priority::low);
+    startTimer(250);
+}
+
+LibraryWatcher::~LibraryWatcher()
+{
+    library.removeChangeListener(this);
+    stopTimer();
+    stopThread(2000);
+}
+
+void LibraryWatcher::watchFolder(const File& folder)
+{
+    library.addWatchedFolder(folder); // Picked up by syncFolders on the change message
+}
+
+void LibraryWatcher::unwatchFolder(const File& folder)
+{
+    library.removeWatchedFolder(folder);
+}
+
+void LibraryWatcher::changeListenerCallback(ChangeBroadcaster*)
+{
+    syncFolders();
+}
+
+// Follows the library's folder list, which also covers the list arriving with library.load().
+// Folders that start being watched are rescanned to catch changes made while nobody was watching.
+void LibraryWatcher::syncFolders()
+{
+    const auto& wanted = library.getWatchedFolders();
+    StringArray added;
+    {
+        const ScopedLock sl(lock);
+        for (auto& folder : wanted)
+        {
+            if (! folders.contains(folder))
+            {
+                folders.add(folder);
+                foldersToAdd.add(folder);
+                added.add(folder);
+            }
+        }
+        for (int i = folders.size(); --i >= 0;)
+        {
+            if (! wanted.contains(folders[i]))
+            {
+                foldersToAdd.removeString(folders[i]);
+                foldersToRemove.add(folders[i]);
+                folders.remove(i);
+            }
+        }
+    }
+
+    for (auto& folder : added)
+        scanner.scanFolder(File(folder));
+}
+
+void LibraryWatcher::run()
+{
+   #if JUCE_LINUX
+    if (runInotify())
+        return;
+   #endif
+    runPolling();
+}
+
+// Without change notifications the scanner does the work: it skips unchanged files by size and
+// time and flags tracks that have vanished
+void LibraryWatcher::runPolling()
+{
+    while (! threadShouldExit())
+    {
+        wait(pollIntervalMs);
+
+        const ScopedLock sl(lock);
+        foldersToAdd.clear();
+        foldersToRemove.clear();
+        rescanAll = true;
+    }
+}
+
+#if JUCE_LINUX
+bool LibraryWatcher::runInotify()
+{
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0)
+        return false;
+
+    alignas(inotify_event) char buffer[64 * 1024];
+    double lastRescanMs = Time::getMillisecondCounterHiRes();
+
+    while (! threadShouldExit())
+    {
+        StringArray toAdd, toRemove;
+        {
+            const ScopedLock sl(lock);
+            toAdd.swapWith(foldersToAdd);
+            toRemove.swapWith(foldersToRemove);
+        }
+
+        for (auto& folder : toAdd)
+            addWatchRecursive(fd, folder);
+
+        for (auto& folder : toRemove)
+        {
+            for (auto it = watchPaths.begin(); it != watchPaths.end();)
+            {
+                if (it->second == folder || it->second.startsWith(folder + File::getSeparatorString()))
+                {
+                    inotify_rm_watch(fd, it->first);
+                    it = watchPaths.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+
+        // Directories beyond the system's watch limit are only caught by periodic rescans
+        if (watchLimitHit && Time::getMillisecondCounterHiRes() - lastRescanMs > pollIntervalMs)
+        {
+            lastRescanMs = Time::getMillisecondCounterHiRes();
+            const ScopedLock sl(lock);
+            rescanAll = true;
+        }
+
+        pollfd request { fd, POLLIN, 0 };
+        if (poll(&request, 1, 200) <= 0)
+            continue;
+
+        auto length = read(fd, buffer, sizeof(buffer));
+        if (length <= 0)
+            continue;
+
+        for (auto* p = buffer; p < buffer + length;)
+        {
+            const auto* event = reinterpret_cast<const inotify_event*>(p);
+            p += sizeof(inotify_event) + event->len;
+
+            if ((event->mask & IN_Q_OVERFLOW) != 0)
+            {
+                const ScopedLock sl(lock);
+                rescanAll = true; // Events were dropped; only a rescan can tell what changed
+                continue;
+            }
+
+            auto watch = watchPaths.find(event->wd);
+            if (watch == watchPaths.end())
+                continue;
+
+            if ((event->mask & IN_IGNORED) != 0)
+            {
+                watchPaths.erase(watch);
+                continue;
+            }
+
+            auto path = event->len > 0 ? watch->second + File::getSeparatorString() + String::fromUTF8(event->name)
+                                       : watch->second;
+
+            // A directory created or moved in brings its own subdirectories that need watches
+            if ((event->mask & IN_ISDIR) != 0 && (event->mask & (IN_CREATE | IN_MOVED_TO)) != 0)
+                addWatchRecursive(fd, path);
+
+            pathChanged(path);
+        }
+    }
+
+    close(fd);
+    return true;
+}
+
+void LibraryWatcher::addWatchRecursive(int fd, const String& folder)
+{
+    auto addWatch = [this, fd](const String& directory)
+    {
+        int wd = inotify_add_watch(fd, directory.toRawUTF8(), watchMask);
+        if (wd >= 0)
+            watchPaths[wd] = directory;
+        else if (errno == ENOSPC && ! watchLimitHit)
+        {
+            watchLimitHit = true;
+            DBG("LibraryWatcher: inotify watch limit reached, falling back to periodic rescans");
+        }
+    };
+
+    addWatch(folder);
+    for (const auto& entry : RangedDirectoryIterator(File(folder), true, "*", File::findDirectories))
+    {
+        if (threadShouldExit())
+            return;
+        addWatch(entry.getFile().getFullPathName());
+    }
+}
+#endif
+
+void LibraryWatcher::pathChanged(const String& path)
+{
+    const ScopedLock sl(lock);
+    auto now = Time::getMillisecondCounterHiRes();
+    if (changedPaths.empty())
+        firstChangeMs = now;
+    lastChangeMs = now;
+    changedPaths.insert(path);
+}
+
+// Waits for a burst of events to settle (or for maxDelayMs) before touching the library
+void LibraryWatcher::timerCallback()
+{
+    std::set<String> paths;
+    StringArray rescanFolders;
+    {
+        const ScopedLock sl(lock);
+        auto now = Time::getMillisecondCounterHiRes();
+        if (! changedPaths.empty() && (now - lastChangeMs >= debounceMs || now - firstChangeMs >= maxDelayMs))
+            paths.swap(changedPaths);
+
+        if (rescanAll)
+        {
+            rescanAll = false;
+            rescanFolders = folders;
+        }
+    }
+
+    for (auto& folder : rescanFolders)
+        scanner.scanFolder(File(folder));
+
+    if (! paths.empty())
+        processChanges(paths);
+}
+
+// Sorts the changed paths into folders to walk, files to re-read and tracks that disappeared, then
+// pairs disappeared tracks with new files of the same size and time as moves: either a new file
+// anywhere in the batch, or the same relative path inside a folder that appeared in the batch
+void LibraryWatcher::processChanges(const std::set<String>& paths)
+{
+    struct Removed {
+        int index;
+        File root; // The vanished path the track was found under
+    };
+
+    Array<File> toRead, newFolders;
+    std::vector<Removed> removed;
+
+    for (auto& path : paths)
+    {
+        File file(path);
+        if (file.isDirectory())
+        {
+            newFolders.add(file);
+        }
+        else if (file.existsAsFile())
+        {
+            if (! isAudioFile(file))
+                continue;
+
+            int index = library.indexOf(file);
+            if (index >= 0)
+            {
+                const auto& record = library.getRecord(index);
+                if (record.fileSize == file.getSize() && record.modificationTime == file.getLastModificationTime().toMilliseconds())
+                    continue; // Touched but not rewritten
+
+                // The audio changed: everything derived from it is stale
+                WaveformCache::invalidate(file);
+                library.invalidateAnalysis(index);
+            }
+            toRead.add(file);
+        }
+        else
+        {
+            int index = library.indexOf(file);
+            if (index >= 0)
+                removed.push_back({ index, file });
+            else
+                for (int track : library.findTracksUnder(file)) // A whole directory went away
+                    removed.push_back({ track, file });
+        }
+    }
+
+    std::sort(removed.begin(), removed.end(), [](const Removed& a, const Removed& b) { return a.index < b.index; });
+    removed.erase(std::unique(removed.begin(), removed.end(), [](const Removed& a, const Removed& b) { return a.index == b.index; }),
+                  removed.end());
+
+    std::vector<std::pair<int, bool>> nowMissing;
+    for (auto& entry : removed)
+    {
+        auto oldFile = library.getFile(entry.index);
+        const auto& record = library.getRecord(entry.index);
+
+        auto isSameAudio = [&](const File& candidate)
+        {
+            return candidate.existsAsFile()
+                   && library.indexOf(candidate) < 0
+                   && candidate.getSize() == record.fileSize
+                   && candidate.getLastModificationTime().toMilliseconds() == record.modificationTime;
+        };
+
+        File newFile;
+        for (int i = 0; i < toRead.size() && newFile == File(); ++i)
+            if (isSameAudio(toRead.getReference(i)))
+                newFile = toRead.removeAndReturn(i);
+
+        if (newFile == File() && entry.root != oldFile)
+        {
+            auto relativePath = oldFile.getRelativePathFrom(entry.root);
+            for (auto& folder : newFolders)
+            {
+                auto candidate = folder.getChildFile(relativePath);
+                if (isSameAudio(candidate))
+                {
+                    newFile = candidate;
+                    break;
+                }
+            }
+        }
+
+        if (newFile != File())
+        {
+            WaveformCache::move(oldFile, newFile);
+            library.moveTrack(entry.index, newFile);
+        }
+        else
+        {
+            WaveformCache::invalidate(oldFile);
+            nowMissing.emplace_back(entry.index, true);
+        }
+    }
+    library.setMissing(nowMissing); // One change however many files went
+
+    // Walked after the moves are applied, so moved tracks are already known and skipped
+    for (auto& folder : newFolders)
+        scanner.scanFolder(folder);
+
+    if (! toRead.isEmpty())
+        scanner.scanFiles(toRead);
+}
+
+bool LibraryWatcher::isAudioFile(const File& file) const
+{
+    return formatManager.findFormatForFileExtension(file.getFileExtension()) != nullptr;
+}
@@ -0,0 +1,69 @@
+/*
+  ==============================================================================
+
+    LibraryWatcher.h
+    Created: 19 Oct 2026 5:34:12pm
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <map>
+#include <set>
+#include "TrackLibrary.h"
+#include "LibraryScanner.h"
+
+// LibraryWatcher class: Keeps the library in step with its watched folders. On Linux a thread
+// reads inotify events for every directory under the folders; elsewhere (or if inotify runs out
+// of watches) the folders are rescanned periodically. Changed paths are collected and debounced,
+// then handled on the message thread: new and edited files are re-read through the scanner,
+// removed ones are flagged missing, moves keep their analysis, and cached waveforms of changed
+// files are dropped.
+class LibraryWatcher : private juce::Thread,
+                       private juce::Timer,
+                       private juce::ChangeListener {
+public:
+    LibraryWatcher(TrackLibrary& library, LibraryScanner& scanner, juce::AudioFormatManager& formatManager);
+    ~LibraryWatcher() override;
+
+    void watchFolder(const juce::File& folder); // Adds the folder to the library's watched list, which starts watching it
+    void unwatchFolder(const juce::File& folder); // Removes the folder from the library's watched list
+
+private:
+    void run() override; // Event loop (inotify) or rescan loop (polling)
+    void timerCallback() override; // Hand settled changes to processChanges
+    void changeListenerCallback(juce::ChangeBroadcaster* source) override; // Library changed
+    void syncFolders(); // Start or stop watching to match the library's folder list
+    void pathChanged(const juce::String& path); // Any thread: record a change for the next flush
+    void processChanges(const std::set<juce::String>& paths); // Message thread: update the library
+    bool isAudioFile(const juce::File& file) const; // True if the format manager can open this extension
+
+   #if JUCE_LINUX
+    bool runInotify(); // Returns false if inotify is unavailable
+    void addWatchRecursive(int fd, const juce::String& folder); // Watch a directory and all its subdirectories
+    std::map<int, juce::String> watchPaths; // Watch descriptor -> directory path; event thread only
+    bool watchLimitHit = false; // Some directories couldn't be watched and rely on periodic rescans; event thread only
+   #endif
+    void runPolling(); // Fallback loop
+
+    static constexpr int debounceMs = 750; // Quiet time before a burst of changes is handled
+    static constexpr int maxDelayMs = 5000; // Longest a change waits while events keep arriving
+    static constexpr int pollIntervalMs = 5 * 60 * 1000; // Rescan period of the polling fallback
+
+    TrackLibrary& library;
+    LibraryScanner& scanner;
+    juce::AudioFormatManager& formatManager;
+
+    juce::CriticalSection lock; // Guards everything below
+    juce::StringArray folders; // Folders being watched
+    juce::StringArray foldersToAdd; // Folders the event thread hasn't started watching yet
+    juce::StringArray foldersToRemove; // Folders the event thread should stop watching
+    std::set<juce::String> changedPaths; // Paths changed since the last flush
+    double firstChangeMs = 0.0, lastChangeMs = 0.0; // Times of the oldest and newest pending change
+    bool rescanAll = false; // Set when events were lost and every folder needs a rescan
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LibraryWatcher)
+};
@@ -0,0 +1,325 @@
+/*
+  ==============================================================================
+
+    LoudnessMeter.cpp
+    Created: 19 Oct 2026 9:14:03pm
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#include "LoudnessMeter.h"
+#include "Trace.h"
+#include <algorithm>
+#include <limits>
+#include <vector>
+using namespace juce;
+
+namespace
+{
+    constexpr int subBlocksPerChunk = 300; // Sub-blocks measured by each pool job (30 s)
+    constexpr int subBlocksPerBlock = 4; // 400 ms gating blocks with a 100 ms hop
+    constexpr double preRollSeconds = 0.5; // Audio read before each chunk to settle the filters
+    constexpr int historyLength = LoudnessMeter::tapsPerPhase - 1; // Past samples the interpolator needs
+
+    struct Biquad
+    {
+        double b0 = 1.0, b1 = 0.0, b2 = 0.0, a1 = 0.0, a2 = 0.0;
+    };
+
+    // BS.1770 pre-filter (high shelf) and RLB high-pass, derived for any sample rate rather than
+    // only the 48 kHz coefficients printed in the standard
+    void makeKWeighting(double sampleRate, Biquad& shelf, Biquad& highPass)
+    {
+        {
+            const double f0 = 1681.974450955533, gainDb = 3.999843853973347, q = 0.7071752369554196;
+            const double k = std::tan(MathConstants<double>::pi * f0 / sampleRate);
+            const double vh = std::pow(10.0, gainDb / 20.0);
+            const double vb = std::pow(vh, 0.4996667741545416);
+            const double a0 = 1.0 + k / q + k * k;
+            shelf.b0 = (vh + vb * k / q + k * k) / a0;
+            shelf.b1 = 2.0 * (k * k - vh) / a0;
+            shelf.b2 = (vh - vb * k / q + k * k) / a0;
+            shelf.a1 = 2.0 * (k * k - 1.0) / a0;
+            shelf.a2 = (1.0 - k / q + k * k) / a0;
+        }
+        {
+            const double f0 = 38.13547087602444, q = 0.5003270373238773;
+            const double k = std::tan(MathConstants<double>::pi * f0 / sampleRate);
+            const double a0 = 1.0 + k / q + k * k;
+            highPass.b0 = 1.0;
+            highPass.b1 = -2.0;
+            highPass.b2 = 1.0;
+            highPass.a1 = 2.0 * (k * k - 1.0) / a0;
+            highPass.a2 = (1.0 - k / q + k * k) / a0;
+        }
+    }
+
+    // Windowed-sinc interpolator for the true-peak oversampler, one row of taps per output phase
+    struct PeakFilter
+    {
+        float taps[LoudnessMeter::oversampling][LoudnessMeter::tapsPerPhase];
+
+        PeakFilter()
+        {
+            constexpr int length = LoudnessMeter::oversampling * LoudnessMeter::tapsPerPhase;
+            for (int phase = 0; phase < LoudnessMeter::oversampling; ++phase)
+            {
+                float sum = 0.0f;
+                for (int tap = 0; tap < LoudnessMeter::tapsPerPhase; ++tap)
+                {
+                    int n = phase + tap * LoudnessMeter::oversampling;
+                    double t = (n - (length - 1) * 0.5) / LoudnessMeter::oversampling;
+                    double sinc = t == 0.0 ? 1.0 : std::sin(MathConstants<double>::pi * t) / (MathConstants<double>::pi * t);
+                    double window = 0.5 - 0.5 * std::cos(MathConstants<double>::twoPi * (n + 0.5) / length);
+                    taps[phase][tap] = (float) (sinc * window);
+                    sum += taps[phase][tap];
+                }
+                for (auto& tap : taps[phase])
+                    tap /= sum; // Unity gain at DC for every phase
+            }
+        }
+    };
+
+    const PeakFilter& getPeakFilter()
+    {
+        static const PeakFilter filter;
+        return filter;
+    }
+
+    // Shared between the chunk jobs of one measurement; the caller waits until the last one has finished
+    struct MeterState
+    {
+        AudioFormatManager& formatManager;
+        File file;
+        const std::atomic<bool>& abort;
+        double sampleRate = 0.0;
+        int64 lengthInSamples = 0;
+        int numChannels = 0;
+        int subBlockSamples = 0;
+        Biquad shelf, highPass;
+        std::vector<double> energies; // K-weighted energy of each sub-block, summed over channels
+        std::vector<float> chunkPeaks; // True peak of each chunk
+        std::atomic<int> chunksRemaining { 0 };
+        std::atomic<bool> failed { false };
+        WaitableEvent finished;
+
+        MeterState(AudioFormatManager& fm, const File& f, const std::atomic<bool>& a) : formatManager(fm), file(f), abort(a) {}
+    };
+
+    // Both filter stages run in one pass, so each sample is loaded once and the states stay in registers
+    double kWeightedEnergy(const MeterState& state, const float* input, int numSamples, double* filterState)
+    {
+        const auto& s = state.shelf;
+        const auto& h = state.highPass;
+        double s1 = filterState[0], s2 = filterState[1], h1 = filterState[2], h2 = filterState[3];
+        double energy = 0.0;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            double x = input[i];
+            double y = s.b0 * x + s1;
+            s1 = s.b1 * x - s.a1 * y + s2;
+            s2 = s.b2 * x - s.a2 * y;
+
+            double z = h.b0 * y + h1;
+            h1 = h.b1 * y - h.a1 * z + h2;
+            h2 = h.b2 * y - h.a2 * z;
+
+            energy += z * z;
+        }
+
+        filterState[0] = s1;
+        filterState[1] = s2;
+        filterState[2] = h1;
+        filterState[3] = h2;
+        return energy;
+    }
+
+    // Oversampled peak of a block. Inter-sample peaks sit only a few dB above the sample peak, so
+    // blocks more than 6 dB below the peak found so far skip the interpolation.
+    float truePeak(const float* input, int numSamples, float* history, std::vector<float>& padded, float peakSoFar)
+    {
+        std::copy(history, history + historyLength, padded.begin());
+        std::copy(input, input + numSamples, padded.begin() + historyLength);
+        std::copy(padded.begin() + numSamples, padded.begin() + numSamples + historyLength, history);
+
+        auto range = FloatVectorOperations::findMinAndMax(input, numSamples);
+        float samplePeak = jmax(std::abs(range.getStart()), std::abs(range.getEnd()));
+        if (samplePeak < peakSoFar * 0.5f)
+            return samplePeak;
+
+        const auto& filter = getPeakFilter();
+        float peak = samplePeak;
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float* x = padded.data() + i + historyLength;
+            for (int phase = 0; phase < LoudnessMeter::oversampling; ++phase)
+            {
+                float sum = 0.0f;
+                for (int tap = 0; tap < LoudnessMeter::tapsPerPhase; ++tap)
+                    sum += filter.taps[phase][tap] * x[-tap];
+                peak = jmax(peak, std::abs(sum));
+            }
+        }
+        return peak;
+    }
+
+    // Measures one chunk with its own reader, reading exactly one sub-block per call once past the pre-roll
+    void measureChunk(MeterState& state, int chunkIndex)
+    {
+        OTO_TRACE_SCOPE("Loudness chunk");
+
+        std::unique_ptr<AudioFormatReader> reader(state.formatManager.createReaderFor(state.file));
+        if (reader == nullptr)
+        {
+            state.failed = true;
+            return;
+        }
+
+        const int sub = state.subBlockSamples;
+        const int firstSub = chunkIndex * subBlocksPerChunk;
+        const int lastSub = jmin(firstSub + subBlocksPerChunk, (int) state.energies.size());
+        const int64 chunkStart = (int64) firstSub * sub;
+        const int64 chunkEnd = (int64) lastSub * sub;
+
+        AudioBuffer<float> buffer(state.numChannels, sub);
+        std::vector<float> padded((size_t) (historyLength + sub));
+        double filterStates[2][4] {};
+        float history[2][historyLength] {};
+        float peak = 0.0f;
+
+        int64 pos = jmax((int64) 0, chunkStart - (int64) (preRollSeconds * state.sampleRate));
+        while (pos < chunkEnd)
+        {
+            if (state.abort.load())
+                return;
+
+            // Stop the pre-roll exactly at the chunk start so later reads stay sub-block aligned
+            int64 blockEnd = pos < chunkStart ? jmin(chunkStart, pos + sub) : jmin(chunkEnd, pos + sub);
+            int num = (int) (blockEnd - pos);
+            bool measuring = pos >= chunkStart;
+
+            reader->read(&buffer, 0, num, pos, true, true);
+
+            double energy = 0.0;
+            for (int channel = 0; channel < state.numChannels; ++channel)
+            {
+                const float* samples = buffer.getReadPointer(channel);
+                energy += kWeightedEnergy(state, samples, num, filterStates[channel]);
+                float blockPeak = truePeak(samples, num, history[channel], padded, measuring ? peak : std::numeric_limits<float>::max());
+                if (measuring)
+                    peak = jmax(peak, blockPeak);
+            }
+
+            if (measuring)
+                state.energies[(size_t) (pos / sub)] = energy;
+            pos = blockEnd;
+        }
+
+        state.chunkPeaks[(size_t) chunkIndex] = peak;
+    }
+
+    // Two-stage gating over the 400 ms blocks: absolute first, then relative to the mean of what's left
+    LoudnessMeter::Result finishMeasurement(const MeterState& state)
+    {
+        LoudnessMeter::Result result;
+        if (state.failed || state.abort.load() || (int) state.energies.size() < subBlocksPerBlock)
+            return result;
+
+        const double blockSamples = (double) subBlocksPerBlock * state.subBlockSamples;
+        std::vector<double> blocks(state.energies.size() - subBlocksPerBlock + 1);
+        double running = 0.0;
+        for (size_t i = 0; i < state.energies.size(); ++i)
+        {
+            running += state.energies[i];
+            if (i >= (size_t) subBlocksPerBlock)
+                running -= state.energies[i - subBlocksPerBlock];
+            if (i + 1 >= (size_t) subBlocksPerBlock)
+                blocks[i + 1 - subBlocksPerBlock] = jmax(0.0, running) / blockSamples;
+        }
+
+        auto toEnergy = [](double lufs) { return std::pow(10.0, (lufs + 0.691) / 10.0); };
+        auto meanAbove = [&blocks](double threshold)
+        {
+            double sum = 0.0;
+            int count = 0;
+            for (double block : blocks)
+            {
+                if (block > threshold)
+                {
+                    sum += block;
+                    ++count;
+                }
+            }
+            return count > 0 ? sum / count : 0.0;
+        };
+
+        const double absoluteThreshold = toEnergy(LoudnessMeter::absoluteGateLufs);
+        double ungated = meanAbove(absoluteThreshold);
+        if (ungated <= 0.0)
+            return result; // Silence
+
+        double relativeThreshold = ungated * std::pow(10.0, LoudnessMeter::relativeGateLu / 10.0);
+        double gated = meanAbove(jmax(absoluteThreshold, relativeThreshold));
+
+        float peak = 0.0f;
+        for (float chunkPeak : state.chunkPeaks)
+            peak = jmax(peak, chunkPeak);
+
+        result.valid = true;
+        result.integratedLufs = (float) (-0.691 + 10.0 * std::log10(gated));
+        result.truePeakDb = Decibels::gainToDecibels(peak, -100.0f);
+        return result;
+    }
+}
+
+// Mirrors SpectralWaveform::analyse: independent chunks, each with its own reader and filter pre-roll
+LoudnessMeter::Result LoudnessMeter::measure(AudioFormatManager& formatManager,
+                                             const File& file,
+                                             ThreadPool* pool,
+                                             const std::atomic<bool>& abort)
+{
+    MeterState state(formatManager, file, abort);
+    {
+        std::unique_ptr<AudioFormatReader> reader(formatManager.createReaderFor(file));
+        if (reader == nullptr || reader->sampleRate <= 0.0 || reader->lengthInSamples <= 0)
+            return {};
+
+        state.sampleRate = reader->sampleRate;
+        state.lengthInSamples = reader->lengthInSamples;
+        state.numChannels = jlimit(1, 2, (int) reader->numChannels); // Only the front pair is weighted
+    }
+
+    state.subBlockSamples = jmax(1, roundToInt(state.sampleRate * 0.1));
+    makeKWeighting(state.sampleRate, state.shelf, state.highPass);
+    state.energies.resize((size_t) (state.lengthInSamples / state.subBlockSamples)); // A partial last sub-block is left out
+
+    const int numChunks = ((int) state.energies.size() + subBlocksPerChunk - 1) / subBlocksPerChunk;
+    state.chunkPeaks.resize((size_t) numChunks);
+    if (numChunks == 0)
+        return {};
+
+    if (pool != nullptr)
+    {
+        // Every job is waited for, even after an abort, since they all point at state
+        state.chunksRemaining = numChunks;
+        for (int chunk = 0; chunk < numChunks; ++chunk)
+        {
+            pool->addJob([&state, chunk]()
+            {
+                measureChunk(state, chunk);
+                if (--state.chunksRemaining == 0)
+                    state.finished.signal();
+            });
+        }
+        state.finished.wait();
+    }
+    else
+    {
+        for (int chunk = 0; chunk < numChunks && ! abort.load(); ++chunk)
+            measureChunk(state, chunk);
+    }
+
+    return finishMeasurement(state);
+}
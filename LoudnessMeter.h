@@ -0,0 +1,40 @@
+/*
+  ==============================================================================
+
+    LoudnessMeter.h
+    Created: 19 Oct 2026 9:14:03pm
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+
+// LoudnessMeter class: Offline EBU R128 / ITU-R BS.1770 measurement of a whole track. The file is
+// split into chunks of whole 100 ms sub-blocks; each chunk K-weights its audio, sums the energy of
+// every sub-block and finds its 4x oversampled true peak. The gated integrated loudness is then
+// computed over the 400 ms blocks, overlapping by 75%, that the sub-blocks make up.
+class LoudnessMeter {
+public:
+    static constexpr double absoluteGateLufs = -70.0; // Blocks quieter than this never count
+    static constexpr double relativeGateLu = -10.0; // Blocks this far below the ungated mean are dropped
+    static constexpr int oversampling = 4; // True-peak interpolation factor
+    static constexpr int tapsPerPhase = 12; // Interpolation filter length per output phase
+
+    struct Result {
+        bool valid = false; // False if the file couldn't be read, is silent or was aborted
+        float integratedLufs = 0.0f; // Gated integrated loudness
+        float truePeakDb = 0.0f; // Oversampled peak in dBTP
+    };
+
+    // Measures a local audio file and blocks until done. With a pool the chunks are spread across its
+    // threads while the caller waits; without one they run on the calling thread. Must not be called
+    // from a thread of the pool passed in.
+    static Result measure(juce::AudioFormatManager& formatManager,
+                          const juce::File& file,
+                          juce::ThreadPool* pool,
+                          const std::atomic<bool>& abort);
+};
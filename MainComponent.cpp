@@ -1,94 +1,328 @@
-/*
-  ==============================================================================
-
-    This file was auto-generated!
-
-  ==============================================================================
-*/
-
-#include "MainComponent.h"
-using namespace juce;
-
-//==============================================================================
-MainComponent::MainComponent():player(formatManager), playlistComponent(&player, &deckGUI1, &deckGUI2)
-
-{
-    // Make sure you set the size of the component after
-    // you add any child components.
-    setSize (800, 1200);
-    
-    customLookAndFeel = std::make_unique<CustomLookAndFeel>();
-    setLookAndFeel(customLookAndFeel.get());
-
-    // Some platforms require permissions to open input channels so request that here
-    if (RuntimePermissions::isRequired (RuntimePermissions::recordAudio)
-        && ! RuntimePermissions::isGranted (RuntimePermissions::recordAudio))
-    {
-        RuntimePermissions::request (RuntimePermissions::recordAudio,
-                                     [&] (bool granted) { if (granted)  setAudioChannels (2, 2); });
-    }  
-    else
-    {
-        // Specify the number of input and output channels that we want to open
-        setAudioChannels (0, 2);
-    }
-    
-    formatManager.registerBasicFormats();
-    
-    addAndMakeVisible(deckGUI1);
-    addAndMakeVisible(deckGUI2);
-
-    addAndMakeVisible(playlistComponent);
-}
-
-MainComponent::~MainComponent()
-{
-    setLookAndFeel(nullptr); // Reset the look and feel to the default
-    // This shuts down the audio device and clears the audio source.
-    shutdownAudio();
-}
-
-//==============================================================================
-void MainComponent::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
-{
-    player1.prepareToPlay(samplesPerBlockExpected, sampleRate);
-    player2.prepareToPlay(samplesPerBlockExpected, sampleRate);
-    
-    mixerSource.prepareToPlay(samplesPerBlockExpected, sampleRate);
-
-    mixerSource.addInputSource(&player1, false);
-    mixerSource.addInputSource(&player2, false);
-
- }
-void MainComponent::getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill)
-{
-    mixerSource.getNextAudioBlock(bufferToFill);
-}
-
-void MainComponent::releaseResources()
-{
-    // This will be called when the audio device stops, or when it is being
-    // restarted due to a setting change.
-
-    // For more details, see the help for AudioProcessor::releaseResources()
-    player1.releaseResources();
-    player2.releaseResources();
-    mixerSource.releaseResources();
-}
-
-//==============================================================================
-void MainComponent::paint (Graphics& g)
-{
-    // (Our component is opaque, so we must completely fill the background with a solid colour)
-    g.fillAll (getLookAndFeel().findColour (ResizableWindow::backgroundColourId));
-
-}
-
-void MainComponent::resized()
-{
-    deckGUI1.setBounds(0, 1, getWidth()/2, getHeight() / 2);
-    deckGUI2.setBounds(getWidth()/2, 1, getWidth()/2, getHeight() / 2);
-    playlistComponent.setBounds(0, getHeight()/2 + 1, getWidth(), getHeight()/2);
-}
-
-
+/*
+  ==============================================================================
+
+    This file was auto-generated!
+
+  ==============================================================================
+*/
+
+#include "MainComponent.h"
+#include "StartupTimer.h"
+#include "AudioSettingsComponent.h"
+using namespace juce;
+
+//==============================================================================
+MainComponent::MainComponent():player(formatManager), playlistComponent(&player, &deckGUI1, &deckGUI2, library, formatManager, analysisQueue)
+
+{
+    StartupTimer::mark("Components constructed");
+
+    // Registered before anything can open a file: the library load below runs straight away
+    formatManager.registerBasicFormats();
+
+    // A few hundred bytes, so read right here; applied in pieces as the decks and library come up
+    hasSavedSession = session.load(savedSession);
+    StartupTimer::mark(hasSavedSession ? "Session read" : "No session to restore");
+
+    // The library is read on its own thread while the window is built and shown
+    library.loadAsync([this](bool) {
+        StartupTimer::mark("Library loaded (" + String(library.getNumTracks()) + " tracks)");
+        if (hasSavedSession)
+            playlistComponent.restoreViewState(savedSession.library);
+        libraryReady = true;
+        finishStartup();
+    });
+
+    // Make sure you set the size of the component after
+    // you add any child components.
+    setSize (800, 1200);
+    
+    customLookAndFeel = std::make_unique<CustomLookAndFeel>();
+    setLookAndFeel(customLookAndFeel.get());
+
+    addAndMakeVisible(deckGUI1);
+    addAndMakeVisible(deckGUI2);
+    deckGUI1.setSyncPartner(&deckGUI2); // SYNC on either deck matches the other
+    deckGUI2.setSyncPartner(&deckGUI1);
+
+    addAndMakeVisible(playlistComponent);
+    addAndMakeVisible(masterSpectrum);
+
+    addAndMakeVisible(audioSettingsButton);
+    audioSettingsButton.onClick = [this] { showAudioSettings(); };
+
+    // Headphone cue: one toggle per deck and the cue/master blend between them
+    for (auto* button : { &phonesButton1, &phonesButton2 })
+    {
+        addAndMakeVisible(button);
+        button->setClickingTogglesState(true);
+        button->setColour(TextButton::buttonOnColourId, Colours::orange);
+    }
+    phonesButton1.onClick = [this] { mixer.setCue(0, phonesButton1.getToggleState()); };
+    phonesButton2.onClick = [this] { mixer.setCue(1, phonesButton2.getToggleState()); };
+
+    addAndMakeVisible(cueMixSlider);
+    cueMixSlider.setSliderStyle(Slider::LinearHorizontal);
+    cueMixSlider.setTextBoxStyle(Slider::NoTextBox, false, 0, 0);
+    cueMixSlider.setRange(0.0, 1.0);
+    cueMixSlider.setValue(mixer.getCueMix(), dontSendNotification);
+    cueMixSlider.onValueChange = [this] { mixer.setCueMix(cueMixSlider.getValue()); };
+    cueMixSlider.onDragEnd = [this] { saveAudioSettings(); };
+
+    // The first frame normally opens the device, but a window that starts minimised or hidden never
+    // paints, and the device, autosave and MIDI would never start
+    Timer::callAfterDelay(deviceOpenFallbackMs, [safeThis = Component::SafePointer<MainComponent>(this)] {
+        if (safeThis != nullptr)
+            safeThis->requestAudioDevice();
+    });
+}
+
+MainComponent::~MainComponent()
+{
+    session.saveNow(); // While the decks and playlist it reads still exist
+    midiInput.removeChangeListener(this);
+    midiInput.closeInputs(); // Before the decks it drives go
+    delete audioSettingsWindow.getComponent(); // Its content refers to the device manager
+    deviceManager.removeChangeListener(this);
+    setLookAndFeel(nullptr); // Reset the look and feel to the default
+    // This shuts down the audio device and clears the audio source.
+    shutdownAudio();
+}
+
+//==============================================================================
+void MainComponent::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
+{
+    mixer.prepareToPlay(samplesPerBlockExpected, sampleRate);
+}
+
+void MainComponent::getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill)
+{
+    mixer.getNextAudioBlock(bufferToFill);
+}
+
+void MainComponent::releaseResources()
+{
+    // This will be called when the audio device stops, or when it is being
+    // restarted due to a setting change.
+    mixer.releaseResources();
+}
+
+//==============================================================================
+void MainComponent::paint (Graphics& g)
+{
+    // (Our component is opaque, so we must completely fill the background with a solid colour)
+    g.fillAll (getLookAndFeel().findColour (ResizableWindow::backgroundColourId));
+
+    if (! firstFrameShown)
+    {
+        firstFrameShown = true;
+        StartupTimer::mark("First frame");
+        requestAudioDevice();
+    }
+}
+
+// Posted rather than called, so the first frame reaches the screen before the device opens
+void MainComponent::requestAudioDevice()
+{
+    if (deviceRequested)
+        return;
+
+    deviceRequested = true;
+    MessageManager::callAsync([safeThis = Component::SafePointer<MainComponent>(this)] {
+        if (safeThis != nullptr)
+            safeThis->openAudioDevice();
+    });
+}
+
+// Opening a device can take a few hundred milliseconds, so it waits for the first frame, or for the
+// fallback timer when the window doesn't paint.
+// AudioDeviceManager has to be set up on the message thread, so this can't move to a worker.
+void MainComponent::openAudioDevice()
+{
+    // Restored first, so the decks are loaded and positioned before any audio flows
+    if (hasSavedSession)
+    {
+        deckGUI1.restoreState(savedSession.decks[0]);
+        deckGUI2.restoreState(savedSession.decks[1]);
+        mixer.setCue(0, savedSession.decks[0].cued);
+        mixer.setCue(1, savedSession.decks[1].cued);
+        phonesButton1.setToggleState(mixer.isCued(0), dontSendNotification);
+        phonesButton2.setToggleState(mixer.isCued(1), dontSendNotification);
+        StartupTimer::mark("Decks restored");
+    }
+
+    // The device, rate and buffer size chosen in the settings dialog, if it has been used
+    auto savedSettings = XmlDocument::parse(getAudioSettingsFile());
+    const XmlElement* deviceSetup = savedSettings != nullptr ? savedSettings->getChildByName("DEVICESETUP") : nullptr;
+    if (auto* latency = savedSettings != nullptr ? savedSettings->getChildByName("LATENCY") : nullptr)
+    {
+        latencyMeasurement.deviceName = latency->getStringAttribute("device");
+        latencyMeasurement.sampleRate = latency->getDoubleAttribute("sampleRate");
+        latencyMeasurement.bufferSize = latency->getIntAttribute("bufferSize");
+        latencyMeasurement.roundTripSamples = latency->getIntAttribute("roundTrip");
+    }
+    if (savedSettings != nullptr)
+    {
+        mixer.setCueMix(savedSettings->getDoubleAttribute("cueMix", mixer.getCueMix()));
+        cueMixSlider.setValue(mixer.getCueMix(), dontSendNotification);
+    }
+    if (savedSettings != nullptr)
+        resamplingQuality = (DeckResampler::Quality) jlimit((int) DeckResampler::Quality::draft, (int) DeckResampler::Quality::high,
+                                                            savedSettings->getIntAttribute("resamplingQuality", (int) DeckResampler::Quality::standard));
+    mixer.setResamplingQuality(resamplingQuality);
+
+    // Some platforms require permissions to open input channels so request that here
+    if (RuntimePermissions::isRequired (RuntimePermissions::recordAudio)
+        && ! RuntimePermissions::isGranted (RuntimePermissions::recordAudio))
+    {
+        RuntimePermissions::request (RuntimePermissions::recordAudio,
+                                     [&] (bool granted) { if (granted)  setAudioChannels (2, 4); });
+    }  
+    else
+    {
+        // Specify the number of input and output channels that we want to open: the master on
+        // 1-2 and the headphone cue on 3-4, where the device has them
+        setAudioChannels (0, 4, deviceSetup);
+    }
+
+    updateLatencyCompensation();
+    deviceManager.addChangeListener(this); // Added after opening, so only the user's changes are saved
+    StartupTimer::mark("Audio device open");
+
+    midiInput.loadMapping(MidiControllerInput::getDefaultMappingFile());
+    midiInput.openInputs();
+    midiInput.addChangeListener(this);
+    StartupTimer::mark("MIDI inputs open");
+    deviceReady = true;
+    finishStartup();
+}
+
+// Reports once both the library and the audio device are ready. Autosave starts only now, so the
+// saved session can't be replaced by a half-restored one.
+void MainComponent::finishStartup()
+{
+    if (! libraryReady || ! deviceReady)
+        return;
+
+    StartupTimer::report();
+    session.startAutosave([this] { return captureSession(); });
+}
+
+SessionState MainComponent::captureSession() const
+{
+    SessionState state;
+    state.decks[0] = deckGUI1.getState();
+    state.decks[1] = deckGUI2.getState();
+    state.decks[0].cued = mixer.isCued(0);
+    state.decks[1].cued = mixer.isCued(1);
+    state.library = playlistComponent.getViewState();
+    return state;
+}
+
+// The device manager broadcasts whenever the device, rate or buffer size changes; the MIDI input
+// after a controller has changed something the window shows
+void MainComponent::changeListenerCallback(ChangeBroadcaster* source)
+{
+    if (source == &midiInput)
+    {
+        deckGUI1.syncControls();
+        deckGUI2.syncControls();
+        phonesButton1.setToggleState(mixer.isCued(0), dontSendNotification);
+        phonesButton2.setToggleState(mixer.isCued(1), dontSendNotification);
+        if (! cueMixSlider.isMouseButtonDown())
+            cueMixSlider.setValue(mixer.getCueMix(), dontSendNotification);
+        return;
+    }
+
+    updateLatencyCompensation();
+    saveAudioSettings();
+}
+
+// Shifts every playhead by the output latency, so the waveform and platter show what is being heard
+// rather than what was just rendered. That matters most at large buffers, and keeps the display
+// honest at 64-128 samples where the device's own latency dominates.
+void MainComponent::updateLatencyCompensation()
+{
+    auto* device = deviceManager.getCurrentAudioDevice();
+    if (device == nullptr || device->getCurrentSampleRate() <= 0.0)
+    {
+        mixer.setOutputLatency(0.0);
+        return;
+    }
+
+    auto samples = LatencyTester::getOutputLatencySamples(*device, latencyMeasurement);
+    mixer.setOutputLatency(1000.0 * samples / device->getCurrentSampleRate());
+}
+
+File MainComponent::getAudioSettingsFile()
+{
+    return File::getSpecialLocation(File::userApplicationDataDirectory)
+               .getChildFile("OtoDecks")
+               .getChildFile("audio-settings.xml");
+}
+
+// Device setup as the device manager describes it, plus the last latency measurement, the quality
+// and the headphone blend
+void MainComponent::saveAudioSettings()
+{
+    XmlElement settings("OTODECKSAUDIO");
+    settings.setAttribute("resamplingQuality", (int) resamplingQuality);
+    settings.setAttribute("cueMix", mixer.getCueMix());
+    if (auto deviceSetup = deviceManager.createStateXml())
+        settings.addChildElement(deviceSetup.release());
+
+    if (latencyMeasurement.roundTripSamples > 0)
+    {
+        auto* latency = settings.createNewChildElement("LATENCY");
+        latency->setAttribute("device", latencyMeasurement.deviceName);
+        latency->setAttribute("sampleRate", latencyMeasurement.sampleRate);
+        latency->setAttribute("bufferSize", latencyMeasurement.bufferSize);
+        latency->setAttribute("roundTrip", latencyMeasurement.roundTripSamples);
+    }
+
+    getAudioSettingsFile().getParentDirectory().createDirectory();
+    settings.writeTo(getAudioSettingsFile());
+}
+
+void MainComponent::showAudioSettings()
+{
+    if (audioSettingsWindow != nullptr)
+    {
+        audioSettingsWindow->toFront(true);
+        return;
+    }
+
+    DialogWindow::LaunchOptions options;
+    options.content.setOwned(new AudioSettingsComponent(deviceManager, latencyMeasurement, resamplingQuality, [this] {
+        updateLatencyCompensation();
+        mixer.setResamplingQuality(resamplingQuality);
+        saveAudioSettings();
+    }));
+    options.dialogTitle = "Audio Settings";
+    options.dialogBackgroundColour = Colours::black;
+    options.escapeKeyTriggersCloseButton = true;
+    options.useNativeTitleBar = true;
+    options.resizable = false;
+    audioSettingsWindow = options.launchAsync();
+}
+
+void MainComponent::resized()
+{
+    int masterHeight = 60; // Height of the master spectrum strip between the decks and the playlist
+    int deckHeight = getHeight() / 2 - masterHeight;
+    int settingsWidth = 80; // Audio settings button at the left of the master strip
+    int phonesWidth = 80; // Each headphone cue toggle
+    int cueMixWidth = 120; // Cue/master blend between the toggles
+    deckGUI1.setBounds(0, 1, getWidth()/2, deckHeight);
+    deckGUI2.setBounds(getWidth()/2, 1, getWidth()/2, deckHeight);
+
+    auto strip = Rectangle<int>(0, deckHeight + 1, getWidth(), masterHeight);
+    audioSettingsButton.setBounds(strip.removeFromLeft(settingsWidth));
+    phonesButton1.setBounds(strip.removeFromLeft(phonesWidth));
+    cueMixSlider.setBounds(strip.removeFromLeft(cueMixWidth));
+    phonesButton2.setBounds(strip.removeFromLeft(phonesWidth));
+    masterSpectrum.setBounds(strip);
+    playlistComponent.setBounds(0, getHeight()/2 + 1, getWidth(), getHeight()/2);
+}
+
+
@@ -1,60 +1,103 @@
-/*
-  ==============================================================================
-
-    This file was auto-generated!
-
-  ==============================================================================
-*/
-
-#pragma once
-
-#include "../JuceLibraryCode/JuceHeader.h"
-#include "DJAudioPlayer.h"
-#include "PlaylistComponent.h"
-#include "DeckGUI.h"
-
-using namespace juce;
-
-//==============================================================================
-/*
-    This component lives inside our window, and this is where you should put all
-    your controls and content.
-*/
-class MainComponent   : public juce::AudioAppComponent
-{
-public:
-    //==============================================================================
-    MainComponent();
-    ~MainComponent();
-
-    //==============================================================================
-    void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override;
-    void getNextAudioBlock (const juce::AudioSourceChannelInfo& bufferToFill) override;
-    void releaseResources() override;
-
-    //==============================================================================
-    void paint (juce::Graphics& g) override;
-    void resized() override;
-
-private:
-    //==============================================================================
-    // Your private member variables go here...
-     
-    juce::AudioFormatManager formatManager;
-    juce::AudioThumbnailCache thumbCache{100};
-
-    DJAudioPlayer player1{formatManager};
-    DeckGUI deckGUI1{&player1, formatManager, thumbCache}; 
-
-    DJAudioPlayer player2{formatManager};
-    DeckGUI deckGUI2{&player2, formatManager, thumbCache}; 
-
-    MixerAudioSource mixerSource; 
-    
-    DJAudioPlayer player;
-    PlaylistComponent playlistComponent;
-    
-    std::unique_ptr<CustomLookAndFeel> customLookAndFeel;
-
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MainComponent)
-};
+/*
+  ==============================================================================
+
+    This file was auto-generated!
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "DJAudioPlayer.h"
+#include "PlaylistComponent.h"
+#include "DeckGUI.h"
+#include "AnimationClock.h"
+#include "MixerEngine.h"
+#include "MidiControllerInput.h"
+#include "SpectrumDisplay.h"
+#include "TrackLibrary.h"
+#include "AnalysisQueue.h"
+#include "SessionStore.h"
+#include "LatencyTester.h"
+
+using namespace juce;
+
+//==============================================================================
+/*
+    This component lives inside our window, and this is where you should put all
+    your controls and content.
+*/
+class MainComponent   : public juce::AudioAppComponent,
+                        private juce::ChangeListener
+{
+public:
+    //==============================================================================
+    MainComponent();
+    ~MainComponent();
+
+    //==============================================================================
+    void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override;
+    void getNextAudioBlock (const juce::AudioSourceChannelInfo& bufferToFill) override;
+    void releaseResources() override;
+
+    //==============================================================================
+    void paint (juce::Graphics& g) override;
+    void resized() override;
+
+private:
+    void requestAudioDevice(); // Posts openAudioDevice, once
+    void openAudioDevice(); // Deferred until the first frame has been painted
+    void finishStartup(); // Writes the startup report and starts autosaving once every deferred step is done
+    SessionState captureSession() const; // Current decks and playlist view
+
+    void changeListenerCallback(juce::ChangeBroadcaster*) override; // Device settings changed, or a controller moved
+    void updateLatencyCompensation(); // Pass the current output latency to the playheads
+    void saveAudioSettings(); // Persist the device setup, latency measurement, resampling quality and cue mix
+    void showAudioSettings(); // Open the settings dialog, or bring it to the front
+    static juce::File getAudioSettingsFile(); // <user app data>/OtoDecks/audio-settings.xml
+
+    //==============================================================================
+    // Your private member variables go here...
+     
+    juce::AudioFormatManager formatManager;
+    juce::AudioThumbnailCache thumbCache{100};
+    
+    AnimationClock animationClock{*this}; // Frame clock shared by every visualiser in the window
+
+    TrackLibrary library; // Persistent track store shown by the playlist
+    AnalysisQueue analysisQueue{formatManager, library}; // Background analysis for the decks and the library
+
+    MixerEngine mixer{formatManager}; // Decks and master mix, independent of the window
+    MidiControllerInput midiInput{mixer}; // DJ controllers, opened with the audio device
+
+    DeckGUI deckGUI1{&mixer.getDeck(0), formatManager, thumbCache, animationClock, analysisQueue}; 
+    DeckGUI deckGUI2{&mixer.getDeck(1), formatManager, thumbCache, animationClock, analysisQueue}; 
+
+    SpectrumDisplay masterSpectrum{mixer.getMasterAnalyser(), animationClock}; // Master spectrum and spectrogram
+    
+    DJAudioPlayer player;
+    PlaylistComponent playlistComponent;
+    
+    std::unique_ptr<CustomLookAndFeel> customLookAndFeel;
+
+    juce::TextButton audioSettingsButton{"AUDIO"}; // Opens the audio settings dialog
+    juce::TextButton phonesButton1{"PHONES 1"}; // Sends deck 1 to the headphone cue
+    juce::TextButton phonesButton2{"PHONES 2"}; // Sends deck 2 to the headphone cue
+    juce::Slider cueMixSlider; // Headphone blend, from the cued decks on the left to the master on the right
+    juce::Component::SafePointer<juce::DialogWindow> audioSettingsWindow; // Open settings dialog, if any
+    LatencyTester::Measurement latencyMeasurement; // Last loopback measurement, shared with the dialog
+    DeckResampler::Quality resamplingQuality = DeckResampler::Quality::standard; // Shared with the dialog
+
+    SessionStore session; // Snapshot of the decks and playlist view, restored at launch
+    SessionState savedSession; // What the last run left behind
+    bool hasSavedSession = false;
+
+    bool firstFrameShown = false; // Set by the first paint, which starts the deferred startup
+    bool deviceRequested = false; // openAudioDevice has been posted
+    static constexpr int deviceOpenFallbackMs = 500; // Opens the device anyway if no frame has been painted by then
+    bool libraryReady = false; // The library file has been read and installed
+    bool deviceReady = false; // The audio device has been opened (or the permission request made)
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MainComponent)
+};
@@ -0,0 +1,294 @@
+/*
+  ==============================================================================
+
+    MidiControllerInput.cpp
+    Created: 20 Oct 2026 2:54:16am
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#include "MidiControllerInput.h"
+using namespace juce;
+
+MidiControllerInput::MidiControllerInput(MixerEngine& _mixer) : mixer(_mixer)
+{
+}
+
+MidiControllerInput::~MidiControllerInput()
+{
+    closeInputs();
+}
+
+File MidiControllerInput::getDefaultMappingFile()
+{
+    return File::getSpecialLocation(File::userApplicationDataDirectory)
+               .getChildFile("OtoDecks")
+               .getChildFile("midi-mapping.xml");
+}
+
+MidiControllerInput::Target MidiControllerInput::targetFromName(const String& name)
+{
+    static const std::pair<const char*, Target> names[] = {
+        { "play", Target::play }, { "stop", Target::stop }, { "cue", Target::cue },
+        { "loopIn", Target::loopIn }, { "loopOut", Target::loopOut }, { "sync", Target::sync },
+        { "phones", Target::phones }, { "gain", Target::gain }, { "speed", Target::speed },
+        { "jog", Target::jog }, { "cueMix", Target::cueMix }
+    };
+
+    for (const auto& entry : names)
+        if (name.equalsIgnoreCase(entry.first))
+            return entry.second;
+    return Target::none;
+}
+
+// One BINDING element per control:
+//   <BINDING type="note|cc" channel="1-16" number="0-127" deck="1|2" target="play"
+//            quantise="none|beat|bar" min="0" max="1" scale="0.002"/>
+// Notes and controllers at or above 64 fire buttons; controllers drive the absolute targets, and jog
+// reads relative values (1-63 forwards, 65-127 backwards).
+bool MidiControllerInput::loadMapping(const File& file)
+{
+    jassert(inputs.empty());
+
+    if (! file.existsAsFile())
+        writeDefaultMapping(file);
+
+    auto xml = XmlDocument::parse(file);
+    if (xml == nullptr || ! xml->hasTagName("OTODECKSMIDI"))
+        return false;
+
+    bindings.fill(Binding());
+    for (auto* element : xml->getChildWithTagNameIterator("BINDING"))
+    {
+        int kind = element->getStringAttribute("type").equalsIgnoreCase("note") ? note : controller;
+        int channel = element->getIntAttribute("channel", 1) - 1;
+        int number = element->getIntAttribute("number", -1);
+        auto target = targetFromName(element->getStringAttribute("target"));
+        if (channel < 0 || channel > 15 || number < 0 || number > 127 || target == Target::none)
+            continue;
+
+        Binding binding;
+        binding.target = target;
+        binding.deck = jlimit(0, MixerEngine::numDecks - 1, element->getIntAttribute("deck", 1) - 1);
+
+        auto quantise = element->getStringAttribute("quantise");
+        binding.quantise = quantise.equalsIgnoreCase("bar") ? DeckScheduler::Quantise::bar
+                         : quantise.equalsIgnoreCase("beat") ? DeckScheduler::Quantise::beat
+                         : DeckScheduler::Quantise::none;
+
+        // Pitch faders default to +/-8%, the usual range on a controller
+        bool isSpeed = target == Target::speed;
+        binding.min = (float) element->getDoubleAttribute("min", isSpeed ? 0.92 : 0.0);
+        binding.max = (float) element->getDoubleAttribute("max", isSpeed ? 1.08 : 1.0);
+        binding.scale = (float) element->getDoubleAttribute("scale", 0.002);
+
+        bindings[(size_t) indexOf(kind, channel, number)] = binding;
+    }
+    return true;
+}
+
+// Deck 1 on channel 1, deck 2 on channel 2, with the numbers many generic controllers send; a
+// starting point to edit rather than a match for any one controller
+void MidiControllerInput::writeDefaultMapping(const File& file)
+{
+    XmlElement root("OTODECKSMIDI");
+
+    auto add = [&root](const char* type, int channel, int number, int deck, const char* target, const char* quantise)
+    {
+        auto* binding = root.createNewChildElement("BINDING");
+        binding->setAttribute("type", type);
+        binding->setAttribute("channel", channel);
+        binding->setAttribute("number", number);
+        binding->setAttribute("deck", deck);
+        binding->setAttribute("target", target);
+        binding->setAttribute("quantise", quantise);
+    };
+
+    for (int deck = 1; deck <= MixerEngine::numDecks; ++deck)
+    {
+        add("note", deck, 11, deck, "play", "none");
+        add("note", deck, 12, deck, "cue", "beat");
+        add("note", deck, 16, deck, "loopIn", "beat");
+        add("note", deck, 17, deck, "loopOut", "beat");
+        add("note", deck, 88, deck, "sync", "beat");
+        add("note", deck, 84, deck, "phones", "none");
+        add("cc", deck, 19, deck, "gain", "none");
+        add("cc", deck, 9, deck, "speed", "none");
+        add("cc", deck, 6, deck, "jog", "none");
+    }
+    add("cc", 1, 12, 1, "cueMix", "none");
+
+    file.getParentDirectory().createDirectory();
+    root.writeTo(file);
+}
+
+void MidiControllerInput::openInputs()
+{
+    closeInputs();
+
+    for (const auto& device : MidiInput::getAvailableDevices())
+    {
+        if (auto input = MidiInput::openDevice(device.identifier, this))
+        {
+            input->start();
+            inputs.push_back(std::move(input));
+        }
+    }
+
+    // Created after the scan so it isn't opened twice; tools like aconnect or amidi can drive it
+    // without hardware
+   #if JUCE_LINUX || JUCE_BSD || JUCE_MAC || JUCE_IOS
+    if (auto input = MidiInput::createNewDevice(virtualPortName, this))
+    {
+        input->start();
+        inputs.push_back(std::move(input));
+    }
+   #endif
+}
+
+void MidiControllerInput::closeInputs()
+{
+    for (auto& input : inputs)
+        input->stop(); // No callbacks once this returns
+    inputs.clear();
+}
+
+StringArray MidiControllerInput::getOpenInputNames() const
+{
+    StringArray names;
+    for (const auto& input : inputs)
+        names.add(input->getName());
+    return names;
+}
+
+// MIDI thread. The message's timestamp is on the same clock as the schedulers', so a command runs
+// relative to when the control moved rather than when this callback got round to it.
+void MidiControllerInput::handleIncomingMidiMessage(MidiInput*, const MidiMessage& message)
+{
+    const int channel = message.getChannel() - 1;
+    if (channel < 0)
+        return;
+
+    const double issuedMs = message.getTimeStamp() > 0.0 ? message.getTimeStamp() * 1000.0
+                                                         : Time::getMillisecondCounterHiRes();
+
+    if (message.isNoteOn())
+    {
+        const auto& binding = bindings[(size_t) indexOf(note, channel, message.getNoteNumber())];
+        if (! isButton(binding.target))
+            return;
+        trigger(binding, issuedMs);
+    }
+    else if (message.isController())
+    {
+        const int number = message.getControllerNumber();
+        const int value = message.getControllerValue();
+        const auto& binding = bindings[(size_t) indexOf(controller, channel, number)];
+        if (binding.target == Target::none)
+            return;
+
+        if (isButton(binding.target))
+        {
+            bool held = value >= 64;
+            bool wasHeld = controllerHeld[(size_t) (channel * 128 + number)].exchange(held);
+            if (! held || wasHeld)
+                return;
+            trigger(binding, issuedMs);
+        }
+        else
+        {
+            setValue(binding, value, issuedMs);
+        }
+    }
+    else
+    {
+        return;
+    }
+
+    sendChangeMessage(); // Asynchronous: the UI catches up whenever it gets round to it
+}
+
+void MidiControllerInput::trigger(const Binding& binding, double issuedMs)
+{
+    auto& deck = mixer.getDeck(binding.deck);
+
+    DeckScheduler::Command command;
+    command.quantise = binding.quantise;
+    command.issuedMs = issuedMs;
+
+    switch (binding.target)
+    {
+        case Target::play:
+            if (deck.isPlaying())
+            {
+                command.action = DeckScheduler::Action::stop;
+                deck.schedule(command);
+            }
+            else
+            {
+                deck.scheduleStart(&mixer.getDeck(MixerEngine::numDecks - 1 - binding.deck), binding.quantise, issuedMs);
+            }
+            break;
+        case Target::stop:
+            command.action = DeckScheduler::Action::stop;
+            deck.schedule(command);
+            break;
+        case Target::cue:
+            command.action = DeckScheduler::Action::jump;
+            command.seconds = deck.getCuePoint();
+            deck.schedule(command);
+            break;
+        case Target::loopIn:
+            command.action = DeckScheduler::Action::loopIn;
+            deck.schedule(command);
+            break;
+        case Target::loopOut:
+            command.action = DeckScheduler::Action::loopOut;
+            deck.schedule(command);
+            break;
+        case Target::sync:
+            deck.scheduleSync(mixer.getDeck(MixerEngine::numDecks - 1 - binding.deck), binding.quantise, issuedMs);
+            break;
+        case Target::phones:
+            mixer.setCue(binding.deck, ! mixer.isCued(binding.deck));
+            break;
+        default:
+            break;
+    }
+}
+
+// Parameters are atomics the audio thread reads at the start of each block
+void MidiControllerInput::setValue(const Binding& binding, int value, double issuedMs)
+{
+    auto& deck = mixer.getDeck(binding.deck);
+    double scaled = binding.min + (binding.max - binding.min) * (value / 127.0);
+
+    switch (binding.target)
+    {
+        case Target::gain:
+            deck.setGain(jlimit(0.0, 2.0, scaled));
+            break;
+        case Target::speed:
+            deck.setSpeed(jlimit(0.25, 2.0, scaled));
+            break;
+        case Target::cueMix:
+            mixer.setCueMix(scaled);
+            break;
+        case Target::jog:
+        {
+            int ticks = value < 64 ? value : value - 128;
+            if (ticks == 0)
+                break;
+
+            DeckScheduler::Command command;
+            command.action = DeckScheduler::Action::nudge;
+            command.seconds = ticks * binding.scale;
+            command.issuedMs = issuedMs;
+            deck.schedule(command);
+            break;
+        }
+        default:
+            break;
+    }
+}
@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+
+    MidiControllerInput.h
+    Created: 20 Oct 2026 2:54:16am
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "MixerEngine.h"
+
+// MidiControllerInput class: Drives the decks from a MIDI DJ controller. Messages are handled on the
+// MIDI thread as they arrive: faders and knobs set the deck parameters directly, buttons and jog
+// wheels push timestamped commands onto the decks' schedulers, so nothing waits on the message thread
+// and the latency is at most one audio block. What each control does comes from an XML mapping file.
+// A change message tells the UI to catch up with values a controller has set.
+class MidiControllerInput : public juce::MidiInputCallback,
+                            public juce::ChangeBroadcaster {
+public:
+    enum class Target {
+        none,
+        play, // Toggles between playing and paused
+        stop, // Pause
+        cue, // Jump to the deck's cue point
+        loopIn,
+        loopOut,
+        sync,
+        phones, // Toggle the deck in the headphone cue
+        gain, // Absolute: min to max
+        speed, // Absolute: min to max
+        jog, // Relative: each tick nudges the deck by scale seconds, bending its speed while it plays
+        cueMix // Absolute: headphone blend
+    };
+
+    explicit MidiControllerInput(MixerEngine& mixer);
+    ~MidiControllerInput() override;
+
+    // Reads the mapping, writing the default one first if the file doesn't exist. Call while no
+    // inputs are open; the table is read by the MIDI thread without a lock.
+    bool loadMapping(const juce::File& file);
+    static juce::File getDefaultMappingFile(); // <user app data>/OtoDecks/midi-mapping.xml
+    static void writeDefaultMapping(const juce::File& file);
+
+    void openInputs(); // Every available MIDI input, plus a virtual port where the platform has them
+    void closeInputs();
+    juce::StringArray getOpenInputNames() const;
+
+    static constexpr const char* virtualPortName = "OtoDecks Controller";
+
+private:
+    // What one note or controller number on one channel is bound to
+    struct Binding {
+        Target target = Target::none;
+        int deck = 0; // 0 or 1; unused by cueMix
+        DeckScheduler::Quantise quantise = DeckScheduler::Quantise::none;
+        float min = 0.0f, max = 1.0f; // Range of an absolute control
+        float scale = 0.0f; // Seconds per jog tick
+    };
+
+    enum Kind { note, controller, numKinds };
+
+    void handleIncomingMidiMessage(juce::MidiInput* source, const juce::MidiMessage& message) override; // MIDI thread
+    void trigger(const Binding& binding, double issuedMs); // Buttons
+    void setValue(const Binding& binding, int value, double issuedMs); // Faders, knobs and jogs
+
+    static int indexOf(int kind, int channel, int number) { return (kind * 16 + channel) * 128 + number; }
+    static Target targetFromName(const juce::String& name);
+    static bool isButton(Target target) { return target != Target::none && target < Target::gain; }
+
+    MixerEngine& mixer;
+    std::array<Binding, numKinds * 16 * 128> bindings; // Indexed by kind, channel and number
+    std::array<std::atomic<bool>, 16 * 128> controllerHeld {}; // Last state of controllers used as buttons, for edges
+
+    std::vector<std::unique_ptr<juce::MidiInput>> inputs;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MidiControllerInput)
+};
@@ -0,0 +1,156 @@
+/*
+  ==============================================================================
+
+    MixerEngine.cpp
+    Created: 19 Oct 2026 10:02:37pm
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#include "MixerEngine.h"
+#include "Trace.h"
+using namespace juce;
+
+MixerEngine::MixerEngine(AudioFormatManager& formatManager)
+{
+    for (size_t d = 0; d < decks.size(); ++d)
+    {
+        decks[d] = std::make_unique<DJAudioPlayer>(formatManager);
+        cueSends[d] = 0.0f;
+        appliedSends[d] = { (float) decks[d]->getGain(), 0.0f };
+    }
+}
+
+MixerEngine::~MixerEngine()
+{
+}
+
+// The deck buffers are sized here for the expected block; larger blocks are rendered in pieces, so
+// the audio thread never allocates
+void MixerEngine::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
+{
+    maxChunk = jmax(1, samplesPerBlockExpected);
+    for (size_t d = 0; d < decks.size(); ++d)
+    {
+        deckBuffers[d].setSize(2, maxChunk);
+        decks[d]->prepareToPlay(samplesPerBlockExpected, sampleRate);
+    }
+    masterAnalyser.prepare(sampleRate);
+    OTO_TRACE_RESERVE_THREAD("Audio callback"); // Claimed by the callback, so its first event doesn't allocate
+}
+
+void MixerEngine::getNextAudioBlock(const AudioSourceChannelInfo& bufferToFill)
+{
+    OTO_TRACE_CLAIM_THREAD();
+    OTO_TRACE_SCOPE("Audio callback");
+
+    if (maxChunk == 0)
+    {
+        bufferToFill.clearActiveBufferRegion();
+        return;
+    }
+
+    for (int done = 0; done < bufferToFill.numSamples;)
+    {
+        int count = jmin(maxChunk, bufferToFill.numSamples - done);
+        renderChunk(AudioSourceChannelInfo(bufferToFill.buffer, bufferToFill.startSample + done, count));
+        done += count;
+    }
+
+    masterAnalyser.pushSamples(*bufferToFill.buffer, bufferToFill.startSample, bufferToFill.numSamples); // Outputs 1-2 only
+}
+
+// Every deck renders exactly once; the buses only read the deck buffers, so a cue bus costs a
+// few vector adds rather than a second render. The fader is applied here, on the master send only.
+// The headphones get the master scaled by the blend plus each cued deck scaled by its send and the
+// rest of the blend.
+void MixerEngine::renderChunk(const AudioSourceChannelInfo& bufferToFill)
+{
+    auto& out = *bufferToFill.buffer;
+    const int start = bufferToFill.startSample;
+    const int numSamples = bufferToFill.numSamples;
+
+    for (size_t d = 0; d < decks.size(); ++d)
+    {
+        deckBuffers[d].setSize(2, numSamples, false, false, true); // Shrinks within the allocation
+        decks[d]->getNextAudioBlock(AudioSourceChannelInfo(deckBuffers[d]));
+    }
+
+    std::array<std::array<float, numBuses>, numDecks> targets;
+    for (size_t d = 0; d < decks.size(); ++d)
+    {
+        targets[d][masterBus] = (float) decks[d]->getGain();
+        targets[d][cueBus] = cueSends[d].load(std::memory_order_relaxed);
+    }
+    const auto targetCueMix = (float) cueMix.load(std::memory_order_relaxed);
+
+    const int masterChannels = jmin(2, out.getNumChannels());
+    const int cueChannels = jlimit(0, 2, out.getNumChannels() - cueOutputChannel);
+
+    for (int channel = 0; channel < masterChannels; ++channel)
+    {
+        out.clear(channel, start, numSamples);
+        for (size_t d = 0; d < decks.size(); ++d)
+            if (appliedSends[d][masterBus] != 0.0f || targets[d][masterBus] != 0.0f)
+                out.addFromWithRamp(channel, start, deckBuffers[d].getReadPointer(channel), numSamples,
+                                    appliedSends[d][masterBus], targets[d][masterBus]);
+    }
+
+    for (int channel = 0; channel < cueChannels; ++channel)
+    {
+        auto cueChannel = cueOutputChannel + channel;
+        if (channel < masterChannels)
+            out.copyFromWithRamp(cueChannel, start, out.getReadPointer(channel, start), numSamples, appliedCueMix, targetCueMix);
+        else
+            out.clear(cueChannel, start, numSamples);
+
+        for (size_t d = 0; d < decks.size(); ++d)
+        {
+            auto from = appliedSends[d][cueBus] * (1.0f - appliedCueMix);
+            auto to = targets[d][cueBus] * (1.0f - targetCueMix);
+            if (from != 0.0f || to != 0.0f)
+                out.addFromWithRamp(cueChannel, start, deckBuffers[d].getReadPointer(channel), numSamples, from, to);
+        }
+    }
+
+    for (int channel = masterChannels; channel < out.getNumChannels(); ++channel)
+        if (channel < cueOutputChannel || channel >= cueOutputChannel + cueChannels)
+            out.clear(channel, start, numSamples);
+
+    appliedSends = targets;
+    appliedCueMix = targetCueMix;
+}
+
+void MixerEngine::setOutputLatency(double ms)
+{
+    for (auto& deck : decks)
+        deck->setOutputLatency(ms);
+}
+
+void MixerEngine::setResamplingQuality(DeckResampler::Quality quality)
+{
+    for (auto& deck : decks)
+        deck->setResamplingQuality(quality);
+}
+
+void MixerEngine::setCue(int deckIndex, bool enabled)
+{
+    cueSends[(size_t) deckIndex] = enabled ? 1.0f : 0.0f;
+}
+
+bool MixerEngine::isCued(int deckIndex) const
+{
+    return cueSends[(size_t) deckIndex].load() != 0.0f;
+}
+
+void MixerEngine::setCueMix(double blend)
+{
+    cueMix = jlimit(0.0, 1.0, blend);
+}
+
+void MixerEngine::releaseResources()
+{
+    for (auto& deck : decks)
+        deck->releaseResources();
+}
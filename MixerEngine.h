@@ -0,0 +1,68 @@
+/*
+  ==============================================================================
+
+    MixerEngine.h
+    Created: 19 Oct 2026 10:02:37pm
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <memory>
+#include "DJAudioPlayer.h"
+#include "SpectrumAnalyser.h"
+
+// MixerEngine class: The two decks and the master mix, with no GUI or audio device attached. The
+// app plays it through its AudioAppComponent; headless tools can pull blocks from it directly.
+// Each deck renders once per block into its own buffer, at its loudness trim but before its fader, which
+// a routing matrix then adds into the master on outputs 1-2 and, when the device has them, the
+// headphone cue on outputs 3-4.
+class MixerEngine : public juce::AudioSource {
+public:
+    static constexpr int numDecks = 2;
+
+    explicit MixerEngine(juce::AudioFormatManager& formatManager);
+    ~MixerEngine() override;
+
+    void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+    void getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill) override; // Mix the decks and feed the master analyser
+    void releaseResources() override;
+
+    void setOutputLatency(double ms); // Passed to every deck so the playheads show what is being heard
+    void setResamplingQuality(DeckResampler::Quality quality); // Passed to every deck
+    void setCue(int deckIndex, bool enabled); // Send the deck to the headphones
+    bool isCued(int deckIndex) const;
+    void setCueMix(double blend); // Headphone blend: 0 is the cued decks only, 1 the master only
+    double getCueMix() const { return cueMix.load(); }
+
+    DJAudioPlayer& getDeck(int index) { return *decks[(size_t) index]; } // Deck 0 or 1
+    SpectrumAnalyser& getMasterAnalyser() { return masterAnalyser; } // Analyser fed with the master mix
+
+    static constexpr int cueOutputChannel = 2; // First of the headphone pair
+
+private:
+    enum Bus { masterBus, cueBus, numBuses };
+
+    void renderChunk(const juce::AudioSourceChannelInfo& bufferToFill); // At most one deck buffer's length
+
+    std::array<std::unique_ptr<DJAudioPlayer>, numDecks> decks;
+    std::array<juce::AudioBuffer<float>, numDecks> deckBuffers; // Each deck's latest render, shared by the buses
+    int maxChunk = 0; // Samples the deck buffers were allocated for
+    SpectrumAnalyser masterAnalyser; // Background analyser fed with the master mix
+
+    // Routing matrix: the gain each deck is sent to each bus with. The master send is the deck's
+    // channel fader, read from the deck every block; the cue send is the headphone toggle, so the cue
+    // hears the deck pre-fader. The audio thread ramps from the gains it used last block, so neither
+    // a fader move nor a cue toggle clicks.
+    std::array<std::atomic<float>, numDecks> cueSends;
+    std::array<std::array<float, numBuses>, numDecks> appliedSends {};
+    std::atomic<double> cueMix { 0.0 };
+    float appliedCueMix = 0.0f;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MixerEngine)
+};
@@ -0,0 +1,68 @@
+/*
+  ==============================================================================
+
+    PlayheadClock.cpp
+    Created: 19 Oct 2026 10:14:52am
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#include "PlayheadClock.h"
+using namespace juce;
+
+// Advances the captured position by the elapsed host time while playing, clamped to the track.
+// hostTimeMs may lie ahead of now when it includes output latency; the position then runs backwards
+// to what is actually being heard.
+double PlayheadSnapshot::positionAt(double nowMs) const
+{
+    if (! playing)
+        return positionSeconds;
+
+    double elapsedSeconds = (nowMs - hostTimeMs) * 0.001;
+    return jlimit(0.0, lengthSeconds, positionSeconds + elapsedSeconds * speed);
+}
+
+double PlayheadSnapshot::relativePositionAt(double nowMs) const
+{
+    return lengthSeconds > 0.0 ? positionAt(nowMs) / lengthSeconds : 0.0;
+}
+
+// Marks the sequence odd, writes the fields, then marks it even again
+void PlayheadClock::publish(const PlayheadSnapshot& snapshot)
+{
+    auto seq = sequence.load(std::memory_order_relaxed);
+    sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    positionSeconds.store(snapshot.positionSeconds, std::memory_order_relaxed);
+    lengthSeconds.store(snapshot.lengthSeconds, std::memory_order_relaxed);
+    speed.store(snapshot.speed, std::memory_order_relaxed);
+    hostTimeMs.store(snapshot.hostTimeMs, std::memory_order_relaxed);
+    playing.store(snapshot.playing, std::memory_order_relaxed);
+
+    sequence.store(seq + 2, std::memory_order_release);
+}
+
+// Copies the fields and retries until no publish overlapped the copy
+PlayheadSnapshot PlayheadClock::read() const
+{
+    PlayheadSnapshot snapshot;
+
+    for (;;)
+    {
+        auto before = sequence.load(std::memory_order_acquire);
+        if ((before & 1) != 0)
+            continue;
+
+        snapshot.positionSeconds = positionSeconds.load(std::memory_order_relaxed);
+        snapshot.lengthSeconds = lengthSeconds.load(std::memory_order_relaxed);
+        snapshot.speed = speed.load(std::memory_order_relaxed);
+        snapshot.hostTimeMs = hostTimeMs.load(std::memory_order_relaxed);
+        snapshot.playing = playing.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) == before)
+            return snapshot;
+    }
+}
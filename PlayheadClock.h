@@ -0,0 +1,42 @@
+/*
+  ==============================================================================
+
+    PlayheadClock.h
+    Created: 19 Oct 2026 10:14:52am
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+
+// Transport state captured by the audio thread at the start of a block
+struct PlayheadSnapshot {
+    double positionSeconds = 0.0; // Playhead position in track seconds at hostTimeMs
+    double lengthSeconds = 0.0; // Length of the loaded track, 0 if nothing is loaded
+    double speed = 1.0; // Playback speed ratio
+    double hostTimeMs = 0.0; // Time::getMillisecondCounterHiRes() at which positionSeconds is heard
+    bool playing = false; // Whether the transport was running
+
+    double positionAt(double nowMs) const; // Extrapolate the position to the given host time
+    double relativePositionAt(double nowMs) const; // Same as positionAt, as a fraction of the length (0 when unloaded)
+};
+
+// PlayheadClock class: Single-writer seqlock that lets the audio thread publish a PlayheadSnapshot
+// without locks and lets the UI read a consistent copy from any thread
+class PlayheadClock {
+public:
+    void publish(const PlayheadSnapshot& snapshot); // Audio thread only; wait-free
+    PlayheadSnapshot read() const; // Any thread; retries if it overlapped a publish
+
+private:
+    std::atomic<uint32_t> sequence { 0 }; // Odd while a publish is in progress
+    std::atomic<double> positionSeconds { 0.0 };
+    std::atomic<double> lengthSeconds { 0.0 };
+    std::atomic<double> speed { 1.0 };
+    std::atomic<double> hostTimeMs { 0.0 };
+    std::atomic<bool> playing { false };
+};
@@ -1,140 +1,586 @@
-/*
-  ==============================================================================
-
-    PlaylistComponent.cpp
-    Created: 10 Mar 2024 9:07:35pm
-    Author:  roscoe liew
-
-  ==============================================================================
-*/
-#include <JuceHeader.h>
-#include "PlaylistComponent.h"
-#include "DeckGUI.h"
-
-using namespace juce;
-
-// Initializes the playlist component with references to the player and decks
-PlaylistComponent::PlaylistComponent(DJAudioPlayer* _player, DeckGUI* _deckGUI1, DeckGUI* _deckGUI2)
-: player(_player), deckGUI1(_deckGUI1), deckGUI2(_deckGUI2)
-{
-    // Add some sample tracks
-    trackTitles.push_back("Track 1");
-    trackTitles.push_back("Track 2");
-    trackTitles.push_back("Track 3");
-    trackTitles.push_back("Track 4");
-    trackTitles.push_back("Track 5");
-    trackTitles.push_back("Track 6");
-
-    // Set up the table columns
-    tableComponent.getHeader().addColumn("Track title", 1, 400);
-    tableComponent.getHeader().addColumn("Insert", 2, 200);
-    tableComponent.getHeader().addColumn("Load", 3, 200);
-
-    // Set the table model and add it to the component
-    tableComponent.setModel(this);
-    addAndMakeVisible(tableComponent);
-    
-    trackFiles.resize(trackTitles.size());
-}
-
-PlaylistComponent::~PlaylistComponent(){
-}
-
-// Draws the background and border of the playlist component
-void PlaylistComponent::paint (juce::Graphics& g)
-{
-    g.fillAll (juce::Colours::black);  // clear the background
-    g.setColour (juce::Colours::red);
-    g.drawRect (getLocalBounds(), 1);   // draw an outline around the component
-}
-
-// Sets the bounds of the table component
-void PlaylistComponent::resized()
-{
-    tableComponent.setBounds(0, 0, getWidth(), getHeight());
-}
-
-// Returns the number of rows in the table
-int PlaylistComponent::getNumRows()
-{
-    return trackTitles.size();
-}
-
-// Fills the background of each row
-void PlaylistComponent::paintRowBackground(Graphics &g, int rowNumber, int width, int height, bool rowIsSelected)
-{
-    if (rowIsSelected) {
-        g.fillAll(Colours::darkgrey);
-    } else {
-        g.fillAll(Colours::black);
-    }
-}
-
-// Draws the content of each cell
-void PlaylistComponent::paintCell(Graphics &g, int rowNumber, int columnId, int width, int height, bool rowIsSelected)
-{
-    if (columnId == 1) {
-        g.setColour(juce::Colours::white); // Set text color to white
-        g.drawText(trackTitles[rowNumber], 2, 0, width - 4, height, Justification::centredLeft, true);
-    }
-}
-
-// Updates the component for each cell
-Component* PlaylistComponent::refreshComponentForCell(int rowNumber, int columnId, bool isRowSelected, Component *existingComponentToUpdate)
-{
-    if (columnId == 2) {
-        // Play button
-        if (existingComponentToUpdate == nullptr) {
-            TextButton* btn = new TextButton{"Insert"};
-            String id{std::to_string(rowNumber)};
-            btn->setComponentID(id);
-            btn->addListener(this);
-            existingComponentToUpdate = btn;
-        }
-    } else if (columnId == 3) {
-        // Load button
-        if (existingComponentToUpdate == nullptr) {
-            TextButton* btn = new TextButton{"Load"};
-            String id{std::to_string(rowNumber)};
-            btn->setComponentID(id);
-            btn->addListener(this);
-            existingComponentToUpdate = btn;
-        }
-    }
-    return existingComponentToUpdate;
-}
-
-// Handles button click events
-void PlaylistComponent::buttonClicked(Button* button) {
-    int id = std::stoi(button->getComponentID().toStdString());
-
-    if (button->getButtonText() == "Load") {
-        auto fileChooserFlags = FileBrowserComponent::canSelectFiles;
-        fChooser.launchAsync(fileChooserFlags, [this, id](const FileChooser& chooser) {
-            auto file = chooser.getResult();
-            if (file.existsAsFile()) {
-                trackFiles[id] = URL{file};
-                trackTitles[id] = file.getFileNameWithoutExtension().toStdString(); // Update track title with file name
-                tableComponent.updateContent(); // Refresh the table to show the updated title
-                std::cout << "Loaded file: " << file.getFullPathName() << " for track " << id << std::endl;
-            }
-        });
-    } else if (button->getButtonText() == "Insert") {
-        if (trackFiles[id].isEmpty()) {
-            std::cout << "No file loaded for track " << id << std::endl;
-        } else {
-            // Check if either of the decks is empty and load the track into the first empty deck
-            if (deckGUI1->isEmpty()) {
-                deckGUI1->loadURL(trackFiles[id]);
-                deckGUI1->start();
-                std::cout << "Loaded and playing file in Deck 1: " << trackFiles[id].toString(true) << std::endl;
-            } else if (deckGUI2->isEmpty()) {
-                deckGUI2->loadURL(trackFiles[id]);
-                deckGUI2->start();
-                std::cout << "Loaded and playing file in Deck 2: " << trackFiles[id].toString(true) << std::endl;
-            } else {
-                std::cout << "Both decks are occupied. Please stop a deck before loading a new track." << std::endl;
-            }
-        }
-    }
-}
+/*
+  ==============================================================================
+
+    PlaylistComponent.cpp
+    Created: 10 Mar 2024 9:07:35pm
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+#include <JuceHeader.h>
+#include "PlaylistComponent.h"
+#include "DeckGUI.h"
+#include "Trace.h"
+#include <algorithm>
+#include <iterator>
+
+using namespace juce;
+
+// Initializes the playlist component with references to the player, decks, library and analysis queue
+PlaylistComponent::PlaylistComponent(DJAudioPlayer* _player, DeckGUI* _deckGUI1, DeckGUI* _deckGUI2, TrackLibrary& _library, AudioFormatManager& _formatManager, AnalysisQueue& _analysisQueue)
+: library(_library), formatManager(_formatManager), analysisQueue(_analysisQueue), player(_player), deckGUI1(_deckGUI1), deckGUI2(_deckGUI2)
+{
+    // Set up the table columns
+    int actionFlags = TableHeaderComponent::visible | TableHeaderComponent::resizable; // Not sortable
+    tableComponent.getHeader().addColumn("Track title", titleColumn, 260);
+    tableComponent.getHeader().addColumn("BPM", bpmColumn, 60);
+    tableComponent.getHeader().addColumn("Key", keyColumn, 50);
+    tableComponent.getHeader().addColumn("Length", durationColumn, 60);
+    tableComponent.getHeader().addColumn("Loudness", loudnessColumn, 80);
+    tableComponent.getHeader().addColumn("Last played", lastPlayedColumn, 100);
+    tableComponent.getHeader().addColumn("Insert", insertColumn, 80, 30, -1, actionFlags);
+    tableComponent.getHeader().addColumn("Load", loadColumn, 80, 30, -1, actionFlags);
+    tableComponent.getHeader().setStretchToFitActive(true);
+
+    // Set the table model and add it to the component
+    tableComponent.setModel(this);
+    addAndMakeVisible(tableComponent);
+    tableComponent.setWantsKeyboardFocus(true);
+
+    addAndMakeVisible(addButton);
+    addButton.addListener(this);
+    addAndMakeVisible(importButton);
+    importButton.addListener(this);
+    addAndMakeVisible(scanStatus);
+    scanStatus.setJustificationType(Justification::centred);
+    addAndMakeVisible(searchBox);
+    searchBox.setTextToShowWhenEmpty("Search title or artist, bpm:120-128, key:8A", Colours::grey);
+    searchBox.onTextChange = [this] { applySearch(true); };
+
+    library.addChangeListener(this);
+    scanner.addChangeListener(this);
+    analysisQueue.addChangeListener(this);
+}
+
+PlaylistComponent::~PlaylistComponent(){
+    indexBuilder.removeAllJobs(true, 2000);
+    analysisQueue.removeChangeListener(this);
+    scanner.removeChangeListener(this);
+    library.removeChangeListener(this);
+}
+
+// Draws the background and border of the playlist component
+void PlaylistComponent::paint (juce::Graphics& g)
+{
+    g.fillAll (juce::Colours::black);  // clear the background
+    g.setColour (juce::Colours::red);
+    g.drawRect (getLocalBounds(), 1);   // draw an outline around the component
+}
+
+// Sets the bounds of the table component
+void PlaylistComponent::resized()
+{
+    int buttonHeight = 30;
+    addButton.setBounds(0, 0, getWidth() / 3, buttonHeight);
+    importButton.setBounds(getWidth() / 3, 0, getWidth() / 3, buttonHeight);
+    scanStatus.setBounds(getWidth() * 2 / 3, 0, getWidth() - getWidth() * 2 / 3, buttonHeight);
+    searchBox.setBounds(0, buttonHeight, getWidth(), buttonHeight);
+    tableComponent.setBounds(0, buttonHeight * 2, getWidth(), getHeight() - buttonHeight * 2);
+}
+
+// Returns the number of rows in the table
+int PlaylistComponent::getNumRows()
+{
+    return filtering || sortColumn != 0 ? (int) viewRows.size() : library.getNumTracks();
+}
+
+// Fills the background of each row
+void PlaylistComponent::paintRowBackground(Graphics &g, int rowNumber, int width, int height, bool rowIsSelected)
+{
+    if (rowIsSelected) {
+        g.fillAll(Colours::darkgrey);
+    } else {
+        g.fillAll(Colours::black);
+    }
+}
+
+// Draws the content of each cell
+void PlaylistComponent::paintCell(Graphics &g, int rowNumber, int columnId, int width, int height, bool rowIsSelected)
+{
+    OTO_TRACE_SCOPE("PlaylistComponent::paintCell");
+    int index = libraryIndexForRow(rowNumber);
+    if (index < 0)
+        return;
+
+    if (columnId == titleColumn) {
+        bool missing = (library.getRecord(index).flags & TrackRecord::missing) != 0;
+        g.setColour(missing ? juce::Colours::grey : juce::Colours::white); // Grey out tracks whose file has gone
+        auto artist = library.getArtist(index);
+        auto title = library.getTitle(index);
+        g.drawText(artist.isEmpty() ? title : artist + " - " + title, 2, 0, width - 4, height, Justification::centredLeft, true);
+        return;
+    }
+    if (columnId == insertColumn || columnId == loadColumn) {
+        paintActionCell(g, columnId == insertColumn ? "Insert" : "Load", width, height);
+        return;
+    }
+
+    // Analysis and history columns; blank until the value is known
+    const auto& record = library.getRecord(index);
+    String text;
+    if (columnId == bpmColumn && (record.flags & TrackRecord::hasTempo) != 0) {
+        text = String(record.bpm, 1);
+    } else if (columnId == keyColumn && (record.flags & TrackRecord::hasKey) != 0) {
+        text = TrackLibrary::keyToCamelot(record.key);
+    } else if (columnId == durationColumn) {
+        int seconds = roundToInt(record.durationSeconds);
+        text = String(seconds / 60) + ":" + String(seconds % 60).paddedLeft('0', 2);
+    } else if (columnId == loudnessColumn && (record.flags & TrackRecord::hasLoudness) != 0) {
+        text = String(record.loudnessLufs, 1) + " LUFS";
+    } else if (columnId == lastPlayedColumn && record.lastPlayed > 0) {
+        text = Time(record.lastPlayed).formatted("%Y-%m-%d");
+    }
+    g.setColour(juce::Colours::white);
+    g.drawText(text, 2, 0, width - 4, height, Justification::centredLeft, true);
+}
+
+// Action cells are painted rather than backed by buttons, so scrolling creates no components
+void PlaylistComponent::paintActionCell(Graphics& g, const String& text, int width, int height)
+{
+    auto area = Rectangle<int>(0, 0, width, height).reduced(2);
+    g.setColour(juce::Colours::red);
+    g.drawRect(area, 1);
+    g.setColour(juce::Colours::white);
+    g.drawText(text, area, Justification::centred, true);
+}
+
+void PlaylistComponent::cellClicked(int rowNumber, int columnId, const MouseEvent&)
+{
+    int index = libraryIndexForRow(rowNumber);
+    if (index < 0)
+        return;
+
+    if (columnId == insertColumn)
+        insertTrack(index, nullptr);
+    else if (columnId == loadColumn)
+        relinkTrack(index);
+}
+
+void PlaylistComponent::cellDoubleClicked(int rowNumber, int columnId, const MouseEvent&)
+{
+    int index = libraryIndexForRow(rowNumber);
+    if (index >= 0 && columnId == titleColumn)
+        insertTrack(index, nullptr);
+}
+
+void PlaylistComponent::returnKeyPressed(int lastRowSelected)
+{
+    int index = libraryIndexForRow(lastRowSelected);
+    if (index >= 0)
+        insertTrack(index, nullptr);
+}
+
+// Keys the table doesn't use itself arrive here
+bool PlaylistComponent::keyPressed(const KeyPress& key)
+{
+    int index = libraryIndexForRow(tableComponent.getSelectedRow());
+    if (index < 0)
+        return false;
+
+    auto c = key.getTextCharacter();
+    if (c == '1') {
+        insertTrack(index, deckGUI1);
+        return true;
+    }
+    if (c == '2') {
+        insertTrack(index, deckGUI2);
+        return true;
+    }
+    if (c == 'l' || c == 'L') {
+        relinkTrack(index);
+        return true;
+    }
+    return false;
+}
+
+// Handles button click events
+void PlaylistComponent::buttonClicked(Button* button) {
+    if (button == &addButton) {
+        auto fileChooserFlags = FileBrowserComponent::openMode | FileBrowserComponent::canSelectFiles | FileBrowserComponent::canSelectMultipleItems;
+        fChooser.launchAsync(fileChooserFlags, [this](const FileChooser& chooser) {
+            addFiles(chooser.getResults());
+        });
+    } else if (button == &importButton) {
+        if (scanner.isScanning()) {
+            scanner.cancel();
+            return;
+        }
+        auto folderChooserFlags = FileBrowserComponent::openMode | FileBrowserComponent::canSelectDirectories;
+        folderChooser.launchAsync(folderChooserFlags, [this](const FileChooser& chooser) {
+            auto folder = chooser.getResult();
+            if (! folder.isDirectory())
+                return;
+            if (library.getWatchedFolders().contains(folder.getFullPathName()))
+                scanner.scanFolder(folder); // Already watched; rescan on request
+            else
+                watcher.watchFolder(folder); // Watching a folder starts with a full scan of it
+        });
+    }
+}
+
+// Repoints a library entry at a file chosen by the user
+void PlaylistComponent::relinkTrack(int index) {
+    auto fileChooserFlags = FileBrowserComponent::canSelectFiles;
+    fChooser.launchAsync(fileChooserFlags, [this, index](const FileChooser& chooser) {
+        auto file = chooser.getResult();
+        TrackInfo info;
+        if (index < library.getNumTracks() && file.existsAsFile() && TrackLibrary::readTrackInfo(formatManager, file, info)) {
+            int existing = library.indexOf(file);
+            if (existing >= 0 && existing != index) {
+                std::cout << "File is already in the library as track " << existing << std::endl;
+                return;
+            }
+            library.setFile(index, info); // The table refreshes from the change message
+            std::cout << "Loaded file: " << file.getFullPathName() << " for track " << index << std::endl;
+        }
+    });
+}
+
+// Loads a track into the requested deck, or the first empty one, and starts it
+void PlaylistComponent::insertTrack(int index, DeckGUI* deck) {
+    auto file = library.getFile(index);
+    if (! file.existsAsFile()) {
+        std::cout << "File not found for track " << index << ": " << file.getFullPathName() << std::endl;
+        return;
+    }
+
+    if (deck == nullptr)
+        deck = deckGUI1->isEmpty() ? deckGUI1 : deckGUI2->isEmpty() ? deckGUI2 : nullptr;
+
+    if (deck == nullptr || ! deck->isEmpty()) {
+        std::cout << "Deck is occupied. Please stop a deck before loading a new track." << std::endl;
+        return;
+    }
+
+    deck->loadURL(URL{file});
+    deck->start();
+    library.markPlayed(index);
+    std::cout << "Loaded and playing file in Deck " << (deck == deckGUI1 ? 1 : 2) << ": " << file.getFullPathName() << std::endl;
+}
+
+void PlaylistComponent::changeListenerCallback(ChangeBroadcaster* source) {
+    if (source == &library) {
+        searchIndexStale = true; // Rebuilt now if a search is showing, otherwise when the user next searches
+
+        // The first index is built as soon as the library has loaded, so the first search doesn't wait for it
+        if (searchIndexGeneration == 0 && ! library.isLoading())
+            rebuildSearchIndex();
+
+        if (filtering)
+            applySearch(false);
+        else
+            updateView();
+    } else if (source == &scanner || source == &analysisQueue) {
+        updateScanStatus();
+    }
+}
+
+void PlaylistComponent::updateScanStatus() {
+    if (scanner.isScanning()) {
+        importButton.setButtonText("CANCEL IMPORT");
+        scanStatus.setText("Scanning " + String(scanner.getNumProcessed()) + " / " + String(scanner.getNumFound()), dontSendNotification);
+    } else {
+        importButton.setButtonText("IMPORT FOLDER");
+        auto stats = analysisQueue.getStats();
+        if (stats.queued + stats.running > 0)
+            scanStatus.setText("Analysing " + String(stats.queued + stats.running) + " (" + String(stats.tracksPerSecond, 1) + "/s)", dontSendNotification);
+        else
+            scanStatus.setText(scanner.getNumFound() > 0 ? "Imported " + String(scanner.getNumAdded()) + " tracks" : String(), dontSendNotification);
+    }
+}
+
+void PlaylistComponent::selectedRowsChanged(int lastRowSelected) {
+    pendingSelection = -1; // The user (or the restore) has chosen
+    pendingScrollY = -1;
+    int index = libraryIndexForRow(lastRowSelected);
+    if (index >= 0)
+        analysisQueue.requestTrack(index, AnalysisQueue::Priority::selected);
+}
+
+void PlaylistComponent::listWasScrolled() {
+    requestVisibleRows();
+}
+
+// Only the rows inside the viewport are requested, so scrolling through a big library stays cheap
+void PlaylistComponent::requestVisibleRows() {
+    auto* viewport = tableComponent.getViewport();
+    int rowHeight = tableComponent.getRowHeight();
+    if (viewport == nullptr || rowHeight <= 0)
+        return;
+
+    int firstRow = viewport->getViewPositionY() / rowHeight;
+    int lastRow = jmin(getNumRows(), (viewport->getViewPositionY() + viewport->getViewHeight()) / rowHeight + 1);
+    for (int row = firstRow; row < lastRow; ++row) {
+        int index = libraryIndexForRow(row);
+        if (index >= 0)
+            analysisQueue.requestTrack(index, AnalysisQueue::Priority::visible);
+    }
+}
+
+// Only the file headers are read here, so adding a handful of files stays quick
+void PlaylistComponent::addFiles(const Array<File>& files) {
+    for (auto& file : files) {
+        TrackInfo info;
+        if (TrackLibrary::readTrackInfo(formatManager, file, info))
+            library.addTrack(info);
+        else
+            std::cout << "Could not read " << file.getFullPathName() << std::endl;
+    }
+}
+
+// Small libraries are indexed immediately. Large ones are indexed from a copy of the library on
+// a background thread; the current index stays in use until the new one is ready.
+void PlaylistComponent::rebuildSearchIndex() {
+    searchIndexStale = false;
+    int generation = ++searchIndexGeneration;
+
+    if (library.getNumTracks() < backgroundIndexThreshold) {
+        searchIndex = std::make_shared<const LibrarySearchIndex>(library.getRecords(), library.getStringBlob());
+        return;
+    }
+
+    indexBuilder.removeAllJobs(false, 0); // Queued builds are out of date
+    indexBuilder.addJob([records = library.getRecords(), strings = library.getStringBlob(), generation,
+                         safeThis = Component::SafePointer<PlaylistComponent>(this)]() mutable {
+        LibrarySearchIndex::Ptr index = std::make_shared<const LibrarySearchIndex>(std::move(records), strings);
+        MessageManager::callAsync([safeThis, index, generation] {
+            if (safeThis != nullptr && safeThis->searchIndexGeneration == generation) {
+                safeThis->searchIndex = index;
+                safeThis->applySearch(false);
+            }
+        });
+    });
+}
+
+// While the user keeps typing, each query usually narrows the last one, so only the rows already
+// shown need checking again
+void PlaylistComponent::applySearch(bool allowNarrowing) {
+    auto query = LibraryQuery::parse(searchBox.getText());
+
+    if (query.isEmpty()) {
+        filtering = false;
+        filteredRows.clear();
+    } else {
+        if (searchIndexStale)
+            rebuildSearchIndex();
+
+        if (searchIndex != nullptr) {
+            bool narrowing = allowNarrowing && filtering && query.narrows(lastQuery);
+            filteredRows = searchIndex->search(query, narrowing ? &filteredRows : nullptr);
+        }
+        filtering = true;
+    }
+
+    lastQuery = query;
+    updateView();
+}
+
+int PlaylistComponent::libraryIndexForRow(int rowNumber) const {
+    if (rowNumber < 0)
+        return -1;
+    if (filtering || sortColumn != 0)
+        return rowNumber < (int) viewRows.size() ? viewRows[(size_t) rowNumber] : -1;
+    return rowNumber < library.getNumTracks() ? rowNumber : -1;
+}
+
+void PlaylistComponent::sortOrderChanged(int newSortColumnId, bool isForwards) {
+    sortColumn = newSortColumnId;
+    sortForwards = isForwards;
+    updateView();
+}
+
+// Walks the cached permutation for the sort column, keeping only filtered tracks, so neither
+// sorting nor filtering ever re-sorts the rows shown
+void PlaylistComponent::updateView() {
+    viewRows.clear();
+
+    if (sortColumn == 0) {
+        if (filtering)
+            viewRows = filteredRows;
+    } else {
+        const auto& sort = getSortOrder(sortColumn);
+        const auto& order = sort.order;
+        std::vector<char> shown;
+        if (filtering) {
+            shown.assign(order.size(), 0);
+            for (int index : filteredRows)
+                if (index < (int) shown.size())
+                    shown[(size_t) index] = 1;
+        }
+
+        viewRows.reserve(filtering ? filteredRows.size() : order.size());
+        auto keep = [&](int index) {
+            if (! filtering || shown[(size_t) index])
+                viewRows.push_back(index);
+        };
+        // Tracks without a value stay at the end in both directions
+        auto unsortedBegin = order.begin() + sort.numWithValue;
+        if (sortForwards)
+            std::for_each(order.begin(), unsortedBegin, keep);
+        else
+            std::for_each(std::make_reverse_iterator(unsortedBegin), order.rend(), keep);
+        std::for_each(unsortedBegin, order.end(), keep);
+    }
+
+    tableComponent.updateContent();
+
+    // Applied while the view has rows, so an offset restored behind a library load isn't clamped to nothing
+    if (pendingScrollY >= 0 && ! viewRows.empty())
+        if (auto* viewport = tableComponent.getViewport())
+            viewport->setViewPosition(0, pendingScrollY);
+
+    if (pendingSelection >= 0) {
+        int row = -1;
+        if (filtering || sortColumn != 0) {
+            auto it = std::find(viewRows.begin(), viewRows.end(), pendingSelection);
+            row = it != viewRows.end() ? (int) (it - viewRows.begin()) : -1;
+        } else if (pendingSelection < library.getNumTracks()) {
+            row = pendingSelection;
+        }
+
+        if (row >= 0)
+            tableComponent.selectRow(row, true);
+    }
+    if (pendingSelection < 0 && ! viewRows.empty())
+        pendingScrollY = -1; // Restore finished
+
+    tableComponent.repaint();
+    requestVisibleRows();
+}
+
+LibraryViewState PlaylistComponent::getViewState() const {
+    LibraryViewState state;
+    state.searchText = searchBox.getText();
+    state.sortColumn = sortColumn;
+    state.sortForwards = sortForwards;
+
+    int index = libraryIndexForRow(tableComponent.getSelectedRow());
+    if (index >= 0)
+        state.selectedPath = library.getPath(index);
+    if (auto* viewport = tableComponent.getViewport())
+        state.scrollY = viewport->getViewPositionY();
+    return state;
+}
+
+// The selection is matched by path, since library indices aren't part of the snapshot
+void PlaylistComponent::restoreViewState(const LibraryViewState& state) {
+    pendingSelection = state.selectedPath.isNotEmpty() ? library.indexOf(File(state.selectedPath)) : -1;
+    pendingScrollY = jmax(0, state.scrollY);
+
+    if (state.sortColumn != 0 && tableComponent.getHeader().getIndexOfColumnId(state.sortColumn, true) >= 0) {
+        sortColumn = state.sortColumn;
+        sortForwards = state.sortForwards;
+        tableComponent.getHeader().setSortColumnId(sortColumn, sortForwards);
+    }
+
+    searchBox.setText(state.searchText, false);
+    applySearch(false); // Ends in updateView, which applies the selection if its row is showing
+}
+
+bool PlaylistComponent::readSortKey(int columnId, int index, double& key, std::string& textKey) const {
+    if (columnId == titleColumn) {
+        auto artist = library.getArtist(index);
+        auto title = library.getTitle(index);
+        textKey = (artist.isEmpty() ? title : artist + " - " + title).toLowerCase().toStdString();
+        return true;
+    }
+
+    const auto& record = library.getRecord(index);
+    if (columnId == bpmColumn && (record.flags & TrackRecord::hasTempo) != 0)
+        key = record.bpm;
+    else if (columnId == keyColumn && (record.flags & TrackRecord::hasKey) != 0)
+        key = TrackLibrary::keyToCamelot(record.key).getIntValue() * 2 + (record.key >= 12 ? 0 : 1); // 1A, 1B, 2A...
+    else if (columnId == durationColumn)
+        key = record.durationSeconds;
+    else if (columnId == loudnessColumn && (record.flags & TrackRecord::hasLoudness) != 0)
+        key = record.loudnessLufs;
+    else if (columnId == lastPlayedColumn && record.lastPlayed > 0)
+        key = (double) record.lastPlayed;
+    else
+        return false;
+    return true;
+}
+
+// Only the tracks whose key changed, or that are new, are sorted; they are then merged into the rest
+// of the cached order. An import flush, a play or a finished analysis costs a linear pass, and nothing
+// at all for columns whose field it didn't touch. Ties are broken by library index, so the patched
+// order is exactly what a full sort would give.
+const PlaylistComponent::SortOrder& PlaylistComponent::getSortOrder(int columnId) {
+    auto& sort = sortOrders[columnId];
+    const bool isText = columnId == titleColumn;
+    const int numTracks = library.getNumTracks();
+    const auto field = columnId == bpmColumn || columnId == keyColumn || columnId == loudnessColumn ? TrackLibrary::Field::analysis
+                     : columnId == lastPlayedColumn ? TrackLibrary::Field::playHistory
+                     : TrackLibrary::Field::metadata;
+    const auto generation = library.getGeneration(field);
+
+    int numKnown = (int) sort.hasValue.size();
+    if (numTracks < numKnown) { // Replaced by a smaller library
+        sort = SortOrder();
+        numKnown = 0;
+    }
+
+    sort.keys.resize((size_t) numTracks, 0.0);
+    sort.hasValue.resize((size_t) numTracks, 0);
+    if (isText)
+        sort.textKeys.resize((size_t) numTracks);
+
+    // Re-reads a track's key; true if it differs from the cached one
+    auto refresh = [&](int index) {
+        double key = 0.0;
+        std::string textKey;
+        bool hasValue = readSortKey(columnId, index, key, textKey);
+        auto i = (size_t) index;
+        bool differs = hasValue != (sort.hasValue[i] != 0) || (isText ? textKey != sort.textKeys[i] : key != sort.keys[i]);
+        sort.hasValue[i] = hasValue ? 1 : 0;
+        sort.keys[i] = key;
+        if (isText)
+            sort.textKeys[i] = std::move(textKey);
+        return differs;
+    };
+
+    std::vector<int> moved; // Ascending
+    if (generation != sort.generation)
+        for (int i = 0; i < numKnown; ++i)
+            if (refresh(i))
+                moved.push_back(i);
+    sort.generation = generation;
+    for (int i = numKnown; i < numTracks; ++i) {
+        refresh(i);
+        moved.push_back(i);
+    }
+
+    if (moved.empty())
+        return sort;
+
+    auto less = [&sort, isText](int a, int b) {
+        auto ia = (size_t) a, ib = (size_t) b;
+        if (isText ? sort.textKeys[ia] != sort.textKeys[ib] : sort.keys[ia] != sort.keys[ib])
+            return isText ? sort.textKeys[ia] < sort.textKeys[ib] : sort.keys[ia] < sort.keys[ib];
+        return a < b;
+    };
+
+    std::vector<char> isMoved((size_t) numTracks, 0);
+    std::vector<int> movedWithValue, movedWithout;
+    for (int index : moved) {
+        isMoved[(size_t) index] = 1;
+        (sort.hasValue[(size_t) index] ? movedWithValue : movedWithout).push_back(index);
+    }
+    std::sort(movedWithValue.begin(), movedWithValue.end(), less);
+
+    std::vector<int> keptWithValue, keptWithout;
+    keptWithValue.reserve((size_t) numTracks);
+    for (size_t position = 0; position < sort.order.size(); ++position) {
+        int index = sort.order[position];
+        if (! isMoved[(size_t) index])
+            ((int) position < sort.numWithValue ? keptWithValue : keptWithout).push_back(index);
+    }
+
+    std::vector<int> order;
+    order.reserve((size_t) numTracks);
+    std::merge(keptWithValue.begin(), keptWithValue.end(), movedWithValue.begin(), movedWithValue.end(), std::back_inserter(order), less);
+    sort.numWithValue = (int) order.size();
+    std::merge(keptWithout.begin(), keptWithout.end(), movedWithout.begin(), movedWithout.end(), std::back_inserter(order));
+    sort.order.swap(order);
+    return sort;
+}
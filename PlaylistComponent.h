@@ -1,56 +1,124 @@
-/*
-  ==============================================================================
-
-    PlaylistComponent.h
-    Created: 10 Mar 2024 9:07:35pm
-    Author:  roscoe liew
-
-  ==============================================================================
-*/
-
-#pragma once
-
-#include <JuceHeader.h>
-#include <vector>
-#include <string>
-#include "DJAudioPlayer.h"
-#include "DeckGUI.h" 
-
-using namespace juce;
-
-// Manages a playlist of tracks and provides a UI for loading and inserting tracks into decks
-class PlaylistComponent  : public juce::Component, public TableListBoxModel, public Button::Listener
-{
-public:
-    PlaylistComponent(DJAudioPlayer* _player, DeckGUI* _deckGUI1, DeckGUI* _deckGUI2); // Initializes the playlist component with pointers to the DJAudioPlayer and two DeckGUIs
-    ~PlaylistComponent() override;
-
-    void paint (juce::Graphics&) override; // Paint method to draw the component
-    void resized() override; // Resized method to layout the component
-    
-    // TableListBoxModel overrides:
-    int getNumRows() override; // Returns the number of rows in the table (number of tracks)
-    void paintRowBackground(Graphics & g, int rowNumber, int width, int height, bool rowIsSelected) override; // Paints the background of a table row
-    void paintCell(Graphics & g, int rowNumber, int columnId, int width, int height, bool rowIsSelected) override; // Paints the content of a table cell
-
-    // Creates or updates a custom component for a table cell
-    Component* refreshComponentForCell(int rowNumber, int columnId, bool isRowSelected, Component *existingComponentToUpdate) override;
-    
-    void buttonClicked(Button * button) override; // Button click event handler
-    
-private:
-    TableListBox tableComponent; // The table component for displaying the playlist
-    std::vector<std::string> trackTitles; // Vector of track titles
-    std::vector<juce::URL> trackFiles; // Vector of track file URLs
-    
-    juce::FileChooser fChooser{"Select a file..."}; // File chooser for loading tracks
-    
-    DJAudioPlayer* player; // Pointer to the DJAudioPlayer
-    
-    DeckGUI* deckGUI1; // Pointer to the first DeckGUI
-    DeckGUI* deckGUI2; // Pointer to the second DeckGUI
-    
-    CustomLookAndFeel customLookAndFeel; // Custom LookAndFeel for styling the playlist
-    
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PlaylistComponent)
-};
+/*
+  ==============================================================================
+
+    PlaylistComponent.h
+    Created: 10 Mar 2024 9:07:35pm
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+#include <string>
+#include <map>
+#include "DJAudioPlayer.h"
+#include "DeckGUI.h" 
+#include "TrackLibrary.h"
+#include "LibraryScanner.h"
+#include "LibraryWatcher.h"
+#include "LibrarySearchIndex.h"
+#include "AnalysisQueue.h"
+#include "SessionState.h"
+
+using namespace juce;
+
+// Shows the persistent track library and provides a UI for adding, loading and inserting tracks into decks
+class PlaylistComponent  : public juce::Component, public TableListBoxModel, public Button::Listener, public ChangeListener
+{
+public:
+    PlaylistComponent(DJAudioPlayer* _player, DeckGUI* _deckGUI1, DeckGUI* _deckGUI2, TrackLibrary& _library, AudioFormatManager& _formatManager, AnalysisQueue& _analysisQueue); // Initializes the playlist component with the player, both decks, the track library and the analysis queue
+    ~PlaylistComponent() override;
+
+    void paint (juce::Graphics&) override; // Paint method to draw the component
+    void resized() override; // Resized method to layout the component
+    
+    // TableListBoxModel overrides:
+    int getNumRows() override; // Returns the number of rows in the table (number of tracks)
+    void paintRowBackground(Graphics & g, int rowNumber, int width, int height, bool rowIsSelected) override; // Paints the background of a table row
+    void paintCell(Graphics & g, int rowNumber, int columnId, int width, int height, bool rowIsSelected) override; // Paints the content of a table cell
+
+    void cellClicked(int rowNumber, int columnId, const MouseEvent& event) override; // Runs the Insert or Load action of the clicked cell
+    void cellDoubleClicked(int rowNumber, int columnId, const MouseEvent& event) override; // Double-clicking a title inserts the track
+    void returnKeyPressed(int lastRowSelected) override; // Return inserts the selected track
+    void sortOrderChanged(int newSortColumnId, bool isForwards) override; // Reorders the rows by the clicked column
+    void selectedRowsChanged(int lastRowSelected) override; // Analyses the selected track next
+    void listWasScrolled() override; // Analyses the rows that scrolled into view
+    
+    bool keyPressed(const KeyPress& key) override; // 1 and 2 load the selected track into that deck, L relinks it
+    void buttonClicked(Button * button) override; // Button click event handler
+    void changeListenerCallback(ChangeBroadcaster* source) override; // Refreshes the table when the library changes, and the status on scan or analysis progress
+
+    LibraryViewState getViewState() const; // Search, sort, selection and scroll, for the session snapshot
+    void restoreViewState(const LibraryViewState& state); // Reapply a saved view; call once the library has loaded
+    
+private:
+    void addFiles(const Array<File>& files); // Reads the headers of the files and adds them to the library
+    void updateScanStatus(); // Shows import or analysis progress and toggles the import button
+    void rebuildSearchIndex(); // Re-indexes the library, in the background when it is large
+    void applySearch(bool allowNarrowing); // Filters the rows by the search box text
+    int libraryIndexForRow(int rowNumber) const; // Maps a table row to a library index
+    void requestVisibleRows(); // Moves unanalysed tracks on screen ahead of the rest of the library
+    void updateView(); // Rebuilds viewRows from the filter and sort order, then refreshes the table
+    struct SortOrder;
+    const SortOrder& getSortOrder(int columnId); // Brings a column's cached order up to date with the library
+    bool readSortKey(int columnId, int index, double& key, std::string& textKey) const; // False if the track has no value in the column
+    void insertTrack(int index, DeckGUI* deck); // Loads and starts a track on deck, or on the first empty deck if deck is null
+    void relinkTrack(int index); // Asks for a new file for a library entry
+    void paintActionCell(Graphics& g, const String& text, int width, int height); // Draws a cell styled like the buttons
+
+    enum ColumnIds { titleColumn = 1, insertColumn = 2, loadColumn = 3, bpmColumn = 4, keyColumn = 5,
+                     durationColumn = 6, loudnessColumn = 7, lastPlayedColumn = 8 };
+
+    TableListBox tableComponent; // The table component for displaying the playlist
+    TextButton addButton{"ADD TRACKS"}; // Adds files to the library
+    TextButton importButton{"IMPORT FOLDER"}; // Starts or cancels a folder import
+    Label scanStatus; // Import progress
+    TextEditor searchBox; // Search text and filters
+    
+    TrackLibrary& library; // Persistent track store the rows are read from
+    AudioFormatManager& formatManager; // Used to read track metadata
+    AnalysisQueue& analysisQueue; // Fills in tempo and the other analysed columns
+    LibraryScanner scanner{library, formatManager}; // Background folder import
+    LibraryWatcher watcher{library, scanner, formatManager}; // Keeps imported folders in sync with the disk
+    
+    LibrarySearchIndex::Ptr searchIndex; // Index of the library as of the last rebuild, null until built
+    bool searchIndexStale = true; // True if the library changed since searchIndex was built
+    int searchIndexGeneration = 0; // Identifies the newest requested rebuild
+    LibraryQuery lastQuery; // Query that produced filteredRows
+    bool filtering = false; // True if the table shows filteredRows rather than the whole library
+    std::vector<int> filteredRows; // Library indices shown while filtering, ascending
+    static constexpr int backgroundIndexThreshold = 5000; // Libraries this large are indexed off the message thread
+    ThreadPool indexBuilder{1}; // Runs background index builds
+    
+    // One column's order, patched as tracks change rather than re-sorted
+    struct SortOrder {
+        std::vector<int> order; // Tracks with a value, ascending by key then index, followed by the rest in library order
+        int numWithValue = 0; // Length of the sorted part of order
+        std::vector<double> keys; // Numeric key of each track
+        std::vector<std::string> textKeys; // Key of each track for the title column
+        std::vector<char> hasValue; // Whether each track has a value in the column
+        juce::uint32 generation = 0; // Library generation of the column's field when the keys were read
+    };
+
+    int sortColumn = 0; // Column the rows are sorted by, 0 for library order
+    bool sortForwards = true; // Ascending if true
+    std::map<int, SortOrder> sortOrders; // Column -> cached order, brought up to date when next shown
+    std::vector<int> viewRows; // Library index of each table row when filtering or sorting
+    int pendingSelection = -1; // Restored selection waiting for its row to appear, e.g. behind a background index build
+    int pendingScrollY = -1; // Restored scroll offset, reapplied until pendingSelection resolves; -1 when none
+    
+    juce::FileChooser fChooser{"Select a file..."}; // File chooser for loading tracks
+    juce::FileChooser folderChooser{"Select a folder to import..."}; // Folder chooser for imports
+    
+    DJAudioPlayer* player; // Pointer to the DJAudioPlayer
+    
+    DeckGUI* deckGUI1; // Pointer to the first DeckGUI
+    DeckGUI* deckGUI2; // Pointer to the second DeckGUI
+    
+    CustomLookAndFeel customLookAndFeel; // Custom LookAndFeel for styling the playlist
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PlaylistComponent)
+};
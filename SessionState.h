@@ -0,0 +1,39 @@
+/*
+  ==============================================================================
+
+    SessionState.h
+    Created: 19 Oct 2026 11:52:30pm
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <vector>
+
+// What a deck needs to come back exactly where it was
+struct DeckState {
+    juce::String path; // Full path of the loaded track, empty if the deck was empty
+    double positionSeconds = 0.0; // Playhead
+    double speed = 1.0; // Speed slider
+    double gain = 1.0; // Volume slider
+    bool cued = false; // Sent to the headphone cue
+    std::vector<double> cuePoints; // Cue positions in seconds, ascending
+};
+
+// Playlist view: search, sort, selection and scroll position
+struct LibraryViewState {
+    juce::String searchText;
+    int sortColumn = 0; // 0 for library order
+    bool sortForwards = true;
+    juce::String selectedPath; // Track of the selected row, empty if none
+    int scrollY = 0; // Table scroll offset in pixels
+};
+
+struct SessionState {
+    std::array<DeckState, 2> decks;
+    LibraryViewState library;
+};
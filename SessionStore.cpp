@@ -0,0 +1,151 @@
+/*
+  ==============================================================================
+
+    SessionStore.cpp
+    Created: 19 Oct 2026 11:52:30pm
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#include "SessionStore.h"
+using namespace juce;
+
+SessionStore::SessionStore(const File& _storeFile) : storeFile(_storeFile)
+{
+}
+
+SessionStore::~SessionStore()
+{
+    stopTimer();
+}
+
+File SessionStore::getDefaultFile()
+{
+    return File::getSpecialLocation(File::userApplicationDataDirectory)
+               .getChildFile("OtoDecks")
+               .getChildFile("session.odss");
+}
+
+bool SessionStore::load(SessionState& state) const
+{
+    MemoryBlock data;
+    return storeFile.loadFileAsData(data) && deserialise(data, state);
+}
+
+void SessionStore::startAutosave(std::function<SessionState()> _capture)
+{
+    capture = std::move(_capture);
+    startTimer(autosaveIntervalMs);
+}
+
+void SessionStore::saveNow()
+{
+    if (! capture)
+        return;
+
+    writer.removeAllJobs(false, 2000); // Queued writes are older than this one; a running one is let finish
+    lastSnapshot = serialise(capture());
+    writeSnapshot(storeFile, lastSnapshot);
+}
+
+// A capture is a few hundred bytes, so comparing it with the last one costs less than a redundant write
+void SessionStore::timerCallback()
+{
+    auto snapshot = serialise(capture());
+    if (snapshot == lastSnapshot)
+        return;
+
+    lastSnapshot = snapshot;
+    writer.addJob([file = storeFile, snapshot]()
+    {
+        if (! writeSnapshot(file, snapshot))
+            DBG("SessionStore: failed to save " << file.getFullPathName());
+    });
+}
+
+// Little-endian fields through MemoryOutputStream; strings are null-terminated UTF-8
+MemoryBlock SessionStore::serialise(const SessionState& state)
+{
+    MemoryOutputStream out(512);
+    out.write(magic, sizeof(magic));
+    out.writeInt((int) formatVersion);
+
+    for (auto& deck : state.decks)
+    {
+        out.writeString(deck.path);
+        out.writeDouble(deck.positionSeconds);
+        out.writeDouble(deck.speed);
+        out.writeDouble(deck.gain);
+        out.writeBool(deck.cued);
+        out.writeInt((int) deck.cuePoints.size());
+        for (double cue : deck.cuePoints)
+            out.writeDouble(cue);
+    }
+
+    out.writeString(state.library.searchText);
+    out.writeInt(state.library.sortColumn);
+    out.writeBool(state.library.sortForwards);
+    out.writeString(state.library.selectedPath);
+    out.writeInt(state.library.scrollY);
+
+    return out.getMemoryBlock();
+}
+
+bool SessionStore::deserialise(const MemoryBlock& data, SessionState& state)
+{
+    MemoryInputStream in(data, false);
+
+    char fileMagic[4];
+    if (in.read(fileMagic, sizeof(fileMagic)) != (int) sizeof(fileMagic)
+        || std::memcmp(fileMagic, magic, sizeof(magic)) != 0)
+        return false;
+
+    auto version = (uint32) in.readInt();
+    if (version < 1 || version > formatVersion)
+        return false;
+
+    SessionState read;
+    for (auto& deck : read.decks)
+    {
+        deck.path = in.readString();
+        deck.positionSeconds = in.readDouble();
+        deck.speed = in.readDouble();
+        deck.gain = in.readDouble();
+        deck.cued = version >= 2 && in.readBool(); // Sessions from before cue toggles were saved come back uncued
+
+        int numCues = in.readInt();
+        if (numCues < 0 || numCues > maxCuePoints)
+            return false;
+        for (int i = 0; i < numCues; ++i)
+            deck.cuePoints.push_back(in.readDouble());
+    }
+
+    read.library.searchText = in.readString();
+    read.library.sortColumn = in.readInt();
+    read.library.sortForwards = in.readBool();
+    read.library.selectedPath = in.readString();
+    read.library.scrollY = in.readInt();
+
+    // Every field is present exactly once, so a clean file ends right here
+    if (in.getPosition() != in.getTotalLength())
+        return false;
+
+    state = std::move(read);
+    return true;
+}
+
+// Written beside the file and swapped in, so a crash mid-write leaves the previous session intact
+bool SessionStore::writeSnapshot(const File& file, const MemoryBlock& snapshot)
+{
+    file.getParentDirectory().createDirectory();
+
+    TemporaryFile temp(file);
+    {
+        FileOutputStream out(temp.getFile());
+        if (! out.openedOk() || ! out.write(snapshot.getData(), snapshot.getSize()))
+            return false;
+        out.flush();
+    }
+    return temp.overwriteTargetFileWithTemporary();
+}
@@ -0,0 +1,52 @@
+/*
+  ==============================================================================
+
+    SessionStore.h
+    Created: 19 Oct 2026 11:52:30pm
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SessionState.h"
+#include <functional>
+
+// SessionStore class: Keeps the session in a small binary file so a restart, or a crash, comes back
+// to the same decks and view. While autosaving it captures the session on the message thread once a
+// second and, only if the bytes changed, writes them on a background thread. Message thread only.
+class SessionStore : private juce::Timer {
+public:
+    explicit SessionStore(const juce::File& storeFile = getDefaultFile());
+    ~SessionStore() override; // Stops autosaving; call saveNow() first to keep the final state
+
+    static juce::File getDefaultFile(); // <user app data>/OtoDecks/session.odss
+
+    bool load(SessionState& state) const; // False if there is no session or it is unreadable
+
+    // Starts capturing the session through capture; call only after restoring, or the restored
+    // session would be overwritten by the empty one the app starts with
+    void startAutosave(std::function<SessionState()> capture);
+    void saveNow(); // Capture and write on the calling thread, e.g. at shutdown while everything captured still exists
+
+private:
+    void timerCallback() override; // Capture and queue a write if anything changed
+
+    static juce::MemoryBlock serialise(const SessionState& state);
+    static bool deserialise(const juce::MemoryBlock& data, SessionState& state);
+    static bool writeSnapshot(const juce::File& file, const juce::MemoryBlock& snapshot); // Replace the file atomically
+
+    static constexpr char magic[4] = { 'O', 'D', 'S', 'S' }; // File signature
+    static constexpr juce::uint32 formatVersion = 2; // Bumped on any layout change; 2 added the cue toggles
+    static constexpr int autosaveIntervalMs = 1000; // How stale a session can be after a crash
+    static constexpr int maxCuePoints = 256; // Sanity limit when reading
+
+    juce::File storeFile; // Where the session lives
+    std::function<SessionState()> capture; // Builds the current session, set by startAutosave
+    juce::MemoryBlock lastSnapshot; // Bytes most recently queued for writing
+    juce::ThreadPool writer { 1 }; // Single background thread for saves, so writes stay ordered
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SessionStore)
+};
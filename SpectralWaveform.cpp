@@ -0,0 +1,231 @@
+/*
+  ==============================================================================
+
+    SpectralWaveform.cpp
+    Created: 19 Oct 2026 9:02:11am
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#include "SpectralWaveform.h"
+#include "WaveformCache.h"
+#include "Trace.h"
+using namespace juce;
+
+namespace
+{
+    constexpr int binsPerChunk = 2048; // Bins analysed by each pool job (about 24 s at 44.1 kHz)
+    constexpr int binsPerBlock = 16; // Bins read from the file per reader call
+    constexpr int preRollSamples = 8192; // Samples read before each chunk to settle the filters
+
+    // Shared between the chunk jobs of one analysis; the caller waits until the last one has finished
+    struct AnalysisState
+    {
+        AudioFormatManager& formatManager;
+        File file;
+        const std::atomic<bool>& abort;
+        double sampleRate = 0.0;
+        int64 lengthInSamples = 0;
+        std::vector<WaveformBin> bins;
+        std::atomic<int> chunksRemaining { 0 };
+        std::atomic<bool> failed { false };
+        WaitableEvent finished;
+
+        AnalysisState(AudioFormatManager& fm, const File& f, const std::atomic<bool>& a) : formatManager(fm), file(f), abort(a) {}
+    };
+
+    float rms(const float* data, int numSamples)
+    {
+        float sum = 0.0f;
+        for (int i = 0; i < numSamples; ++i)
+            sum += data[i] * data[i];
+        return std::sqrt(sum / (float) numSamples);
+    }
+
+    // Runs the filter bank over one chunk of the file with its own reader, writing raw band RMS values
+    void analyseChunk(AnalysisState& state, int chunkIndex)
+    {
+        OTO_TRACE_SCOPE("Waveform chunk");
+
+        std::unique_ptr<AudioFormatReader> reader(state.formatManager.createReaderFor(state.file));
+        if (reader == nullptr)
+        {
+            state.failed = true;
+            return;
+        }
+
+        const int spb = SpectralWaveform::samplesPerBin;
+        const int firstBin = chunkIndex * binsPerChunk;
+        const int lastBin = jmin(firstBin + binsPerChunk, (int) state.bins.size());
+        const int64 chunkStart = (int64) firstBin * spb;
+        const int64 chunkEnd = jmin(state.lengthInSamples, (int64) lastBin * spb);
+        const int numChannels = jmin(2, (int) reader->numChannels);
+        const int blockSize = spb * binsPerBlock;
+
+        IIRFilter lowPass, midHighPass, midLowPass, highPass;
+        lowPass.setCoefficients(IIRCoefficients::makeLowPass(state.sampleRate, SpectralWaveform::lowCrossoverHz));
+        midHighPass.setCoefficients(IIRCoefficients::makeHighPass(state.sampleRate, SpectralWaveform::lowCrossoverHz));
+        midLowPass.setCoefficients(IIRCoefficients::makeLowPass(state.sampleRate, SpectralWaveform::highCrossoverHz));
+        highPass.setCoefficients(IIRCoefficients::makeHighPass(state.sampleRate, SpectralWaveform::highCrossoverHz));
+
+        AudioBuffer<float> buffer(numChannels, blockSize);
+        AudioBuffer<float> bands(4, blockSize); // mono, low, mid, high
+
+        int64 pos = jmax((int64) 0, chunkStart - preRollSamples);
+        while (pos < chunkEnd)
+        {
+            if (state.abort.load())
+                return;
+
+            // Stop the pre-roll exactly at the chunk start so later blocks stay bin-aligned
+            int64 blockEnd = pos < chunkStart ? chunkStart : jmin(chunkEnd, pos + blockSize);
+            int num = (int) (blockEnd - pos);
+
+            reader->read(&buffer, 0, num, pos, true, true);
+
+            auto* mono = bands.getWritePointer(0);
+            FloatVectorOperations::copy(mono, buffer.getReadPointer(0), num);
+            if (numChannels > 1)
+            {
+                FloatVectorOperations::add(mono, buffer.getReadPointer(1), num);
+                FloatVectorOperations::multiply(mono, 0.5f, num);
+            }
+
+            auto* low = bands.getWritePointer(1);
+            auto* mid = bands.getWritePointer(2);
+            auto* high = bands.getWritePointer(3);
+            FloatVectorOperations::copy(low, mono, num);
+            FloatVectorOperations::copy(mid, mono, num);
+            FloatVectorOperations::copy(high, mono, num);
+            lowPass.processSamples(low, num);
+            midHighPass.processSamples(mid, num);
+            midLowPass.processSamples(mid, num);
+            highPass.processSamples(high, num);
+
+            if (pos >= chunkStart)
+            {
+                for (int offset = 0; offset < num; offset += spb)
+                {
+                    int n = jmin(spb, num - offset);
+                    auto& bin = state.bins[(size_t) ((pos + offset) / spb)];
+                    auto range = FloatVectorOperations::findMinAndMax(mono + offset, n);
+                    bin.peak = jmax(std::abs(range.getStart()), std::abs(range.getEnd()));
+                    bin.low = rms(low + offset, n);
+                    bin.mid = rms(mid + offset, n);
+                    bin.high = rms(high + offset, n);
+                }
+            }
+            pos = blockEnd;
+        }
+    }
+
+    // Scales every band to its loudest bin so colours compare across tracks, then estimates the beat grid
+    SpectralWaveform::Ptr finishAnalysis(AnalysisState& state)
+    {
+        if (state.failed || state.abort.load())
+            return nullptr;
+
+        WaveformBin maxima;
+        for (auto& bin : state.bins)
+        {
+            maxima.peak = jmax(maxima.peak, bin.peak);
+            maxima.low = jmax(maxima.low, bin.low);
+            maxima.mid = jmax(maxima.mid, bin.mid);
+            maxima.high = jmax(maxima.high, bin.high);
+        }
+
+        auto inverse = [](float v) { return v > 0.0f ? 1.0f / v : 0.0f; };
+        float peakScale = maxima.peak > 1.0f ? inverse(maxima.peak) : 1.0f; // Only scale clipped tracks down
+        float lowScale = inverse(maxima.low), midScale = inverse(maxima.mid), highScale = inverse(maxima.high);
+
+        for (auto& bin : state.bins)
+        {
+            bin.peak *= peakScale;
+            bin.low *= lowScale;
+            bin.mid *= midScale;
+            bin.high *= highScale;
+        }
+
+        double lengthInSeconds = state.lengthInSamples / state.sampleRate;
+        auto grid = BeatGrid::estimate(state.bins, state.sampleRate / SpectralWaveform::samplesPerBin, lengthInSeconds);
+        return std::make_shared<const SpectralWaveform>(std::move(state.bins), std::move(grid), state.sampleRate, lengthInSeconds);
+    }
+}
+
+// Constructor: Takes ownership of finished, normalised bins and their beat grid
+SpectralWaveform::SpectralWaveform(std::vector<WaveformBin> _bins, BeatGrid _beatGrid, double sourceSampleRate, double _lengthInSeconds)
+: bins(std::move(_bins)), beatGrid(std::move(_beatGrid)), binsPerSecond(sourceSampleRate / samplesPerBin), lengthInSeconds(_lengthInSeconds)
+{
+}
+
+// Returns the per-field maximum over a bin range, clamped to the track
+WaveformBin SpectralWaveform::getRange(int startBin, int endBin) const
+{
+    WaveformBin result;
+    startBin = jmax(0, startBin);
+    endBin = jmin(endBin, getNumBins());
+
+    for (int i = startBin; i < endBin; ++i)
+    {
+        const auto& bin = bins[(size_t) i];
+        result.peak = jmax(result.peak, bin.peak);
+        result.low = jmax(result.low, bin.low);
+        result.mid = jmax(result.mid, bin.mid);
+        result.high = jmax(result.high, bin.high);
+    }
+    return result;
+}
+
+// Checks the cache, then splits the file into chunks. Each chunk opens its own reader and pre-rolls
+// its filters, so chunks are independent and can run on any thread in any order.
+SpectralWaveform::Ptr SpectralWaveform::analyse(AudioFormatManager& formatManager,
+                                                const File& file,
+                                                ThreadPool* pool,
+                                                const std::atomic<bool>& abort)
+{
+    if (abort.load())
+        return nullptr;
+
+    if (auto cached = WaveformCache::load(file))
+        return cached;
+
+    AnalysisState state(formatManager, file, abort);
+    {
+        std::unique_ptr<AudioFormatReader> reader(formatManager.createReaderFor(file));
+        if (reader == nullptr || reader->sampleRate <= 0.0 || reader->lengthInSamples <= 0)
+            return nullptr;
+
+        state.sampleRate = reader->sampleRate;
+        state.lengthInSamples = reader->lengthInSamples;
+    }
+    state.bins.resize((size_t) ((state.lengthInSamples + samplesPerBin - 1) / samplesPerBin));
+
+    const int numChunks = ((int) state.bins.size() + binsPerChunk - 1) / binsPerChunk;
+
+    if (pool != nullptr)
+    {
+        // Every job is waited for, even after an abort, since they all point at state
+        state.chunksRemaining = numChunks;
+        for (int chunk = 0; chunk < numChunks; ++chunk)
+        {
+            pool->addJob([&state, chunk]()
+            {
+                analyseChunk(state, chunk);
+                if (--state.chunksRemaining == 0)
+                    state.finished.signal();
+            });
+        }
+        state.finished.wait();
+    }
+    else
+    {
+        for (int chunk = 0; chunk < numChunks && ! abort.load(); ++chunk)
+            analyseChunk(state, chunk);
+    }
+
+    auto result = finishAnalysis(state);
+    if (result != nullptr)
+        WaveformCache::store(file, *result);
+    return result;
+}
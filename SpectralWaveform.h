@@ -0,0 +1,68 @@
+/*
+  ==============================================================================
+
+    SpectralWaveform.h
+    Created: 19 Oct 2026 9:02:11am
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "BeatGrid.h"
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// One column of the coloured waveform: peak amplitude plus normalised low/mid/high band energy
+struct WaveformBin {
+    float peak = 0.0f; // Peak absolute amplitude of the mono mix (0 to 1)
+    float low = 0.0f;  // Energy below the low crossover, normalised to the loudest low bin
+    float mid = 0.0f;  // Energy between the crossovers, normalised to the loudest mid bin
+    float high = 0.0f; // Energy above the high crossover, normalised to the loudest high bin
+};
+
+// SpectralWaveform class: Immutable per-track band waveform, computed once per track by a chunked
+// filter-bank pass, optionally spread across a thread pool. Drawing code only reads the bins.
+class SpectralWaveform {
+public:
+    static constexpr int samplesPerBin = 512; // Source samples summarised by each bin
+    static constexpr float lowCrossoverHz = 200.0f; // Upper edge of the low band
+    static constexpr float highCrossoverHz = 2000.0f; // Lower edge of the high band
+
+    SpectralWaveform(std::vector<WaveformBin> bins, BeatGrid beatGrid, double sourceSampleRate, double lengthInSeconds);
+
+    int getNumBins() const { return (int) bins.size(); } // Number of bins covering the track
+    const WaveformBin* getBins() const { return bins.data(); } // Raw bin data for renderers
+    double getBinsPerSecond() const { return binsPerSecond; } // Bins per second of audio
+    double getLengthInSeconds() const { return lengthInSeconds; } // Length of the analysed track
+    const BeatGrid& getBeatGrid() const { return beatGrid; } // Beat grid estimated from the bins
+
+    // Returns the maximum of the bins covering [startBin, endBin), or an empty bin if out of range
+    WaveformBin getRange(int startBin, int endBin) const;
+
+    using Ptr = std::shared_ptr<const SpectralWaveform>;
+
+    // Analyses a local audio file, or loads it from the WaveformCache if the file is unchanged, and
+    // blocks until done. With a pool the chunks are spread across its threads while the caller waits;
+    // without one they run on the calling thread. Returns nullptr if the file could not be read or
+    // the abort flag was raised. Must not be called from a thread of the pool passed in.
+    static Ptr analyse(juce::AudioFormatManager& formatManager,
+                       const juce::File& file,
+                       juce::ThreadPool* pool,
+                       const std::atomic<bool>& abort);
+
+private:
+    std::vector<WaveformBin> bins; // Render-ready bins, one per samplesPerBin source samples
+    BeatGrid beatGrid; // Beats and downbeats, computed alongside the bins
+    double binsPerSecond = 0.0; // Source sample rate divided by samplesPerBin
+    double lengthInSeconds = 0.0; // Track length in seconds
+};
+
+// Shared pool for deck-load waveform chunks; use via juce::SharedResourcePointer
+class WaveformThreadPool : public juce::ThreadPool {
+public:
+    WaveformThreadPool() : juce::ThreadPool(juce::jmax(1, juce::SystemStats::getNumCpus() - 1)) {}
+};
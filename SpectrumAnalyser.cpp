@@ -0,0 +1,168 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyser.cpp
+    Created: 19 Oct 2026 1:36:40pm
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#include "SpectrumAnalyser.h"
+using namespace juce;
+
+// Constructor: Starts the low-priority worker that does all FFT work
+SpectrumAnalyser::SpectrumAnalyser() : Thread("Spectrum analyser")
+{
+    startThread(Thread::Priority::low);
+}
+
+SpectrumAnalyser::~SpectrumAnalyser()
+{
+    stopThread(1000);
+}
+
+void SpectrumAnalyser::prepare(double sampleRate)
+{
+    incomingSampleRate = sampleRate; // Picked up by the worker before its next hop
+}
+
+// Mixes the block down to mono straight into the FIFO; never locks, blocks or allocates. The worker
+// isn't signalled: waking a thread takes a mutex, so it polls the FIFO instead.
+void SpectrumAnalyser::pushSamples(const AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    const int numChannels = jmin(2, buffer.getNumChannels());
+    if (numChannels == 0)
+        return;
+
+    const auto scope = fifo.write(numSamples);
+
+    auto copyMono = [&](int fifoStart, int size, int sourceOffset)
+    {
+        if (size <= 0)
+            return;
+
+        auto* dest = fifoBuffer.data() + fifoStart;
+        FloatVectorOperations::copy(dest, buffer.getReadPointer(0, startSample + sourceOffset), size);
+        if (numChannels > 1)
+        {
+            FloatVectorOperations::add(dest, buffer.getReadPointer(1, startSample + sourceOffset), size);
+            FloatVectorOperations::multiply(dest, 0.5f, size);
+        }
+    };
+
+    copyMono(scope.startIndex1, scope.blockSize1, 0);
+    copyMono(scope.startIndex2, scope.blockSize2, scope.blockSize1);
+}
+
+void SpectrumAnalyser::setActivityCallback(std::function<void()> callback)
+{
+    const ScopedLock sl(callbackLock);
+    onBecameActive = std::move(callback);
+}
+
+// Swaps the UI's slot with the shared one if the worker has published since the last read
+bool SpectrumAnalyser::readLatestFrame(SpectrumFrame& dest)
+{
+    if ((sharedIndex.load() & freshBit) == 0)
+        return false;
+
+    frontIndex = sharedIndex.exchange(frontIndex) & ~freshBit;
+    dest = frames[(size_t) frontIndex];
+    return true;
+}
+
+// Worker loop: one FFT per hop of new samples. Between hops it sleeps for pollIntervalMs at a time,
+// well under a hop at any common rate, so frames keep pace without the audio thread waking it.
+void SpectrumAnalyser::run()
+{
+    while (! threadShouldExit())
+    {
+        auto rate = incomingSampleRate.load();
+        if (rate != bandSampleRate)
+            updateBandEdges(rate);
+
+        if (fifo.getNumReady() < hopSize)
+        {
+            wait(pollIntervalMs); // Or until stopThread
+            continue;
+        }
+        processHop();
+    }
+}
+
+// Windows the latest fftSize samples, bins the magnitudes into log bands and publishes the frame
+void SpectrumAnalyser::processHop()
+{
+    // Slide the analysis window on by one hop
+    std::copy(history.begin() + hopSize, history.end(), history.begin());
+    {
+        const auto scope = fifo.read(hopSize);
+        auto* dest = history.data() + (fftSize - hopSize);
+        std::copy_n(fifoBuffer.data() + scope.startIndex1, scope.blockSize1, dest);
+        std::copy_n(fifoBuffer.data() + scope.startIndex2, scope.blockSize2, dest + scope.blockSize1);
+    }
+
+    std::copy(history.begin(), history.end(), fftData.begin());
+    std::fill(fftData.begin() + fftSize, fftData.end(), 0.0f);
+    window.multiplyWithWindowingTable(fftData.data(), (size_t) fftSize);
+    fft.performFrequencyOnlyForwardTransform(fftData.data());
+
+    // A full-scale sine lands at fftSize / 4 after the Hann window's 0.5 coherent gain
+    const float magnitudeToGain = 4.0f / (float) fftSize;
+    bool silent = true;
+
+    for (int band = 0; band < SpectrumFrame::numBands; ++band)
+    {
+        int first = bandEdges[(size_t) band];
+        int last = jmax(first + 1, bandEdges[(size_t) band + 1]);
+
+        float peak = 0.0f;
+        for (int bin = first; bin < last; ++bin)
+            peak = jmax(peak, fftData[(size_t) bin]);
+
+        float db = Decibels::gainToDecibels(peak * magnitudeToGain, floorDb);
+        float level = jmap(db, floorDb, 0.0f, 0.0f, 1.0f);
+
+        // Instant attack, exponential release
+        auto& value = smoothed[(size_t) band];
+        value = jmax(level, value * releasePerHop);
+        if (value > 0.001f)
+            silent = false;
+    }
+
+    if (silent)
+    {
+        if (! active.load())
+            return; // Nothing new to show; let the UI stay idle
+
+        smoothed.fill(0.0f); // Publish one empty frame so displays settle at zero
+    }
+
+    auto& frame = frames[(size_t) backIndex];
+    frame.levels = smoothed;
+    frame.serial = nextSerial++;
+    backIndex = sharedIndex.exchange(backIndex | freshBit) & ~freshBit;
+
+    if (silent)
+        active = false;
+    else if (! active.exchange(true))
+    {
+        const ScopedLock sl(callbackLock);
+        if (onBecameActive != nullptr)
+            onBecameActive();
+    }
+}
+
+// Log-spaced band edges from minFrequency up to Nyquist, as FFT bin indices
+void SpectrumAnalyser::updateBandEdges(double sampleRate)
+{
+    bandSampleRate = sampleRate;
+    const double nyquist = sampleRate * 0.5;
+
+    for (int band = 0; band <= SpectrumFrame::numBands; ++band)
+    {
+        double frequency = minFrequency * std::pow(nyquist / minFrequency, (double) band / SpectrumFrame::numBands);
+        bandEdges[(size_t) band] = jlimit(1, fftSize / 2, roundToInt(frequency * fftSize / sampleRate));
+    }
+}
@@ -0,0 +1,80 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyser.h
+    Created: 19 Oct 2026 1:36:40pm
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <functional>
+
+// One published analyser frame: smoothed band levels from 0 (floor) to 1 (full scale)
+struct SpectrumFrame {
+    static constexpr int numBands = 64; // Log-spaced bands from minFrequency to Nyquist
+    std::array<float, numBands> levels {}; // Smoothed level per band
+    uint32_t serial = 0; // Increments with every published frame
+};
+
+// SpectrumAnalyser class: The audio thread only copies samples into a lock-free FIFO and signals no
+// one. A low-priority worker thread polls the FIFO, runs the windowed FFTs, log-frequency binning and
+// smoothing, then publishes finished frames through a triple buffer the UI can read at any time
+// without locks.
+class SpectrumAnalyser : private juce::Thread {
+public:
+    static constexpr int fftOrder = 11; // 2048-point FFT
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int hopSize = fftSize / 2; // 50% overlap between windows
+    static constexpr float minFrequency = 30.0f; // Lower edge of the first band
+    static constexpr float floorDb = -90.0f; // Level shown as empty
+    static constexpr float releasePerHop = 0.85f; // Per-frame decay factor for falling levels
+    static constexpr int pollIntervalMs = 10; // Worker's sleep while less than a hop is waiting; a hop is 21 ms at 48 kHz
+
+    SpectrumAnalyser(); // Starts the worker thread
+    ~SpectrumAnalyser() override; // Stops the worker thread
+
+    void prepare(double sampleRate); // Set the rate of the incoming samples (any thread)
+    void pushSamples(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples); // Audio thread; never locks or allocates, drops samples if the worker falls behind
+
+    bool readLatestFrame(SpectrumFrame& dest); // UI thread; copies the newest frame if one arrived since the last read
+    bool isActive() const { return active.load(); } // False once the input has been silent and the levels have settled
+    void setActivityCallback(std::function<void()> callback); // Called on the worker thread when signal arrives after silence
+
+private:
+    void run() override; // Worker loop
+    void processHop(); // FFT, binning, smoothing and publishing for one hop
+    void updateBandEdges(double sampleRate); // Recompute the FFT bin range of every band
+
+    juce::AbstractFifo fifo { fftSize * 4 }; // Single-producer/single-consumer index pair for fifoBuffer
+    std::array<float, fftSize * 4> fifoBuffer {}; // Mono samples waiting for the worker
+    std::atomic<double> incomingSampleRate { 44100.0 }; // Rate of the pushed samples
+
+    // Worker-thread state
+    juce::dsp::FFT fft { fftOrder };
+    juce::dsp::WindowingFunction<float> window { (size_t) fftSize, juce::dsp::WindowingFunction<float>::hann };
+    std::array<float, fftSize> history {}; // Last fftSize samples, oldest first
+    std::array<float, fftSize * 2> fftData {}; // In-place FFT workspace
+    std::array<int, SpectrumFrame::numBands + 1> bandEdges {}; // First FFT bin of each band, plus end
+    std::array<float, SpectrumFrame::numBands> smoothed {}; // Levels after smoothing
+    double bandSampleRate = 0.0; // Rate bandEdges was computed for
+    uint32_t nextSerial = 1; // Serial for the next published frame
+
+    // Triple buffer: the worker fills frames[backIndex], then swaps it with the shared slot
+    std::array<SpectrumFrame, 3> frames;
+    int backIndex = 0; // Worker-owned slot
+    int frontIndex = 1; // UI-owned slot
+    std::atomic<int> sharedIndex { 2 }; // Slot in transit; freshBit set when it holds an unread frame
+    static constexpr int freshBit = 4;
+
+    std::atomic<bool> active { false }; // Whether the worker is currently publishing non-silent frames
+    juce::CriticalSection callbackLock; // Guards onBecameActive; only taken on the worker and message threads
+    std::function<void()> onBecameActive; // Activity callback, may be empty
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrumAnalyser)
+};
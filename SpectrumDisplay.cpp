@@ -0,0 +1,124 @@
+/*
+  ==============================================================================
+
+    SpectrumDisplay.cpp
+    Created: 19 Oct 2026 1:36:40pm
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#include "SpectrumDisplay.h"
+#include "Trace.h"
+using namespace juce;
+
+// Constructor: Builds the spectrogram palette and listens for the analyser waking up
+SpectrumDisplay::SpectrumDisplay(SpectrumAnalyser& _analyser, AnimationClock& _animationClock)
+: analyser(_analyser), animationClock(_animationClock)
+{
+    ColourGradient gradient(Colours::black, 0.0f, 0.0f, Colours::yellow, 1.0f, 0.0f, false);
+    gradient.addColour(0.4, Colours::purple);
+    gradient.addColour(0.75, Colours::red);
+    for (size_t i = 0; i < palette.size(); ++i)
+        palette[i] = gradient.getColourAtPosition((double) i / (palette.size() - 1));
+
+    setOpaque(true);
+    animationClock.addClient(this);
+    analyser.setActivityCallback([this] { triggerAsyncUpdate(); });
+}
+
+SpectrumDisplay::~SpectrumDisplay()
+{
+    analyser.setActivityCallback(nullptr); // After this returns the worker can't call us any more
+    cancelPendingUpdate();
+    animationClock.removeClient(this);
+}
+
+// Bars on the left third, spectrogram on the rest
+void SpectrumDisplay::paint(Graphics& g)
+{
+    OTO_TRACE_SCOPE("SpectrumDisplay::paint");
+    g.fillAll(Colours::black);
+
+    auto bars = getBarsArea();
+    float barWidth = bars.getWidth() / (float) SpectrumFrame::numBands;
+    g.setColour(Colours::purple);
+    for (int band = 0; band < SpectrumFrame::numBands; ++band)
+    {
+        float height = frame.levels[(size_t) band] * bars.getHeight();
+        g.fillRect(bars.getX() + band * barWidth, bars.getBottom() - height, jmax(1.0f, barWidth - 1.0f), height);
+    }
+
+    // The spectrogram image is written circularly; draw it in two parts so the newest column is on the right
+    auto area = getSpectrogramArea();
+    if (spectrogram.isValid())
+    {
+        int width = spectrogram.getWidth();
+        int olderWidth = width - nextColumn;
+        g.drawImage(spectrogram, area.getX(), area.getY(), olderWidth, area.getHeight(),
+                    nextColumn, 0, olderWidth, SpectrumFrame::numBands);
+        if (nextColumn > 0)
+            g.drawImage(spectrogram, area.getX() + olderWidth, area.getY(), nextColumn, area.getHeight(),
+                        0, 0, nextColumn, SpectrumFrame::numBands);
+    }
+
+    g.setColour(Colours::red);
+    g.drawRect(getLocalBounds(), 1);
+    g.drawVerticalLine(area.getX() - 1, 0.0f, (float) getHeight());
+}
+
+// Starts a fresh spectrogram at the new width
+void SpectrumDisplay::resized()
+{
+    auto area = getSpectrogramArea();
+    spectrogram = area.getWidth() > 0 ? Image(Image::RGB, area.getWidth(), SpectrumFrame::numBands, true) : Image();
+    nextColumn = 0;
+}
+
+bool SpectrumDisplay::isAnimating() const
+{
+    return analyser.isActive() || showingSignal;
+}
+
+// Only redraws when the worker has actually published something new
+void SpectrumDisplay::animationFrame(double)
+{
+    if (! analyser.readLatestFrame(frame))
+        return;
+
+    showingSignal = std::any_of(frame.levels.begin(), frame.levels.end(), [](float level) { return level > 0.0f; });
+    addSpectrogramColumn();
+    repaint();
+}
+
+void SpectrumDisplay::handleAsyncUpdate()
+{
+    animationClock.wake();
+}
+
+// Low bands at the bottom, high bands at the top
+void SpectrumDisplay::addSpectrogramColumn()
+{
+    if (! spectrogram.isValid())
+        return;
+
+    Image::BitmapData pixels(spectrogram, nextColumn, 0, 1, SpectrumFrame::numBands, Image::BitmapData::writeOnly);
+    for (int band = 0; band < SpectrumFrame::numBands; ++band)
+    {
+        auto index = (size_t) jlimit(0, (int) palette.size() - 1, (int) (frame.levels[(size_t) band] * (palette.size() - 1)));
+        pixels.setPixelColour(0, SpectrumFrame::numBands - 1 - band, palette[index]);
+    }
+    nextColumn = (nextColumn + 1) % spectrogram.getWidth();
+}
+
+Rectangle<int> SpectrumDisplay::getBarsArea() const
+{
+    return getLocalBounds().reduced(1).removeFromLeft(getWidth() / 3);
+}
+
+Rectangle<int> SpectrumDisplay::getSpectrogramArea() const
+{
+    auto area = getLocalBounds().reduced(1);
+    area.removeFromLeft(getWidth() / 3 + 1);
+    return area;
+}
@@ -0,0 +1,49 @@
+/*
+  ==============================================================================
+
+    SpectrumDisplay.h
+    Created: 19 Oct 2026 1:36:40pm
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "SpectrumAnalyser.h"
+#include "AnimationClock.h"
+
+// SpectrumDisplay class: Draws ready-made SpectrumAnalyser frames as bars on the left and a
+// scrolling spectrogram on the right. It does no FFT work and animates only while frames arrive.
+class SpectrumDisplay : public juce::Component,
+                        public AnimationClock::Client,
+                        private juce::AsyncUpdater
+{
+public:
+    SpectrumDisplay(SpectrumAnalyser& analyser, AnimationClock& animationClock);
+    ~SpectrumDisplay() override;
+
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+
+    bool isAnimating() const override; // True while the analyser is publishing frames
+    void animationFrame(double nowMs) override; // Pull the newest frame and add a spectrogram column
+
+private:
+    void handleAsyncUpdate() override; // Wake the frame clock when the analyser becomes active
+    void addSpectrogramColumn(); // Write the current frame into the next spectrogram column
+    juce::Rectangle<int> getBarsArea() const; // Area used for the bar view
+    juce::Rectangle<int> getSpectrogramArea() const; // Area used for the spectrogram
+
+    SpectrumAnalyser& analyser;
+    AnimationClock& animationClock;
+
+    SpectrumFrame frame; // Last frame read from the analyser
+    juce::Image spectrogram; // One column per frame, numBands rows, written circularly
+    int nextColumn = 0; // Spectrogram column the next frame goes into
+    std::array<juce::Colour, 256> palette; // Level to colour lookup for the spectrogram
+    bool showingSignal = false; // True while the last frame read had any non-zero level
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrumDisplay)
+};
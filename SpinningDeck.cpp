@@ -11,16 +11,20 @@
 // WRITTEN THE CODES BELOW PERSONALLY
 
 #include "SpinningDeck.h"
+#include "Trace.h"
 using namespace juce;
 
-// Constructor: Initializes the deck image and sets up the component
+// Constructor: Sets up the component; artwork is loaded per track, never at startup
 SpinningDeck::SpinningDeck() {
-    // Load an image for the deck (not used in this example)
-    deckImage = juce::ImageFileFormat::loadFrom(juce::File("/Users/roscoe/OOP/NewProject/test.jpg"));
+    setOpaque(true); // We fill our whole area, so the parent never needs repainting behind us
 }
 
-// Paint method: Draws the spinning deck with a circular disc and text
+SpinningDeck::~SpinningDeck() {
+}
+
+// Paint method: Clears the background and blits the cached platter at the current angle
 void SpinningDeck::paint(juce::Graphics& g) {
+    OTO_TRACE_SCOPE("SpinningDeck::paint");
     // Clear the background
     g.fillAll(getLookAndFeel().findColour(ResizableWindow::backgroundColourId));
     
@@ -28,61 +32,117 @@ void SpinningDeck::paint(juce::Graphics& g) {
     g.setColour(juce::Colours::red);
     g.drawRect(getLocalBounds(), 1);
 
-    // Calculate the center and radius of the circular disc
-    auto width = getWidth();
-    auto height = getHeight();
-    auto centerX = width * 0.5f;
-    auto centerY = height / 2.0f;
-    auto radius = juce::jmin(width, height) * 0.4f;
+    if (platterImage.isValid()) {
+        auto bounds = getPlatterBounds();
+        auto half = platterImage.getWidth() * 0.5f;
+        g.drawImageTransformed(platterImage,
+                               juce::AffineTransform::translation(-half, -half)
+                                   .scaled(1.0f / platterScale)
+                                   .rotated(rotationAngle)
+                                   .translated(bounds.getCentreX(), bounds.getCentreY()));
+    }
+}
+
+// Re-renders the platter whenever the size changes
+void SpinningDeck::resized() {
+    renderPlatter();
+}
+
+// Draws the disc, artwork, border and "DJ DECK" label once into an image
+void SpinningDeck::renderPlatter() {
+    auto bounds = getPlatterBounds();
+    if (bounds.isEmpty()) {
+        platterImage = {};
+        return;
+    }
 
-    // Apply the rotation transform to the graphics context
-    g.addTransform(juce::AffineTransform::rotation(rotationAngle, centerX, centerY));
+    platterScale = juce::Component::getApproximateScaleFactorForComponent(this);
+    auto size = juce::jmax(1, juce::roundToInt(bounds.getWidth() * platterScale));
+    platterImage = juce::Image(juce::Image::ARGB, size, size, true);
+
+    juce::Graphics g(platterImage);
+    g.addTransform(juce::AffineTransform::scale(platterScale));
+    auto disc = juce::Rectangle<float>(bounds.getWidth(), bounds.getHeight()).reduced(1.0f);
+    auto centre = disc.getCentre();
 
     // Draw the black circular disc
     g.setColour(juce::Colours::black);
-    g.fillEllipse(centerX - radius, centerY - radius, 2 * radius, 2 * radius);
+    g.fillEllipse(disc);
+
+    // Draw the artwork clipped to the centre label
+    if (deckImage.isValid()) {
+        auto label = disc.withSizeKeepingCentre(disc.getWidth() * 0.6f, disc.getHeight() * 0.6f);
+        juce::Graphics::ScopedSaveState state(g);
+        juce::Path clip;
+        clip.addEllipse(label);
+        g.reduceClipRegion(clip);
+        g.drawImage(deckImage, label, juce::RectanglePlacement::fillDestination);
+    }
 
     // Draw a red border around the disc
     g.setColour(juce::Colours::red);
-    g.drawEllipse(centerX - radius, centerY - radius, 2 * radius, 2 * radius, 2.0f);
+    g.drawEllipse(disc, 2.0f);
 
     // Draw the "DJ DECK" text in red on the disc
-    g.setColour(juce::Colours::red);
     g.setFont(juce::Font(20.0f, juce::Font::bold));
-    auto textWidth = g.getCurrentFont().getStringWidth("DJ DECK");
-    g.drawText("DJ DECK", centerX - textWidth / 2, centerY - 10, textWidth, 20, juce::Justification::centred, false);
+    g.drawText("DJ DECK", juce::Rectangle<float>(disc.getWidth(), 20.0f).withCentre(centre), juce::Justification::centred, false);
 }
 
-// Set the rotation angle for the spinning animation
+// The disc is a square centred in the component, 80% of the shorter side
+juce::Rectangle<float> SpinningDeck::getPlatterBounds() const {
+    auto radius = juce::jmin(getWidth(), getHeight()) * 0.4f;
+    return juce::Rectangle<float>(radius * 2.0f, radius * 2.0f).withCentre(getLocalBounds().toFloat().getCentre());
+}
+
+// Set the rotation angle; the deck only calls this while its playhead moves, so the platter turns
+// however the deck was started and stops wherever the audio stops
 void SpinningDeck::setRotationAngle(float angle) {
-    if (isSpinning) {
-        rotationAngle = angle;
-        repaint();
-    }
+    rotationAngle = angle;
+    repaint(getPlatterBounds().getSmallestIntegerContainer().expanded(1));
 }
 
-// Set an image for the deck (not used in this example)
+// Set the artwork for the deck and bake it into the platter
 void SpinningDeck::setImage(const juce::Image& image) {
     deckImage = image;
+    renderPlatter();
     repaint();
 }
 
-// Timer callback: Updates the rotation angle and repaints the component
-void SpinningDeck::timerCallback() {
-    if (isSpinning) {
-        rotationAngle += 0.05f; // Adjust this value to control the speed
-        repaint();
-    }
+// Decodes cover art on the loader pool and hands it back to the message thread
+void SpinningDeck::loadArtworkFor(const juce::File& audioFile) {
+    clearArtwork();
+    auto generation = artworkGeneration;
+
+    loaderPool->addJob([audioFile, generation, safeThis = juce::Component::SafePointer<SpinningDeck>(this)]() {
+        auto artwork = findArtwork(audioFile);
+        juce::MessageManager::callAsync([artwork, generation, safeThis]() {
+            if (safeThis != nullptr && safeThis->artworkGeneration == generation)
+                safeThis->setImage(artwork);
+        });
+    });
 }
 
-// Start or stop the spinning animation
-void SpinningDeck::setSpinning(bool shouldSpin) {
-    isSpinning = shouldSpin;
-    if (isSpinning) {
-        startTimer(40); // Start the timer with an interval of 40 milliseconds
-    } else {
-        stopTimer(); // Stop the timer when not spinning
-        rotationAngle = 0.0f; // Reset the angle when stopping
-        repaint();
+// Drops the artwork and invalidates any load still in flight
+void SpinningDeck::clearArtwork() {
+    ++artworkGeneration;
+    if (deckImage.isValid())
+        setImage({});
+}
+
+// Looks for the usual cover image names in the track's folder
+juce::Image SpinningDeck::findArtwork(const juce::File& audioFile) {
+    auto folder = audioFile.getParentDirectory();
+    juce::StringArray candidates { audioFile.getFileNameWithoutExtension(), "cover", "folder", "front", "artwork" };
+
+    for (auto& name : candidates) {
+        for (auto* extension : { ".jpg", ".jpeg", ".png" }) {
+            auto imageFile = folder.getChildFile(name + extension);
+            if (imageFile.existsAsFile()) {
+                auto image = juce::ImageFileFormat::loadFrom(imageFile);
+                if (image.isValid())
+                    return image;
+            }
+        }
     }
+    return {};
 }
@@ -14,20 +14,38 @@
 
 #include "../JuceLibraryCode/JuceHeader.h"
 
-// SpinningDeck class: A component that represents a spinning deck with a circular disc
-class SpinningDeck : public juce::Component, public juce::Timer {
+// ArtworkThreadPool class: Pool the decks decode cover art on, kept apart from the waveform pool so a
+// newly loaded track's artwork never queues behind its waveform chunks; use via juce::SharedResourcePointer
+class ArtworkThreadPool : public juce::ThreadPool {
+public:
+    ArtworkThreadPool() : juce::ThreadPool(1) {} // Decodes are rare and short; one per deck load
+};
+
+// SpinningDeck class: A component that represents a spinning deck with a circular disc.
+// The platter (disc, label and artwork) is rendered once into an image; each frame is a rotated blit.
+class SpinningDeck : public juce::Component {
 public:
     SpinningDeck(); // Constructor
+    ~SpinningDeck() override; // Destructor
     void paint(juce::Graphics&) override; // Override the paint method to draw the component
-    void setRotationAngle(float angle); // Set the rotation angle for the spinning animation
-    void setImage(const juce::Image& image); // Set an image for the deck (not used in this example)
-    void setSpinning(bool shouldSpin); // Start or stop the spinning animation
-    void timerCallback() override; // Timer callback for updating the rotation angle
+    void resized() override; // Re-render the platter at the new size
+    void setRotationAngle(float angle); // Set the rotation angle, driven by the deck's playhead
+    void setImage(const juce::Image& image); // Set the artwork shown in the centre of the disc
+    void loadArtworkFor(const juce::File& audioFile); // Look for cover art next to the track on a background thread
+    void clearArtwork(); // Remove the artwork and cancel any pending load
 
 private:
-    juce::Image deckImage; // Image for the deck (not used in this example)
+    void renderPlatter(); // Draw disc, artwork, border and label into platterImage
+    juce::Rectangle<float> getPlatterBounds() const; // Area covered by the disc, in component coordinates
+    static juce::Image findArtwork(const juce::File& audioFile); // Blocking search and decode; pool threads only
+
+    juce::Image deckImage; // Artwork for the loaded track, if any
+    juce::Image platterImage; // Pre-rendered platter at physical pixel resolution
+    float platterScale = 1.0f; // Physical pixels per logical pixel used for platterImage
     float rotationAngle = 0.0f; // Current rotation angle of the deck
-    bool isSpinning = false; // Flag to indicate whether the deck is spinning
+
+    juce::SharedResourcePointer<ArtworkThreadPool> loaderPool; // Background pool used for artwork decoding
+    int artworkGeneration = 0; // Bumped on each request so stale loads are dropped
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpinningDeck) // Macro to prevent copying and leaking
 };
@@ -0,0 +1,80 @@
+/*
+  ==============================================================================
+
+    StartupTimer.cpp
+    Created: 19 Oct 2026 11:20:46pm
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#include "StartupTimer.h"
+#include <algorithm>
+using namespace juce;
+
+StartupTimer::State& StartupTimer::getState()
+{
+    static State state;
+    return state;
+}
+
+void StartupTimer::begin()
+{
+    auto& state = getState();
+    const ScopedLock sl(state.lock);
+    state.startMs = Time::getMillisecondCounterHiRes();
+    state.phases.clear();
+    state.reported = false;
+}
+
+double StartupTimer::getElapsedMs()
+{
+    return Time::getMillisecondCounterHiRes() - getState().startMs;
+}
+
+void StartupTimer::mark(const String& phase)
+{
+    auto ms = getElapsedMs();
+    auto thread = MessageManager::existsAndIsCurrentThread() ? String("message")
+                : Thread::getCurrentThread() != nullptr ? Thread::getCurrentThread()->getThreadName()
+                                                        : String("other");
+
+    auto& state = getState();
+    const ScopedLock sl(state.lock);
+    if (! state.reported)
+        state.phases.add({ phase, ms, thread });
+}
+
+// Phases are listed in the order they finished, each with the gap since the previous one
+void StartupTimer::report()
+{
+    auto& state = getState();
+    const ScopedLock sl(state.lock);
+    if (state.reported)
+        return;
+    state.reported = true;
+
+    // Marks from different threads can land in the list slightly out of order
+    std::sort(state.phases.begin(), state.phases.end(), [](const Phase& a, const Phase& b) { return a.ms < b.ms; });
+
+    String text = "Startup timing (ms since launch):\n";
+    double previous = 0.0;
+    for (auto& phase : state.phases)
+    {
+        text << String(phase.ms, 1).paddedLeft(' ', 8) << "  +" << String(phase.ms - previous, 1).paddedRight(' ', 7)
+             << phase.name << " [" << phase.thread << "]\n";
+        previous = phase.ms;
+    }
+
+    for (auto& phase : state.phases)
+    {
+        if (phase.name == "First frame")
+        {
+            text << (phase.ms <= firstFrameBudgetMs ? "First frame within " : "First frame over ")
+                 << String(firstFrameBudgetMs, 0) << " ms budget";
+            break;
+        }
+    }
+
+    Logger::writeToLog(text);
+}
@@ -0,0 +1,42 @@
+/*
+  ==============================================================================
+
+    StartupTimer.h
+    Created: 19 Oct 2026 11:20:46pm
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// StartupTimer class: Startup timing report. Phases are marked as they finish, on whichever thread
+// finished them, in milliseconds since begin(). The report lists every phase and whether the first
+// frame made the interactive budget; it is written to the log once and phases after it are ignored.
+class StartupTimer {
+public:
+    static void begin(); // Start of the clock; call before anything else is constructed
+    static void mark(const juce::String& phase); // Any thread; records the phase as finished now
+    static double getElapsedMs(); // Any thread; time since begin()
+    static void report(); // Message thread; writes the report to the log
+
+    static constexpr double firstFrameBudgetMs = 200.0; // Target for the first interactive frame
+
+private:
+    struct Phase {
+        juce::String name;
+        double ms; // Since begin()
+        juce::String thread; // Where the phase finished
+    };
+
+    struct State {
+        juce::CriticalSection lock; // Guards phases and reported
+        double startMs = 0.0;
+        juce::Array<Phase> phases;
+        bool reported = false;
+    };
+
+    static State& getState();
+};
@@ -0,0 +1,212 @@
+/*
+  ==============================================================================
+
+    Trace.cpp
+    Created: 19 Oct 2026 10:48:19pm
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#include "Trace.h"
+
+#if OTODECKS_TRACING
+
+#include <memory>
+#include <vector>
+using namespace juce;
+
+namespace
+{
+    // Seqlock slot: the writer clears sequence, fills the fields, then stamps sequence with the event's
+    // number. A reader accepts the fields only if the stamp is the one it expects both before and after
+    // reading them. Relaxed atomics cost the writer nothing over plain stores on common hardware.
+    struct Event
+    {
+        enum Type : uint8 { begin, end, counter };
+
+        std::atomic<uint64> sequence { 0 }; // Event number + 1 once written, 0 while being written
+        std::atomic<const char*> name { nullptr };
+        std::atomic<int64> ticks { 0 }; // Time::getHighResolutionTicks()
+        std::atomic<double> value { 0.0 }; // Counter value
+        std::atomic<uint8> type { begin };
+    };
+
+    // Written only by its own thread. The writer fills a slot before publishing it through count.
+    struct ThreadBuffer
+    {
+        int threadId = 0;
+        String threadName;
+        std::unique_ptr<Event[]> events { new Event[(size_t) Trace::eventsPerThread] };
+        std::atomic<uint64> count { 0 }; // Events ever written
+    };
+
+    // Buffers live until exit, so an exported trace can include threads that have finished
+    struct Registry
+    {
+        SpinLock lock; // Guards buffers; taken once per thread and at export
+        std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+        std::atomic<ThreadBuffer*> reserved { nullptr }; // Ring waiting for a real-time thread to claim it
+    };
+
+    Registry& getRegistry()
+    {
+        static Registry registry;
+        return registry;
+    }
+
+    String describeCurrentThread()
+    {
+        if (auto* thread = Thread::getCurrentThread())
+            return thread->getThreadName();
+        if (MessageManager::existsAndIsCurrentThread())
+            return "Message thread";
+        return "Thread " + String::toHexString((pointer_sized_int) Thread::getCurrentThreadId()); // e.g. the audio device callback
+    }
+
+    ThreadBuffer* addBuffer(const String& threadName)
+    {
+        auto created = std::make_unique<ThreadBuffer>();
+        created->threadName = threadName;
+
+        auto& registry = getRegistry();
+        const SpinLock::ScopedLockType sl(registry.lock);
+        created->threadId = (int) registry.buffers.size() + 1;
+        registry.buffers.push_back(std::move(created));
+        return registry.buffers.back().get();
+    }
+
+    thread_local ThreadBuffer* currentBuffer = nullptr;
+
+    // The only allocation a thread makes for tracing, on its first event, unless it claimed a reserved ring
+    ThreadBuffer& getThreadBuffer()
+    {
+        if (currentBuffer == nullptr)
+            currentBuffer = addBuffer(describeCurrentThread());
+        return *currentBuffer;
+    }
+
+    void record(const char* name, Event::Type type, double value)
+    {
+        auto& buffer = getThreadBuffer();
+        auto index = buffer.count.load(std::memory_order_relaxed);
+        auto& event = buffer.events[(size_t) (index % (uint64) Trace::eventsPerThread)];
+
+        event.sequence.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        event.name.store(name, std::memory_order_relaxed);
+        event.ticks.store(Time::getHighResolutionTicks(), std::memory_order_relaxed);
+        event.value.store(value, std::memory_order_relaxed);
+        event.type.store(type, std::memory_order_relaxed);
+        event.sequence.store(index + 1, std::memory_order_release);
+
+        buffer.count.store(index + 1, std::memory_order_release);
+    }
+}
+
+// Keeps one ring ready; a device restart reserves again only once the previous one was claimed
+void Trace::reserveThread(const char* threadName)
+{
+    auto& registry = getRegistry();
+    if (registry.reserved.load() == nullptr)
+        registry.reserved = addBuffer(threadName);
+}
+
+void Trace::claimThread()
+{
+    if (currentBuffer == nullptr)
+        currentBuffer = getRegistry().reserved.exchange(nullptr);
+}
+
+void Trace::beginZone(const char* name)
+{
+    record(name, Event::begin, 0.0);
+}
+
+void Trace::endZone()
+{
+    record(nullptr, Event::end, 0.0);
+}
+
+void Trace::counter(const char* name, double value)
+{
+    record(name, Event::counter, value);
+}
+
+File Trace::getDefaultFile()
+{
+    return File::getSpecialLocation(File::userApplicationDataDirectory)
+               .getChildFile("OtoDecks")
+               .getChildFile("trace.json");
+}
+
+// Threads keep recording during the export, so the oldest slots of a full ring may be overwritten
+// while they're read; those fail the sequence check and are left out
+bool Trace::exportJson(const File& file)
+{
+    file.getParentDirectory().createDirectory();
+    file.deleteFile();
+    FileOutputStream out(file);
+    if (! out.openedOk())
+        return false;
+
+    const double ticksToMicros = 1.0e6 / (double) Time::getHighResolutionTicksPerSecond();
+    bool first = true;
+    auto writeEvent = [&out, &first](const String& json)
+    {
+        out << (first ? "\n" : ",\n") << json;
+        first = false;
+    };
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    // Only the list is copied under the lock, so a thread tracing for the first time isn't held up
+    std::vector<ThreadBuffer*> buffers;
+    {
+        auto& registry = getRegistry();
+        const SpinLock::ScopedLockType sl(registry.lock);
+        for (auto& buffer : registry.buffers)
+            buffers.push_back(buffer.get());
+    }
+
+    for (auto* buffer : buffers)
+    {
+        String tid(buffer->threadId);
+        writeEvent("{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" + tid
+                   + ",\"args\":{\"name\":" + JSON::toString(buffer->threadName) + "}}");
+
+        auto end = buffer->count.load(std::memory_order_acquire);
+        auto start = end > (uint64) eventsPerThread ? end - (uint64) eventsPerThread : (uint64) 0;
+
+        for (auto i = start; i < end; ++i)
+        {
+            auto& slot = buffer->events[(size_t) (i % (uint64) eventsPerThread)];
+            if (slot.sequence.load(std::memory_order_acquire) != i + 1)
+                continue; // Already overwritten
+
+            auto name = slot.name.load(std::memory_order_relaxed);
+            auto ticks = slot.ticks.load(std::memory_order_relaxed);
+            auto value = slot.value.load(std::memory_order_relaxed);
+            auto type = slot.type.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) != i + 1)
+                continue; // Overwritten while it was read
+
+            String ts((double) ticks * ticksToMicros, 3);
+
+            if (type == Event::begin)
+                writeEvent("{\"ph\":\"B\",\"name\":" + JSON::toString(String(name)) + ",\"pid\":1,\"tid\":" + tid + ",\"ts\":" + ts + "}");
+            else if (type == Event::end)
+                writeEvent("{\"ph\":\"E\",\"pid\":1,\"tid\":" + tid + ",\"ts\":" + ts + "}");
+            else
+                writeEvent("{\"ph\":\"C\",\"name\":" + JSON::toString(String(name)) + ",\"pid\":1,\"tid\":" + tid + ",\"ts\":" + ts
+                           + ",\"args\":{\"value\":" + String(value) + "}}");
+        }
+    }
+
+    out << "\n]}\n";
+    out.flush();
+    return out.getStatus().wasOk();
+}
+
+#endif
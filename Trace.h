@@ -0,0 +1,70 @@
+/*
+  ==============================================================================
+
+    Trace.h
+    Created: 19 Oct 2026 10:48:19pm
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Event tracing for profiling across threads, viewable in Perfetto or chrome://tracing.
+// Build with OTODECKS_TRACING=1 to enable it; otherwise the macros expand to nothing and no
+// tracing code is compiled at all.
+//
+//   OTO_TRACE_SCOPE("Audio callback");       // Zone from here to the end of the enclosing scope
+//   OTO_TRACE_COUNTER("Queued tracks", n);   // Sample of a value, drawn as a graph
+//   OTO_TRACE_RESERVE_THREAD("Audio");       // In prepareToPlay: allocate the audio thread's ring up front
+//   OTO_TRACE_CLAIM_THREAD();                // First thing in the audio callback: take that ring over
+//
+// Names must be string literals: only the pointer is recorded.
+
+#if OTODECKS_TRACING
+
+#include <atomic>
+
+// Trace class: Each thread records into its own fixed ring of events, created the first time it
+// traces, so recording never locks and never allocates after that. A real-time thread instead claims
+// a ring reserved for it beforehand, so not even its first event allocates. When a ring wraps, its
+// oldest events are overwritten. Export reads every ring while the threads keep running; each slot
+// carries a sequence stamp, so a slot overwritten mid-read is detected and skipped.
+class Trace {
+public:
+    static void beginZone(const char* name); // Any thread
+    static void endZone(); // Any thread; closes the innermost open zone
+    static void counter(const char* name, double value); // Any thread
+
+    static void reserveThread(const char* threadName); // Any thread but the one it is for; allocates and locks
+    static void claimThread(); // Real-time thread: takes over the reserved ring unless it already has one; never allocates
+
+    // Writes everything recorded so far as Chrome trace JSON. Zones still open are cut off.
+    static bool exportJson(const juce::File& file);
+    static juce::File getDefaultFile(); // <user app data>/OtoDecks/trace.json
+
+    // Opens a zone for the lifetime of the object; use through OTO_TRACE_SCOPE
+    struct Scope {
+        explicit Scope(const char* name) { beginZone(name); }
+        ~Scope() { endZone(); }
+        JUCE_DECLARE_NON_COPYABLE(Scope)
+    };
+
+    static constexpr int eventsPerThread = 1 << 16; // Ring size per thread
+};
+
+#define OTO_TRACE_SCOPE(name) Trace::Scope JUCE_JOIN_MACRO(otoTraceScope_, __LINE__) (name)
+#define OTO_TRACE_COUNTER(name, value) Trace::counter(name, (double) (value))
+#define OTO_TRACE_RESERVE_THREAD(name) Trace::reserveThread(name)
+#define OTO_TRACE_CLAIM_THREAD() Trace::claimThread()
+
+#else
+
+#define OTO_TRACE_SCOPE(name)
+#define OTO_TRACE_COUNTER(name, value)
+#define OTO_TRACE_RESERVE_THREAD(name)
+#define OTO_TRACE_CLAIM_THREAD()
+
+#endif
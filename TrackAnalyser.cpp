@@ -0,0 +1,76 @@
+/*
+  ==============================================================================
+
+    TrackAnalyser.cpp
+    Created: 19 Oct 2026 7:12:40pm
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#include "TrackAnalyser.h"
+#include "KeyDetector.h"
+#include "LoudnessMeter.h"
+#include "Trace.h"
+using namespace juce;
+
+// The file's size and time are taken before reading, so a rewrite during analysis is caught when storing
+TrackAnalysis TrackAnalyser::analyse(AudioFormatManager& formatManager,
+                                     const File& file,
+                                     ThreadPool* pool,
+                                     const std::atomic<bool>& abort,
+                                     const AnalysisResults* known)
+{
+    TrackAnalysis analysis;
+    analysis.file = file;
+    analysis.results.version = version;
+    analysis.results.fileSize = file.getSize();
+    analysis.results.modificationTime = file.getLastModificationTime().toMilliseconds();
+
+    {
+        OTO_TRACE_SCOPE("Spectral waveform");
+        analysis.waveform = SpectralWaveform::analyse(formatManager, file, pool, abort);
+    }
+    if (abort.load())
+        return analysis;
+
+    if (known != nullptr && known->version == version
+        && known->fileSize == analysis.results.fileSize && known->modificationTime == analysis.results.modificationTime)
+    {
+        analysis.results = *known;
+        analysis.completed = true;
+        return analysis;
+    }
+
+    // An unreadable file still counts as analysed, so it isn't retried until it changes
+    if (analysis.waveform != nullptr && ! analysis.waveform->getBeatGrid().isEmpty())
+        analysis.results.bpm = (float) analysis.waveform->getBeatGrid().getBpm();
+
+    // Key and loudness read the file themselves, so they run whether or not the waveform was cached
+    if (analysis.waveform != nullptr)
+    {
+        std::unique_ptr<AudioFormatReader> reader(formatManager.createReaderFor(file));
+        if (reader != nullptr)
+        {
+            OTO_TRACE_SCOPE("Key detection");
+            analysis.results.key = KeyDetector::detect(*reader, abort);
+        }
+        if (abort.load())
+            return analysis;
+
+        LoudnessMeter::Result loudness;
+        {
+            OTO_TRACE_SCOPE("Loudness");
+            loudness = LoudnessMeter::measure(formatManager, file, pool, abort);
+        }
+        if (abort.load())
+            return analysis;
+
+        analysis.results.hasLoudness = loudness.valid;
+        analysis.results.loudnessLufs = loudness.integratedLufs;
+        analysis.results.truePeakDb = loudness.truePeakDb;
+    }
+
+    analysis.completed = true;
+    return analysis;
+}
@@ -0,0 +1,40 @@
+/*
+  ==============================================================================
+
+    TrackAnalyser.h
+    Created: 19 Oct 2026 7:12:40pm
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include "SpectralWaveform.h"
+#include "TrackLibrary.h"
+
+// Everything one analysis pass produces for a track
+struct TrackAnalysis {
+    juce::File file; // The analysed file
+    SpectralWaveform::Ptr waveform; // Band waveform and beat grid, nullptr if the file couldn't be read
+    AnalysisResults results; // Values kept in the library
+    bool completed = false; // False if the pass was aborted before it finished
+};
+
+// TrackAnalyser class: Runs every offline analysis for one file (waveform, beat grid, tempo, key and
+// loudness) on the calling thread. Safe to call from any thread; nothing is shared between calls.
+class TrackAnalyser {
+public:
+    static constexpr int version = 3; // Bumped whenever the results change, so older entries get redone
+
+    // Waveform and loudness chunks go to the pool if one is given, otherwise everything runs on the
+    // calling thread. If known holds current results for this exact file, only the waveform is
+    // fetched (normally from the cache). Returns early with completed == false once abort is raised.
+    static TrackAnalysis analyse(juce::AudioFormatManager& formatManager,
+                                 const juce::File& file,
+                                 juce::ThreadPool* pool,
+                                 const std::atomic<bool>& abort,
+                                 const AnalysisResults* known = nullptr);
+};
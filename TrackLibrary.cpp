@@ -0,0 +1,688 @@
+/*
+  ==============================================================================
+
+    TrackLibrary.cpp
+    Created: 19 Oct 2026 2:58:19pm
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#include "TrackLibrary.h"
+using namespace juce;
+
+namespace
+{
+    // On-disk header, followed (from version 2) by a uint64 folderBytes, then numTracks records,
+    // stringBytes of UTF-8 and folderBytes of newline-separated watched folder paths
+    struct LibraryHeader
+    {
+        char magic[4];
+        uint32 version;
+        uint32 recordSize;
+        uint32 numTracks;
+        uint64 stringBytes;
+    };
+
+    static_assert(std::is_trivially_copyable<TrackRecord>::value, "TrackRecord is written as raw bytes");
+    static_assert(sizeof(TrackRecord) == 96, "TrackRecord must have no implicit padding; its bytes go to disk as they are");
+    static_assert(std::is_trivially_copyable<LibraryHeader>::value, "LibraryHeader is written as raw bytes");
+
+    // Returns the first non-empty metadata value among the keys formats use for the same tag
+    String findTag(const StringPairArray& metadata, std::initializer_list<const char*> keys)
+    {
+        for (auto* key : keys)
+        {
+            auto value = metadata.getValue(key, {}).trim();
+            if (value.isNotEmpty())
+                return value;
+        }
+        return {};
+    }
+}
+
+TrackLibrary::TrackLibrary(const File& _storeFile) : storeFile(_storeFile)
+{
+}
+
+// Destructor: Writes any pending changes before the writer thread goes away
+TrackLibrary::~TrackLibrary()
+{
+    stopTimer();
+
+    // Let queued saves land first so they cannot overwrite the final one. The pool has one thread,
+    // so once this marker runs everything queued before it has finished.
+    auto drained = std::make_shared<WaitableEvent>();
+    writer.addJob([drained] { drained->signal(); });
+    drained->wait(10000);
+
+    // Changes made before a pending load landed are dropped rather than written over the full library
+    if (dirty && ! loading)
+        saveNow();
+}
+
+File TrackLibrary::getDefaultFile()
+{
+    return File::getSpecialLocation(File::userApplicationDataDirectory)
+               .getChildFile("OtoDecks")
+               .getChildFile("library.odlb");
+}
+
+bool TrackLibrary::load()
+{
+    records.clear();
+    strings.clear();
+    watchedFolders.clear();
+    dirty = false;
+
+    StoreContents contents;
+    readStore(storeFile, contents);
+    bool valid = contents.valid;
+    install(std::move(contents));
+    return valid;
+}
+
+// The read shares the writer thread, so it can never interleave with a save
+void TrackLibrary::loadAsync(std::function<void(bool)> onLoaded)
+{
+    loading = true;
+    writer.addJob([file = storeFile, library = WeakReference<TrackLibrary>(this), onLoaded]()
+    {
+        auto contents = std::make_shared<StoreContents>();
+        readStore(file, *contents);
+
+        MessageManager::callAsync([library, contents, onLoaded]()
+        {
+            if (library == nullptr)
+                return;
+
+            bool valid = contents->valid;
+            library->install(std::move(*contents));
+            if (onLoaded)
+                onLoaded(valid);
+        });
+    });
+}
+
+// Reads the header, then the record array and string blob with one read each
+void TrackLibrary::readStore(const File& file, StoreContents& contents)
+{
+    FileInputStream in(file);
+    if (! in.openedOk())
+        return;
+
+    LibraryHeader header;
+    uint64 folderBytes = 0;
+    bool valid = in.read(&header, sizeof(header)) == (int) sizeof(header)
+                 && std::memcmp(header.magic, magic, sizeof(magic)) == 0
+                 && (header.version == 1 || header.version == formatVersion) // Version 1 files are upgraded on the next save
+                 && header.recordSize == sizeof(TrackRecord);
+
+    if (valid && header.version >= 2)
+        valid = in.read(&folderBytes, sizeof(folderBytes)) == (int) sizeof(folderBytes);
+
+    valid = valid && in.getPosition() + (int64) header.numTracks * header.recordSize
+                     + (int64) header.stringBytes + (int64) folderBytes == in.getTotalLength();
+
+    if (valid)
+    {
+        contents.records.resize(header.numTracks);
+        contents.strings.resize((size_t) header.stringBytes);
+        auto recordBytes = (int) (contents.records.size() * sizeof(TrackRecord));
+        valid = in.read(contents.records.data(), recordBytes) == recordBytes
+                && in.read(contents.strings.data(), (int) contents.strings.size()) == (int) contents.strings.size();
+
+        for (auto& record : contents.records)
+            record.reserved = 0; // Older builds wrote whatever the padding held
+
+        if (valid && folderBytes > 0)
+        {
+            MemoryBlock folders;
+            valid = in.readIntoMemoryBlock(folders, (ssize_t) folderBytes) == (size_t) folderBytes;
+            contents.watchedFolders = StringArray::fromLines(folders.toString());
+            contents.watchedFolders.removeEmptyStrings();
+        }
+    }
+
+    if (! valid)
+    {
+        // Keep the unreadable file for inspection and start with an empty library
+        DBG("TrackLibrary: unreadable library file, starting empty");
+        file.copyFileTo(file.withFileExtension("odlb.bad"));
+        contents = {};
+    }
+    contents.valid = valid;
+}
+
+// Whatever the library held before is what was added while the file was being read
+void TrackLibrary::install(StoreContents&& contents)
+{
+    std::vector<TrackInfo> addedMeanwhile;
+    for (int i = 0; i < getNumTracks(); ++i)
+    {
+        const auto& record = records[(size_t) i];
+        TrackInfo info;
+        info.file = getFile(i);
+        info.title = getTitle(i);
+        info.artist = getArtist(i);
+        info.durationSeconds = record.durationSeconds;
+        info.sampleRate = record.sampleRate;
+        info.numChannels = record.numChannels;
+        info.fileSize = record.fileSize;
+        info.modificationTime = record.modificationTime;
+        addedMeanwhile.push_back(std::move(info));
+    }
+    auto foldersMeanwhile = watchedFolders;
+
+    records = std::move(contents.records);
+    strings = std::move(contents.strings);
+    watchedFolders = std::move(contents.watchedFolders);
+    garbageBytes = 0;
+    loading = false;
+    rebuildPathIndex();
+    for (int field = 0; field < numFields; ++field)
+        touch((Field) field); // Every index may now be a different track
+
+    for (auto& info : addedMeanwhile)
+        insertOrUpdate(info);
+    for (auto& folder : foldersMeanwhile)
+        watchedFolders.addIfNotAlreadyThere(folder);
+
+    // Indices from before the swap mean nothing now, so each edit finds its track again by path
+    auto edits = std::move(deferredEdits);
+    deferredEdits.clear();
+    for (auto& edit : edits)
+    {
+        int index = edit.path.isEmpty() ? -1 : indexOf(File(edit.path));
+        if (edit.path.isEmpty() || index >= 0)
+            edit.apply(*this, index);
+    }
+
+    if (dirty)
+        changed(); // Saves the merged library
+    else
+        sendChangeMessage();
+}
+
+// The records in use while loading are a stand-in for the file being read: edits are made to them so
+// the UI shows them at once, and queued to be made again on the real records
+void TrackLibrary::deferWhileLoading(int index, std::function<void(TrackLibrary&, int)> apply)
+{
+    if (loading)
+        deferredEdits.push_back({ index >= 0 ? getPath(index) : String(), std::move(apply) });
+}
+
+// Snapshots on this thread (a straight memory copy), then writes on the background thread
+void TrackLibrary::saveAsync()
+{
+    compactStrings();
+    auto snapshot = std::make_shared<MemoryBlock>(createSnapshot());
+    dirty = false;
+
+    writer.addJob([file = storeFile, snapshot]()
+    {
+        if (! writeSnapshot(file, *snapshot))
+            DBG("TrackLibrary: failed to save " << file.getFullPathName());
+    });
+}
+
+void TrackLibrary::saveNow()
+{
+    compactStrings();
+    auto snapshot = createSnapshot();
+    dirty = false;
+    writeSnapshot(storeFile, snapshot);
+}
+
+String TrackLibrary::getPath(int index) const
+{
+    const auto& record = records[(size_t) index];
+    return readString(record.pathOffset, record.pathLength);
+}
+
+String TrackLibrary::getTitle(int index) const
+{
+    const auto& record = records[(size_t) index];
+    return readString(record.titleOffset, record.titleLength);
+}
+
+String TrackLibrary::getArtist(int index) const
+{
+    const auto& record = records[(size_t) index];
+    return readString(record.artistOffset, record.artistLength);
+}
+
+// The hash only narrows the search; the stored path decides, so colliding paths stay separate tracks
+int TrackLibrary::indexOf(const File& file) const
+{
+    auto path = file.getFullPathName();
+    auto utf8 = path.toRawUTF8();
+    auto length = std::strlen(utf8);
+
+    auto range = pathIndex.equal_range((uint64) path.hashCode64());
+    for (auto it = range.first; it != range.second; ++it)
+        if (hasPath(it->second, utf8, length))
+            return it->second;
+    return -1;
+}
+
+int TrackLibrary::addTrack(const TrackInfo& info)
+{
+    int index = insertOrUpdate(info);
+    changed();
+    return index;
+}
+
+void TrackLibrary::addTracks(const std::vector<TrackInfo>& infos)
+{
+    if (infos.empty())
+        return;
+
+    records.reserve(records.size() + infos.size());
+    for (auto& info : infos)
+        insertOrUpdate(info);
+    changed();
+}
+
+// Repoints an entry at a (possibly different) file; analysis results no longer apply
+void TrackLibrary::setFile(int index, const TrackInfo& info)
+{
+    deferWhileLoading(index, [info](TrackLibrary& library, int i) { library.setFile(i, info); });
+    auto& record = records[(size_t) index];
+    unindexPath(index);
+    garbageBytes += record.pathLength + record.titleLength + record.artistLength; // Old strings stay in the blob until compacted
+
+    setStrings(record, info);
+    record.durationSeconds = (float) info.durationSeconds;
+    record.sampleRate = (float) info.sampleRate;
+    record.numChannels = info.numChannels;
+    record.fileSize = info.fileSize;
+    record.modificationTime = info.modificationTime;
+    record.flags = 0;
+
+    indexPath(index);
+    touch(Field::metadata);
+    touch(Field::analysis);
+    changed();
+}
+
+void TrackLibrary::markPlayed(int index)
+{
+    auto apply = [when = Time::currentTimeMillis()](TrackLibrary& library, int i)
+    {
+        auto& record = library.records[(size_t) i];
+        record.lastPlayed = when;
+        ++record.playCount;
+        library.touch(Field::playHistory);
+        library.changed();
+    };
+    deferWhileLoading(index, apply);
+    apply(*this, index);
+}
+
+// Camelot wheel: each step round the wheel is a fifth, and C major sits at 8B with its relative minor at 8A
+String TrackLibrary::keyToCamelot(int key)
+{
+    if (key < 0 || key > 23)
+        return {};
+
+    bool minor = key >= 12;
+    int majorPitch = minor ? (key - 12 + 3) % 12 : key; // A minor shares its number with C major
+    int number = (majorPitch * 7 + 7) % 12 + 1;
+    return String(number) + (minor ? "A" : "B");
+}
+
+int TrackLibrary::camelotToKey(const String& camelot)
+{
+    auto text = camelot.trim().toUpperCase();
+    int number = text.getIntValue();
+    auto letter = text.getLastCharacter();
+    if (number < 1 || number > 12 || (letter != 'A' && letter != 'B') || text.length() != String(number).length() + 1)
+        return -1;
+
+    int majorPitch = ((number - 8 + 12) * 7) % 12; // 7 is its own inverse mod 12
+    return letter == 'B' ? majorPitch : 12 + (majorPitch + 9) % 12;
+}
+
+// Unlike setFile, the audio is unchanged, so analysis and play history stay valid
+void TrackLibrary::moveTrack(int index, const File& newFile)
+{
+    deferWhileLoading(index, [newFile](TrackLibrary& library, int i) { library.moveTrack(i, newFile); });
+    auto& record = records[(size_t) index];
+    TrackInfo info;
+    info.file = newFile;
+    info.title = getTitle(index);
+    info.artist = getArtist(index);
+
+    unindexPath(index);
+    garbageBytes += record.pathLength + record.titleLength + record.artistLength;
+    setStrings(record, info);
+    record.flags &= ~(uint32) TrackRecord::missing;
+    indexPath(index);
+    touch(Field::metadata);
+    changed();
+}
+
+void TrackLibrary::setMissing(int index, bool isMissing)
+{
+    deferWhileLoading(index, [isMissing](TrackLibrary& library, int i) { library.setMissing(i, isMissing); });
+    if (applyMissing(index, isMissing))
+        changed();
+}
+
+void TrackLibrary::setMissing(const std::vector<std::pair<int, bool>>& updates)
+{
+    bool anyChanged = false;
+    for (auto& update : updates)
+    {
+        deferWhileLoading(update.first, [isMissing = update.second](TrackLibrary& library, int i) { library.setMissing(i, isMissing); });
+        anyChanged = applyMissing(update.first, update.second) || anyChanged;
+    }
+    if (anyChanged)
+        changed();
+}
+
+bool TrackLibrary::applyMissing(int index, bool isMissing)
+{
+    auto& record = records[(size_t) index];
+    auto flags = isMissing ? (record.flags | TrackRecord::missing) : (record.flags & ~(uint32) TrackRecord::missing);
+    if (flags == record.flags)
+        return false;
+
+    record.flags = flags;
+    return true;
+}
+
+void TrackLibrary::invalidateAnalysis(int index)
+{
+    deferWhileLoading(index, [](TrackLibrary& library, int i) { library.invalidateAnalysis(i); });
+    auto& record = records[(size_t) index];
+    record.flags &= TrackRecord::missing;
+    touch(Field::analysis);
+    changed();
+}
+
+// Results of a file that has been rewritten since would be stale, so they are dropped
+bool TrackLibrary::storeAnalysis(int index, const AnalysisResults& results)
+{
+    deferWhileLoading(index, [results](TrackLibrary& library, int i) { library.storeAnalysis(i, results); });
+    auto& record = records[(size_t) index];
+    if (record.fileSize != results.fileSize || record.modificationTime != results.modificationTime)
+        return false;
+
+    record.bpm = results.bpm;
+    record.flags &= TrackRecord::missing;
+    record.flags |= ((uint32) results.version << 16) & TrackRecord::analysisVersionMask;
+    if (results.bpm > 0.0f)
+        record.flags |= TrackRecord::hasTempo;
+    record.key = results.key;
+    if (results.key >= 0)
+        record.flags |= TrackRecord::hasKey;
+    record.loudnessLufs = results.loudnessLufs;
+    record.truePeakDb = results.truePeakDb;
+    if (results.hasLoudness)
+        record.flags |= TrackRecord::hasLoudness;
+    touch(Field::analysis);
+    changed();
+    return true;
+}
+
+AnalysisResults TrackLibrary::getAnalysis(int index) const
+{
+    const auto& record = records[(size_t) index];
+    AnalysisResults results;
+    results.version = record.getAnalysisVersion();
+    results.fileSize = record.fileSize;
+    results.modificationTime = record.modificationTime;
+    results.bpm = (record.flags & TrackRecord::hasTempo) != 0 ? record.bpm : 0.0f;
+    results.key = (record.flags & TrackRecord::hasKey) != 0 ? record.key : -1;
+    results.hasLoudness = (record.flags & TrackRecord::hasLoudness) != 0;
+    results.loudnessLufs = record.loudnessLufs;
+    results.truePeakDb = record.truePeakDb;
+    return results;
+}
+
+// Decodes only paths that share the folder's byte prefix, so most records are skipped with a memcmp
+std::vector<int> TrackLibrary::findTracksUnder(const File& folder) const
+{
+    std::vector<int> found;
+    auto prefix = folder.getFullPathName();
+    const char* prefixUtf8 = prefix.toRawUTF8();
+    auto prefixLength = (uint32) std::strlen(prefixUtf8);
+
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        const auto& record = records[i];
+        if (record.pathLength < prefixLength || std::memcmp(strings.data() + record.pathOffset, prefixUtf8, prefixLength) != 0)
+            continue;
+
+        // Either the folder itself or something below it, not a sibling sharing the prefix
+        if (record.pathLength == prefixLength || strings[record.pathOffset + prefixLength] == File::getSeparatorChar())
+            found.push_back((int) i);
+    }
+    return found;
+}
+
+void TrackLibrary::addWatchedFolder(const File& folder)
+{
+    if (watchedFolders.addIfNotAlreadyThere(folder.getFullPathName()))
+        changed();
+}
+
+void TrackLibrary::removeWatchedFolder(const File& folder)
+{
+    deferWhileLoading(-1, [folder](TrackLibrary& library, int) { library.removeWatchedFolder(folder); }); // It may be in the file
+    int index = watchedFolders.indexOf(folder.getFullPathName());
+    if (index >= 0)
+    {
+        watchedFolders.remove(index);
+        changed();
+    }
+}
+
+// Opens a reader just for its header: tags, length, rate and channels
+bool TrackLibrary::readTrackInfo(AudioFormatManager& formatManager, const File& file, TrackInfo& info)
+{
+    std::unique_ptr<AudioFormatReader> reader(formatManager.createReaderFor(file));
+    if (reader == nullptr || reader->sampleRate <= 0.0)
+        return false;
+
+    info.file = file;
+    info.sampleRate = reader->sampleRate;
+    info.numChannels = (int) reader->numChannels;
+    info.durationSeconds = reader->lengthInSamples / reader->sampleRate;
+    info.fileSize = file.getSize();
+    info.modificationTime = file.getLastModificationTime().toMilliseconds();
+
+    info.title = findTag(reader->metadataValues, { "title", "TITLE", "INAM", "id3title" });
+    info.artist = findTag(reader->metadataValues, { "artist", "ARTIST", "IART", "id3artist" });
+
+    // Untagged files: fall back to the "Artist - Title" naming convention, then the bare file name
+    if (info.title.isEmpty())
+    {
+        auto name = file.getFileNameWithoutExtension();
+        if (info.artist.isEmpty() && name.contains(" - "))
+        {
+            info.artist = name.upToFirstOccurrenceOf(" - ", false, false).trim();
+            info.title = name.fromFirstOccurrenceOf(" - ", false, false).trim();
+        }
+        else
+        {
+            info.title = name;
+        }
+    }
+    return true;
+}
+
+void TrackLibrary::timerCallback()
+{
+    stopTimer();
+    if (dirty && ! loading) // install() reschedules the save
+        saveAsync();
+}
+
+void TrackLibrary::changed()
+{
+    dirty = true;
+    startTimer(saveDelayMs); // Restarting the timer coalesces bursts of edits into one save
+    sendChangeMessage();
+}
+
+// Adds a new entry, or refreshes the metadata of the entry with the same path while keeping its history
+int TrackLibrary::insertOrUpdate(const TrackInfo& info)
+{
+    int index = indexOf(info.file);
+    if (index < 0)
+    {
+        index = (int) records.size();
+        records.emplace_back();
+    }
+    else
+    {
+        unindexPath(index);
+        auto& existing = records[(size_t) index];
+        garbageBytes += existing.pathLength + existing.titleLength + existing.artistLength;
+        touch(Field::metadata);
+
+        // Analysis only stays valid if the audio is the same file as before
+        if (existing.fileSize != info.fileSize || existing.modificationTime != info.modificationTime)
+        {
+            existing.flags = 0;
+            touch(Field::analysis);
+        }
+    }
+
+    auto& record = records[(size_t) index];
+    setStrings(record, info);
+    record.durationSeconds = (float) info.durationSeconds;
+    record.sampleRate = (float) info.sampleRate;
+    record.numChannels = info.numChannels;
+    record.fileSize = info.fileSize;
+    record.modificationTime = info.modificationTime;
+    record.flags &= ~(uint32) TrackRecord::missing;
+
+    indexPath(index);
+    return index;
+}
+
+void TrackLibrary::setStrings(TrackRecord& record, const TrackInfo& info)
+{
+    auto path = info.file.getFullPathName();
+    record.pathHash = (uint64) path.hashCode64();
+    record.pathOffset = appendString(path, record.pathLength);
+    record.titleOffset = appendString(info.title.isNotEmpty() ? info.title : info.file.getFileNameWithoutExtension(), record.titleLength);
+    record.artistOffset = appendString(info.artist, record.artistLength);
+}
+
+uint32 TrackLibrary::appendString(const String& text, uint32& length)
+{
+    auto offset = (uint32) strings.size();
+    auto utf8 = text.toRawUTF8();
+    length = (uint32) std::strlen(utf8);
+    strings.insert(strings.end(), utf8, utf8 + length);
+    return offset;
+}
+
+String TrackLibrary::readString(uint32 offset, uint32 length) const
+{
+    if (length == 0 || (size_t) offset + length > strings.size())
+        return {};
+    return String::fromUTF8(strings.data() + offset, (int) length);
+}
+
+// Rewrites the blob without strings orphaned by setFile, once they make up most of it
+void TrackLibrary::compactStrings()
+{
+    if (garbageBytes == 0 || garbageBytes * 2 < strings.size())
+        return;
+
+    std::vector<char> compacted;
+    compacted.reserve(strings.size() - garbageBytes);
+
+    auto move = [&](uint32& offset, uint32 length)
+    {
+        auto newOffset = (uint32) compacted.size();
+        compacted.insert(compacted.end(), strings.begin() + offset, strings.begin() + offset + length);
+        offset = newOffset;
+    };
+
+    for (auto& record : records)
+    {
+        move(record.pathOffset, record.pathLength);
+        move(record.titleOffset, record.titleLength);
+        move(record.artistOffset, record.artistLength);
+    }
+
+    strings.swap(compacted);
+    garbageBytes = 0;
+}
+
+void TrackLibrary::rebuildPathIndex()
+{
+    pathIndex.clear();
+    pathIndex.reserve(records.size());
+    for (size_t i = 0; i < records.size(); ++i)
+        indexPath((int) i);
+}
+
+void TrackLibrary::indexPath(int index)
+{
+    pathIndex.emplace(records[(size_t) index].pathHash, index);
+}
+
+void TrackLibrary::unindexPath(int index)
+{
+    auto range = pathIndex.equal_range(records[(size_t) index].pathHash);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        if (it->second == index)
+        {
+            pathIndex.erase(it);
+            return;
+        }
+    }
+}
+
+bool TrackLibrary::hasPath(int index, const char* utf8, size_t length) const
+{
+    const auto& record = records[(size_t) index];
+    return record.pathLength == length
+           && (size_t) record.pathOffset + length <= strings.size()
+           && std::memcmp(strings.data() + record.pathOffset, utf8, length) == 0;
+}
+
+MemoryBlock TrackLibrary::createSnapshot() const
+{
+    LibraryHeader header {};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = formatVersion;
+    header.recordSize = sizeof(TrackRecord);
+    header.numTracks = (uint32) records.size();
+    header.stringBytes = strings.size();
+
+    auto folders = watchedFolders.joinIntoString("\n");
+    uint64 folderBytes = folders.getNumBytesAsUTF8();
+
+    MemoryBlock block;
+    block.ensureSize(sizeof(header) + sizeof(folderBytes) + records.size() * sizeof(TrackRecord) + strings.size() + folderBytes);
+    block.append(&header, sizeof(header));
+    block.append(&folderBytes, sizeof(folderBytes));
+    block.append(records.data(), records.size() * sizeof(TrackRecord));
+    block.append(strings.data(), strings.size());
+    block.append(folders.toRawUTF8(), (size_t) folderBytes);
+    return block;
+}
+
+// Writes to a temporary file and swaps it in, so a crash mid-save never corrupts the library
+bool TrackLibrary::writeSnapshot(const File& file, const MemoryBlock& snapshot)
+{
+    file.getParentDirectory().createDirectory();
+    TemporaryFile temp(file);
+    {
+        FileOutputStream out(temp.getFile());
+        if (! out.openedOk() || ! out.write(snapshot.getData(), snapshot.getSize()))
+            return false;
+        out.flush();
+    }
+    return temp.overwriteTargetFileWithTemporary();
+}
@@ -0,0 +1,189 @@
+/*
+  ==============================================================================
+
+    TrackLibrary.h
+    Created: 19 Oct 2026 2:58:19pm
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+// Fixed-size, trivially copyable track entry. Records are read and written as one contiguous array,
+// and their strings live in a single shared UTF-8 blob, so loading never builds per-track objects.
+struct TrackRecord {
+    juce::uint64 pathHash = 0; // String::hashCode64() of the full path, for lookups
+    juce::uint32 pathOffset = 0, pathLength = 0; // Full path in the string blob
+    juce::uint32 titleOffset = 0, titleLength = 0; // Display title in the string blob
+    juce::uint32 artistOffset = 0, artistLength = 0; // Artist in the string blob (may be empty)
+    juce::int64 fileSize = 0; // Bytes on disk when last scanned
+    juce::int64 modificationTime = 0; // File modification time (ms since epoch) when last scanned
+    float durationSeconds = 0.0f; // Track length
+    float sampleRate = 0.0f; // File sample rate
+    juce::int32 numChannels = 0; // File channel count
+    float bpm = 0.0f; // Tempo from analysis, 0 if not analysed
+    juce::int32 key = -1; // Musical key from analysis: 0-11 C..B major, 12-23 C..B minor, -1 if unknown
+    float loudnessLufs = 0.0f; // Integrated loudness from analysis, valid if hasLoudness
+    float truePeakDb = 0.0f; // True peak from analysis, valid if hasLoudness
+    juce::uint32 reserved = 0; // Spells out the padding before lastPlayed, so no uninitialised byte reaches the disk
+    juce::int64 lastPlayed = 0; // When the track was last loaded to a deck (ms since epoch), 0 if never
+    juce::uint32 playCount = 0; // Number of times the track was loaded to a deck
+    juce::uint32 flags = 0; // Combination of TrackRecord::Flags
+
+    enum Flags : juce::uint32 {
+        hasTempo = 1 << 0, // bpm is valid
+        hasKey = 1 << 1, // key is valid
+        hasLoudness = 1 << 2, // loudnessLufs and truePeakDb are valid
+        missing = 1 << 3, // File was not found on the last check
+        analysisVersionMask = 0xffu << 16 // TrackAnalyser::version that produced the results, 0 if never analysed
+    };
+
+    int getAnalysisVersion() const { return (int) ((flags & analysisVersionMask) >> 16); }
+};
+
+// Values produced by one TrackAnalyser pass over a file, stored into its record in one go
+struct AnalysisResults {
+    int version = 0; // TrackAnalyser::version
+    juce::int64 fileSize = 0; // Size of the file that was analysed
+    juce::int64 modificationTime = 0; // Modification time (ms) of the file that was analysed
+    float bpm = 0.0f; // 0 if no steady tempo was found
+    int key = -1; // Same encoding as TrackRecord::key, -1 if unclear
+    bool hasLoudness = false; // False if the track was silent or unreadable
+    float loudnessLufs = 0.0f; // EBU R128 integrated loudness
+    float truePeakDb = 0.0f; // Oversampled peak in dBTP
+};
+
+// Metadata gathered for a track before it is added to the library
+struct TrackInfo {
+    juce::File file;
+    juce::String title;
+    juce::String artist;
+    double durationSeconds = 0.0;
+    double sampleRate = 0.0;
+    int numChannels = 0;
+    juce::int64 fileSize = 0;
+    juce::int64 modificationTime = 0;
+};
+
+// TrackLibrary class: Persistent track store backed by a compact binary index file.
+// Loading reads the whole file in two block reads; saving snapshots on the message thread and
+// writes on a background thread. All methods must be called on the message thread.
+class TrackLibrary : public juce::ChangeBroadcaster,
+                     private juce::Timer {
+public:
+    explicit TrackLibrary(const juce::File& storeFile = getDefaultFile()); // Does not load; call load()
+    ~TrackLibrary() override; // Flushes unsaved changes
+
+    static juce::File getDefaultFile(); // <user app data>/OtoDecks/library.odlb
+
+    bool load(); // Replace the contents with the store file; false if it is missing or unreadable
+
+    // Reads the store file on the background thread and swaps it in on the message thread, then
+    // calls onLoaded with what load() would have returned. Tracks and folders added in the meantime
+    // are kept, other edits made in the meantime are replayed onto the loaded tracks, and no save
+    // happens until the file has been swapped in.
+    void loadAsync(std::function<void(bool)> onLoaded = {});
+    bool isLoading() const { return loading; } // True while a loadAsync is in flight
+    void saveAsync(); // Snapshot now and write the file on the background thread
+    void saveNow(); // Snapshot and write on the calling thread
+
+    int getNumTracks() const { return (int) records.size(); } // Number of tracks
+    const TrackRecord& getRecord(int index) const { return records[(size_t) index]; } // Numeric fields of a track
+    juce::String getPath(int index) const; // Full path of a track
+    juce::String getTitle(int index) const; // Display title of a track
+    juce::String getArtist(int index) const; // Artist of a track (may be empty)
+    juce::File getFile(int index) const { return juce::File(getPath(index)); } // File of a track
+    int indexOf(const juce::File& file) const; // Index of the track with this path, or -1
+    const std::vector<TrackRecord>& getRecords() const { return records; } // All records, for bulk copies
+    const std::vector<char>& getStringBlob() const { return strings; } // String blob the records point into
+
+    int addTrack(const TrackInfo& info); // Add or refresh a track; returns its index
+    void addTracks(const std::vector<TrackInfo>& infos); // Add or refresh many tracks with a single change notification
+    void setFile(int index, const TrackInfo& info); // Point an existing entry at a different file
+    void markPlayed(int index); // Record that a track was loaded to a deck
+    void moveTrack(int index, const juce::File& newFile); // Follow a moved or renamed file, keeping analysis and history
+    void setMissing(int index, bool isMissing); // Flag or unflag a track whose file has disappeared
+    void setMissing(const std::vector<std::pair<int, bool>>& updates); // Many (index, isMissing) pairs with a single change notification
+    void invalidateAnalysis(int index); // Forget analysis results after the audio changed
+    bool storeAnalysis(int index, const AnalysisResults& results); // False if the file changed since it was analysed
+    AnalysisResults getAnalysis(int index) const; // Stored results of a track, version 0 if never analysed
+    std::vector<int> findTracksUnder(const juce::File& folder) const; // Tracks whose file is inside folder (or is folder)
+
+    const juce::StringArray& getWatchedFolders() const { return watchedFolders; } // Folders kept in sync with the disk
+    void addWatchedFolder(const juce::File& folder); // Start keeping a folder in sync
+    void removeWatchedFolder(const juce::File& folder); // Stop keeping a folder in sync
+
+    // Parts of a record an edit can touch, for listeners caching values derived from them
+    enum class Field { metadata, analysis, playHistory };
+    static constexpr int numFields = 3;
+    // Bumped whenever that part of an existing track changes or the whole library is replaced.
+    // Adding tracks leaves it alone: the new indices are past the old end.
+    juce::uint32 getGeneration(Field field) const { return generations[(size_t) field]; }
+
+    static juce::String keyToCamelot(int key); // "8B" for C major, "8A" for A minor; empty if unknown
+    static int camelotToKey(const juce::String& camelot); // Inverse of keyToCamelot; -1 if not a Camelot code
+
+    // Reads tags, length and format from the file header without decoding audio (any thread)
+    static bool readTrackInfo(juce::AudioFormatManager& formatManager, const juce::File& file, TrackInfo& info);
+
+private:
+    // Everything the store file holds; read on any thread, then installed on the message thread
+    struct StoreContents {
+        std::vector<TrackRecord> records;
+        std::vector<char> strings;
+        juce::StringArray watchedFolders;
+        bool valid = false; // False if the file was missing or unreadable
+    };
+
+    // An edit made while a loadAsync is in flight, replayed on the track with the same path once it lands
+    struct DeferredEdit {
+        juce::String path; // Empty for edits that aren't about one track
+        std::function<void(TrackLibrary&, int)> apply; // Called with the track's index after the load
+    };
+
+    static void readStore(const juce::File& file, StoreContents& contents); // Any thread
+    void deferWhileLoading(int index, std::function<void(TrackLibrary&, int)> apply); // Queue an edit for install()
+    void install(StoreContents&& contents); // Replace the contents, re-adding anything added since the read began
+
+    void timerCallback() override; // Deferred save after a burst of changes
+    void changed(); // Notify listeners and schedule a save
+    void touch(Field field) { ++generations[(size_t) field]; }
+    int insertOrUpdate(const TrackInfo& info); // addTrack without the change notification
+    bool applyMissing(int index, bool isMissing); // setMissing without the change notification; true if the flag changed
+    void setStrings(TrackRecord& record, const TrackInfo& info); // Append the record's strings to the blob
+    juce::uint32 appendString(const juce::String& text, juce::uint32& length); // Append UTF-8 text, returning its offset
+    juce::String readString(juce::uint32 offset, juce::uint32 length) const; // Decode a string from the blob
+    void compactStrings(); // Drop orphaned strings from the blob if they have piled up
+    void rebuildPathIndex(); // Recompute pathIndex from the records
+    void indexPath(int index); // Add a record's path to pathIndex
+    void unindexPath(int index); // Remove a record's path from pathIndex, before its strings change
+    bool hasPath(int index, const char* utf8, size_t length) const; // Compare a record's path with UTF-8 text
+    juce::MemoryBlock createSnapshot() const; // Serialise header, records and strings
+    static bool writeSnapshot(const juce::File& file, const juce::MemoryBlock& snapshot); // Replace the store atomically
+
+    static constexpr char magic[4] = { 'O', 'D', 'L', 'B' }; // File signature
+    static constexpr juce::uint32 formatVersion = 2; // Bumped on any layout change; 2 added watched folders
+    static constexpr int saveDelayMs = 2000; // Quiet period before changes are written
+
+    juce::File storeFile; // Where the index lives
+    std::vector<TrackRecord> records; // All tracks, in insertion order
+    std::vector<char> strings; // UTF-8 string blob referenced by the records
+    juce::StringArray watchedFolders; // Full paths of watched folders
+    std::unordered_multimap<juce::uint64, int> pathIndex; // pathHash -> record index; colliding paths share a hash
+    std::array<juce::uint32, numFields> generations {}; // See getGeneration
+    size_t garbageBytes = 0; // Bytes in strings no record refers to any more
+    bool dirty = false; // True if there are changes not yet snapshotted
+    bool loading = false; // A loadAsync hasn't installed its contents yet; saving now would drop them
+    std::vector<DeferredEdit> deferredEdits; // Edits made while loading, in order
+    juce::ThreadPool writer { 1 }; // Single background thread for saves, so writes stay ordered
+
+    JUCE_DECLARE_WEAK_REFERENCEABLE(TrackLibrary)
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TrackLibrary)
+};
@@ -0,0 +1,116 @@
+/*
+  ==============================================================================
+
+    WaveformCache.cpp
+    Created: 19 Oct 2026 5:34:12pm
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#include "WaveformCache.h"
+using namespace juce;
+
+namespace
+{
+    // Entry header, followed by numBins WaveformBins
+    struct EntryHeader
+    {
+        char magic[4];
+        uint32 version;
+        int64 fileSize; // Audio file size the entry was made from
+        int64 modificationTime; // Audio file modification time (ms) the entry was made from
+        double sampleRate;
+        double lengthInSeconds;
+        double bpm; // 0 if no beat grid was found
+        double firstBeatSeconds;
+        int32 firstDownbeatIndex;
+        uint32 numBins;
+    };
+
+    static_assert(std::is_trivially_copyable<WaveformBin>::value, "WaveformBin is written as raw bytes");
+}
+
+File WaveformCache::getDirectory()
+{
+    return File::getSpecialLocation(File::userApplicationDataDirectory)
+               .getChildFile("OtoDecks")
+               .getChildFile("waveforms");
+}
+
+// Named by the same path hash the library uses, so no index of entries is needed
+File WaveformCache::getEntryFor(const File& audioFile)
+{
+    auto hash = (uint64) audioFile.getFullPathName().hashCode64();
+    return getDirectory().getChildFile(String::toHexString((int64) hash).paddedLeft('0', 16) + ".odwf");
+}
+
+SpectralWaveform::Ptr WaveformCache::load(const File& audioFile)
+{
+    FileInputStream in(getEntryFor(audioFile));
+    if (! in.openedOk())
+        return nullptr;
+
+    EntryHeader header;
+    if (in.read(&header, sizeof(header)) != (int) sizeof(header)
+        || std::memcmp(header.magic, magic, sizeof(magic)) != 0
+        || header.version != formatVersion
+        || header.fileSize != audioFile.getSize()
+        || header.modificationTime != audioFile.getLastModificationTime().toMilliseconds()
+        || header.sampleRate <= 0.0
+        || (int64) sizeof(header) + (int64) header.numBins * (int64) sizeof(WaveformBin) != in.getTotalLength())
+        return nullptr;
+
+    std::vector<WaveformBin> bins(header.numBins);
+    auto binBytes = (int) (bins.size() * sizeof(WaveformBin));
+    if (in.read(bins.data(), binBytes) != binBytes)
+        return nullptr;
+
+    BeatGrid grid(header.bpm, header.firstBeatSeconds, header.firstDownbeatIndex, header.lengthInSeconds);
+    return std::make_shared<const SpectralWaveform>(std::move(bins), std::move(grid), header.sampleRate, header.lengthInSeconds);
+}
+
+bool WaveformCache::store(const File& audioFile, const SpectralWaveform& waveform)
+{
+    const auto& grid = waveform.getBeatGrid();
+
+    EntryHeader header;
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = formatVersion;
+    header.fileSize = audioFile.getSize();
+    header.modificationTime = audioFile.getLastModificationTime().toMilliseconds();
+    header.sampleRate = waveform.getBinsPerSecond() * SpectralWaveform::samplesPerBin;
+    header.lengthInSeconds = waveform.getLengthInSeconds();
+    header.bpm = grid.isEmpty() ? 0.0 : grid.getBpm();
+    header.firstBeatSeconds = grid.isEmpty() ? 0.0 : grid.getBeats().front();
+    header.firstDownbeatIndex = grid.getFirstDownbeatIndex();
+    header.numBins = (uint32) waveform.getNumBins();
+
+    auto entry = getEntryFor(audioFile);
+    entry.getParentDirectory().createDirectory();
+
+    // Written beside the entry and swapped in, so a concurrent load never sees half a file
+    TemporaryFile temp(entry);
+    {
+        FileOutputStream out(temp.getFile());
+        if (! out.openedOk()
+            || ! out.write(&header, sizeof(header))
+            || ! out.write(waveform.getBins(), (size_t) waveform.getNumBins() * sizeof(WaveformBin)))
+            return false;
+        out.flush();
+    }
+    return temp.overwriteTargetFileWithTemporary();
+}
+
+void WaveformCache::invalidate(const File& audioFile)
+{
+    getEntryFor(audioFile).deleteFile();
+}
+
+// Entries are validated against the audio's size and time, not its path, so a rename keeps them usable
+void WaveformCache::move(const File& from, const File& to)
+{
+    auto entry = getEntryFor(from);
+    if (entry.existsAsFile())
+        entry.moveFileTo(getEntryFor(to));
+}
@@ -0,0 +1,32 @@
+/*
+  ==============================================================================
+
+    WaveformCache.h
+    Created: 19 Oct 2026 5:34:12pm
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SpectralWaveform.h"
+
+// WaveformCache class: On-disk cache of analysed waveforms and beat grids, one file per track under
+// <user app data>/OtoDecks/waveforms. Entries record the size and modification time of the audio
+// they came from and are ignored once the file changes. All functions are safe on any thread.
+class WaveformCache {
+public:
+    static juce::File getDirectory(); // Folder holding the cache entries
+    static juce::File getEntryFor(const juce::File& audioFile); // Cache entry path for a track
+
+    static SpectralWaveform::Ptr load(const juce::File& audioFile); // Cached result, or nullptr if missing or stale
+    static bool store(const juce::File& audioFile, const SpectralWaveform& waveform); // Write or replace the entry
+    static void invalidate(const juce::File& audioFile); // Delete the entry for a changed or removed track
+    static void move(const juce::File& from, const juce::File& to); // Keep the entry of a track that was moved or renamed
+
+private:
+    static constexpr char magic[4] = { 'O', 'D', 'W', 'F' }; // File signature
+    static constexpr juce::uint32 formatVersion = 1; // Bumped whenever the analysis or layout changes
+};
@@ -1,105 +1,284 @@
-/*
-  ==============================================================================
-
-    WaveformDisplay.cpp
-    Created: 14 Mar 2020 3:50:16pm
-    Author:  roscoe liew
-
-  ==============================================================================
-*/
-
-#include "../JuceLibraryCode/JuceHeader.h"
-#include "WaveformDisplay.h"
-
-using namespace juce;
-
-// Constructor: Initializes the waveform display with the audio format manager and thumbnail cache
-WaveformDisplay::WaveformDisplay(AudioFormatManager & 	formatManagerToUse,
-                                 AudioThumbnailCache & 	cacheToUse) :
-                                 audioThumb(1000, formatManagerToUse, cacheToUse), 
-                                 fileLoaded(false), 
-                                 position(0){
-
-     audioThumb.addChangeListener(this); // Register as a listener to the audio thumbnail
-}
-
-WaveformDisplay::~WaveformDisplay(){
-}
-
-// Draws the waveform and playhead
-void WaveformDisplay::paint (Graphics& g)
-{
-    g.fillAll (getLookAndFeel().findColour (ResizableWindow::backgroundColourId));   // clear the background
-
-    g.setColour (Colours::red);
-    g.drawRect (getLocalBounds(), 1);   // draw an outline around the component
-
-    g.setColour (Colours::purple);
-    if(fileLoaded)
-    {
-      audioThumb.drawChannel(g, 
-        getLocalBounds(), 
-        0, 
-        audioThumb.getTotalLength(), 
-        0, 
-        1.0f // Draw the waveform
-      );
-      g.setColour(Colours::lightgreen);
-      g.drawRect(position * getWidth(), 0, getWidth() / 20, getHeight());
-    }
-    else 
-    {
-      g.setFont (20.0f);
-      g.drawText ("File not loaded...", getLocalBounds(),
-                  Justification::centred, true);
-
-    }
-}
-
-// Handles component resizing (not used in this implementation)
-void WaveformDisplay::resized(){
-
-}
-
-// Loads an audio file from a URL into the waveform display
-void WaveformDisplay::loadURL(URL audioURL)
-{
-  audioThumb.clear();
-  fileLoaded  = audioThumb.setSource(new URLInputSource(audioURL));
-  if (fileLoaded)
-  {
-    std::cout << "wfd: loaded! " << std::endl;
-    repaint();
-  }
-  else {
-    std::cout << "wfd: not loaded! " << std::endl;
-  }
-
-}
-
-// Called when the audio thumbnail changes
-void WaveformDisplay::changeListenerCallback (ChangeBroadcaster *source)
-{
-    std::cout << "wfd: change received! " << std::endl;
-
-    repaint();
-
-}
-
-// Set the relative position of the playhead
-void WaveformDisplay::setPositionRelative(double pos)
-{
-  if (pos != position)
-  {
-    position = pos;
-    repaint();
-  }
-}
-
-// Clear the waveform display
-void WaveformDisplay::clear() {
-    audioThumb.clear(); // Clear the AudioThumbnail
-    repaint(); // Repaint the component to reflect the cleared state
-}
-
-
+/*
+  ==============================================================================
+
+    WaveformDisplay.cpp
+    Created: 14 Mar 2020 3:50:16pm
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "WaveformDisplay.h"
+#include "Trace.h"
+
+using namespace juce;
+
+// Constructor: Initializes the waveform display with the audio format manager and thumbnail cache
+WaveformDisplay::WaveformDisplay(AudioFormatManager & 	formatManagerToUse,
+                                 AudioThumbnailCache & 	cacheToUse) :
+                                 audioThumb(1000, formatManagerToUse, cacheToUse), 
+                                 fileLoaded(false), 
+                                 position(0){
+
+     audioThumb.addChangeListener(this); // Register as a listener to the audio thumbnail
+}
+
+WaveformDisplay::~WaveformDisplay(){
+}
+
+// Draws the overview and zoomed waveforms and the playhead
+void WaveformDisplay::paint (Graphics& g)
+{
+    OTO_TRACE_SCOPE("WaveformDisplay::paint");
+
+    g.fillAll (getLookAndFeel().findColour (ResizableWindow::backgroundColourId));   // clear the background
+
+    g.setColour (Colours::red);
+    g.drawRect (getLocalBounds(), 1);   // draw an outline around the component
+
+    g.setColour (Colours::purple);
+    if(fileLoaded && spectral != nullptr)
+    {
+      auto overviewArea = getOverviewArea();
+      auto zoomArea = getZoomArea();
+
+      g.drawImageAt(overviewImage, overviewArea.getX(), overviewArea.getY());
+      g.setColour(Colours::lightgreen);
+      g.fillRect(overviewArea.getX() + (int) (position * overviewArea.getWidth()), overviewArea.getY(), 2, overviewArea.getHeight());
+
+      // The zoomed view keeps the playhead centred and scrolls the track past it
+      double centreSecs = position * spectral->getLengthInSeconds();
+      double startSecs = centreSecs - zoomWindowSeconds / 2;
+      double endSecs = centreSecs + zoomWindowSeconds / 2;
+      drawBins(g, zoomArea, startSecs, endSecs);
+      drawBeatGrid(g, zoomArea, startSecs, endSecs);
+      drawCues(g, zoomArea, startSecs, endSecs);
+      g.setColour(Colours::white);
+      g.fillRect(zoomArea.getCentreX() - 1, zoomArea.getY(), 2, zoomArea.getHeight());
+
+      g.setColour(Colours::red);
+      g.drawHorizontalLine(zoomArea.getY(), 0.0f, (float) getWidth());
+    }
+    else if(fileLoaded)
+    {
+      // Band analysis still running: show the plain thumbnail meanwhile
+      audioThumb.drawChannel(g, 
+        getLocalBounds(), 
+        0, 
+        audioThumb.getTotalLength(), 
+        0, 
+        1.0f // Draw the waveform
+      );
+      g.setColour(Colours::lightgreen);
+      g.drawRect(position * getWidth(), 0, getWidth() / 20, getHeight());
+    }
+    else 
+    {
+      g.setFont (20.0f);
+      g.drawText ("File not loaded...", getLocalBounds(),
+                  Justification::centred, true);
+
+    }
+}
+
+// Draws one vertical bar per pixel column, coloured by the band mix of the bins under it
+void WaveformDisplay::drawBins(Graphics& g, Rectangle<int> area, double startSecs, double endSecs) const
+{
+    if (area.isEmpty())
+        return;
+
+    const double binsPerPixel = (endSecs - startSecs) * spectral->getBinsPerSecond() / area.getWidth();
+    const double firstBin = startSecs * spectral->getBinsPerSecond();
+    const float halfHeight = area.getHeight() * 0.5f;
+    const float centreY = area.getY() + halfHeight;
+
+    for (int x = 0; x < area.getWidth(); ++x)
+    {
+        int startBin = (int) std::floor(firstBin + x * binsPerPixel);
+        int endBin = jmax(startBin + 1, (int) std::floor(firstBin + (x + 1) * binsPerPixel));
+        auto bin = spectral->getRange(startBin, endBin);
+        if (bin.peak <= 0.0f)
+            continue;
+
+        float h = jmax(1.0f, bin.peak * halfHeight);
+        g.setColour(colourFor(bin));
+        g.fillRect((float) (area.getX() + x), centreY - h, 1.0f, 2.0f * h);
+    }
+}
+
+// Draws beat lines with brighter downbeats. Only beats inside the range are visited (binary search),
+// and when lines would crowd together only bars, then every 2nd, 4th... bar are drawn, so the cost
+// is bounded by the width in pixels rather than the number of beats.
+void WaveformDisplay::drawBeatGrid(Graphics& g, Rectangle<int> area, double startSecs, double endSecs) const
+{
+    const auto& grid = spectral->getBeatGrid();
+    if (grid.isEmpty() || area.isEmpty())
+        return;
+
+    const auto& beats = grid.getBeats();
+    const double pxPerSec = area.getWidth() / (endSecs - startSecs);
+    const double beatSpacingPx = grid.getBeatPeriod() * pxPerSec;
+
+    int stride = 1;
+    if (beatSpacingPx < minGridSpacingPx)
+    {
+        stride = BeatGrid::beatsPerBar;
+        while (beatSpacingPx * stride < minGridSpacingPx)
+            stride *= 2;
+    }
+
+    int first = grid.getFirstBeatAtOrAfter(startSecs);
+    int end = grid.getFirstBeatAtOrAfter(endSecs);
+    if (stride > 1)
+    {
+        // Start on a bar line so thinned-out grids stay anchored to downbeats
+        int downbeat = grid.getFirstDownbeatIndex();
+        first += ((downbeat - first) % stride + stride) % stride;
+    }
+
+    for (int i = first; i < end; i += stride)
+    {
+        bool downbeat = grid.isDownbeat(i);
+        float x = area.getX() + (float) ((beats[(size_t) i] - startSecs) * pxPerSec);
+        g.setColour(downbeat ? Colours::white.withAlpha(0.8f) : Colours::white.withAlpha(0.3f));
+        g.fillRect(x, (float) area.getY(), downbeat ? 2.0f : 1.0f, (float) area.getHeight());
+    }
+}
+
+// Draws cue points as orange lines with a flag at the top
+void WaveformDisplay::drawCues(Graphics& g, Rectangle<int> area, double startSecs, double endSecs) const
+{
+    const double pxPerSec = area.getWidth() / (endSecs - startSecs);
+    auto first = std::lower_bound(cuePoints.begin(), cuePoints.end(), startSecs);
+    auto last = std::upper_bound(first, cuePoints.end(), endSecs);
+
+    g.setColour(Colours::orange);
+    for (auto it = first; it != last; ++it)
+    {
+        float x = area.getX() + (float) ((*it - startSecs) * pxPerSec);
+        g.fillRect(x, (float) area.getY(), 1.0f, (float) area.getHeight());
+
+        Path flag;
+        flag.addTriangle(x, (float) area.getY(), x + 6.0f, (float) area.getY(), x, area.getY() + 6.0f);
+        g.fillPath(flag);
+    }
+}
+
+// Renders the whole track once so painting the overview is a single image blit
+void WaveformDisplay::renderOverview()
+{
+    OTO_TRACE_SCOPE("Render waveform overview");
+    auto area = getOverviewArea();
+    if (spectral == nullptr || area.isEmpty())
+    {
+        overviewImage = {};
+        return;
+    }
+
+    overviewImage = Image(Image::ARGB, area.getWidth(), area.getHeight(), true);
+    Graphics g(overviewImage);
+    drawBins(g, overviewImage.getBounds(), 0.0, spectral->getLengthInSeconds());
+    drawBeatGrid(g, overviewImage.getBounds(), 0.0, spectral->getLengthInSeconds());
+    drawCues(g, overviewImage.getBounds(), 0.0, spectral->getLengthInSeconds());
+}
+
+// The overview takes the top third, the zoomed waveform the rest
+Rectangle<int> WaveformDisplay::getOverviewArea() const
+{
+    return getLocalBounds().reduced(1).removeFromTop(getHeight() / 3);
+}
+
+Rectangle<int> WaveformDisplay::getZoomArea() const
+{
+    auto area = getLocalBounds().reduced(1);
+    area.removeFromTop(getHeight() / 3);
+    return area;
+}
+
+// Re-renders the cached overview at the new size
+void WaveformDisplay::resized(){
+    renderOverview();
+}
+
+// Loads an audio file from a URL into the waveform display
+void WaveformDisplay::loadURL(URL audioURL)
+{
+  OTO_TRACE_SCOPE("Thumbnail setup");
+  spectral.reset();
+  overviewImage = {};
+  cuePoints.clear();
+
+  audioThumb.clear();
+  fileLoaded  = audioThumb.setSource(new URLInputSource(audioURL));
+  if (fileLoaded)
+  {
+    std::cout << "wfd: loaded! " << std::endl;
+    repaint();
+  }
+  else {
+    std::cout << "wfd: not loaded! " << std::endl;
+  }
+
+}
+
+// Band energies are computed by the analysis queue; painting only reads the result
+void WaveformDisplay::setWaveform(SpectralWaveform::Ptr waveform)
+{
+  spectral = std::move(waveform);
+
+  // Until the user sets their own, cue the track at its first downbeat
+  if (spectral != nullptr && cuePoints.empty() && ! spectral->getBeatGrid().isEmpty())
+    cuePoints.push_back(spectral->getBeatGrid().getFirstDownbeat());
+
+  renderOverview();
+  repaint();
+}
+
+// Called when the audio thumbnail changes
+void WaveformDisplay::changeListenerCallback (ChangeBroadcaster *source)
+{
+    std::cout << "wfd: change received! " << std::endl;
+
+    repaint();
+
+}
+
+// Set the relative position of the playhead
+void WaveformDisplay::setPositionRelative(double pos)
+{
+  if (pos != position)
+  {
+    position = pos;
+    repaint();
+  }
+}
+
+// Replace the cue points; the overview is re-rendered since it bakes them in
+void WaveformDisplay::setCuePoints(std::vector<double> cueSeconds)
+{
+  std::sort(cueSeconds.begin(), cueSeconds.end());
+  cuePoints = std::move(cueSeconds);
+  renderOverview();
+  repaint();
+}
+
+// Clear the waveform display
+void WaveformDisplay::clear() {
+    spectral.reset();
+    overviewImage = {};
+    cuePoints.clear();
+    fileLoaded = false;
+    audioThumb.clear(); // Clear the AudioThumbnail
+    repaint(); // Repaint the component to reflect the cleared state
+}
+
+// Maps the band mix onto a saturated colour; silent bins are grey
+Colour WaveformDisplay::colourFor(const WaveformBin& bin)
+{
+    float loudest = jmax(bin.low, bin.mid, bin.high);
+    if (loudest <= 0.0f)
+        return Colours::darkgrey;
+
+    return Colour::fromFloatRGBA(bin.low / loudest, bin.mid / loudest, bin.high / loudest, 1.0f);
+}
@@ -1,41 +1,61 @@
-/*
-  ==============================================================================
-
-    WaveformDisplay.h
-    Created: 14 Mar 2020 3:50:16pm
-    Author:  roscoe liew
-
-  ==============================================================================
-*/
-#pragma once
-
-#include "../JuceLibraryCode/JuceHeader.h"
-using namespace juce;
-
-// WaveformDisplay class: Displays the waveform of an audio file and the playhead position
-class WaveformDisplay    : public Component,
-                           public ChangeListener
-{
-public:
-    WaveformDisplay( AudioFormatManager & 	formatManagerToUse,
-                    AudioThumbnailCache & 	cacheToUse );
-    ~WaveformDisplay();
-
-    void paint (Graphics&) override; // Override the paint method to draw the waveform and playhead
-    void resized() override; // Override the resized method to handle component resizing
-
-    void changeListenerCallback (ChangeBroadcaster *source) override; // Callback for handling changes in the audio thumbnail
-
-    void loadURL(URL audioURL); // Load an audio file from a URL
-    
-    void clear(); // Clear the waveform display
-
-    void setPositionRelative(double pos);  // Set the relative position of the playhead
-
-private:
-    AudioThumbnail audioThumb; // Audio thumbnail for displaying the waveform
-    bool fileLoaded; // Flag to indicate if a file is loaded
-    double position; // Relative position of the playhead
-    
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WaveformDisplay)
-};
+/*
+  ==============================================================================
+
+    WaveformDisplay.h
+    Created: 14 Mar 2020 3:50:16pm
+    Author:  roscoe liew
+
+  ==============================================================================
+*/
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "SpectralWaveform.h"
+using namespace juce;
+
+// WaveformDisplay class: Displays a band-coloured overview and a zoomed waveform around the playhead
+class WaveformDisplay    : public Component,
+                           public ChangeListener
+{
+public:
+    WaveformDisplay( AudioFormatManager & 	formatManagerToUse,
+                    AudioThumbnailCache & 	cacheToUse );
+    ~WaveformDisplay();
+
+    void paint (Graphics&) override; // Override the paint method to draw the waveform and playhead
+    void resized() override; // Override the resized method to handle component resizing
+
+    void changeListenerCallback (ChangeBroadcaster *source) override; // Callback for handling changes in the audio thumbnail
+
+    void loadURL(URL audioURL); // Load an audio file from a URL, showing its thumbnail until setWaveform
+    void setWaveform(SpectralWaveform::Ptr waveform); // Show the band waveform once the track has been analysed
+    
+    void clear(); // Clear the waveform display
+
+    void setPositionRelative(double pos);  // Set the relative position of the playhead
+    
+    void setCuePoints(std::vector<double> cueSeconds); // Replace the cue points drawn over the waveforms
+    const std::vector<double>& getCuePoints() const { return cuePoints; } // Cue positions in seconds, ascending
+
+private:
+    static constexpr double zoomWindowSeconds = 8.0; // Seconds of audio shown in the zoomed waveform
+    static constexpr double minGridSpacingPx = 4.0; // Closest two grid lines may be drawn before thinning out
+
+    void renderOverview(); // Render the whole-track overview into the cached image
+    void drawBins(Graphics& g, Rectangle<int> area, double startSecs, double endSecs) const; // Draw coloured bins for a time range
+    void drawBeatGrid(Graphics& g, Rectangle<int> area, double startSecs, double endSecs) const; // Draw beat and bar lines for a time range
+    void drawCues(Graphics& g, Rectangle<int> area, double startSecs, double endSecs) const; // Draw cue markers for a time range
+    static Colour colourFor(const WaveformBin& bin); // Red for lows, green for mids, blue for highs
+    Rectangle<int> getOverviewArea() const; // Strip holding the whole-track overview
+    Rectangle<int> getZoomArea() const; // Area holding the zoomed waveform
+
+    AudioThumbnail audioThumb; // Audio thumbnail shown until the band analysis is ready
+    bool fileLoaded; // Flag to indicate if a file is loaded
+    double position; // Relative position of the playhead
+
+    SpectralWaveform::Ptr spectral; // Band waveform of the loaded track, once analysed
+    Image overviewImage; // Overview rendered once per track and size
+    std::vector<double> cuePoints; // Cue positions in seconds, ascending
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WaveformDisplay)
+};